@@ -0,0 +1,205 @@
+#include <iostream>
+#include "attack.h"
+#include "extension.h"
+#include "dujella.h"
+
+
+template <class Rozwiniecie>
+static void rozwin(Rozwiniecie& rozwiniecie, vector<ZZ>& wartosc_ulamka_lancuchowego)
+{
+    ZZ iloraz;
+    while (rozwiniecie.nastepny(iloraz))
+    {
+        wartosc_ulamka_lancuchowego.push_back(iloraz);
+    }
+}
+
+
+vector<ZZ> oblicz_wartosc_ulamka_lancuchowego(ZZ e, ZZ N, SilnikRozwiniecia silnik, long prog_hgcd)
+{   
+    vector<ZZ> wartosc_ulamka_lancuchowego;
+    if (silnik == ROZWINIECIE_LEHMER)
+    {
+        RozwiniecieLehmera<ZZ> rozwiniecie(e, N);
+        rozwin(rozwiniecie, wartosc_ulamka_lancuchowego);
+    }
+    else if (silnik == ROZWINIECIE_HGCD || silnik == ROZWINIECIE_AUTO)
+    {
+        RozwiniecieHGCD<ZZ> rozwiniecie(e, N, silnik == ROZWINIECIE_HGCD ? 0 : prog_hgcd);
+        rozwin(rozwiniecie, wartosc_ulamka_lancuchowego);
+    }
+    else
+    {
+        RozwiniecieEuklidesa<ZZ> rozwiniecie(e, N);
+        rozwin(rozwiniecie, wartosc_ulamka_lancuchowego);
+    }
+    return wartosc_ulamka_lancuchowego;
+}
+
+
+// Etap rozszerzony z ustawien, uruchamiany po niepowodzeniu ataku podstawowego
+template <class Liczba>
+static bool rozszerz(const Liczba& e, const Liczba& N, Liczba& q, Liczba& d,
+                     const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    if (ustawienia.rozszerzenie.bity <= 0 || ustawienia.rozszerzenie.bity > MAKS_BITY_ROZSZERZENIA
+        || po_terminie(ustawienia.termin))
+    {
+        return false;
+    }
+    StoperFaz stoper(ustawienia.pomiary ? &statystyki.pomiary : 0);
+    stoper.przelacz(FAZA_ROZSZERZENIE);
+    bool znaleziono = ustawienia.rozszerzenie.metoda == ROZSZERZENIE_DUJELLA
+                      ? atak_dujelli(e, N, q, d, ustawienia, statystyki)
+                      : atak_verheula_van_tilborga(e, N, q, d, ustawienia, statystyki);
+    stoper.zatrzymaj();
+    return znaleziono;
+}
+
+
+// Atak podstawowy, a po jego niepowodzeniu etap rozszerzony. Czesc etapu
+// rozszerzonego (czesci > 1) pomija atak podstawowy, wykonywany raz osobno.
+template <class Liczba>
+static bool atakuj(KontekstAtaku<Liczba>& kontekst, const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    if (ustawienia.rozszerzenie.czesci == 1
+        && atak_wienera(kontekst, kontekst.e, kontekst.N, kontekst.q, kontekst.d, ustawienia, statystyki))
+    {
+        return true;
+    }
+    return rozszerz(kontekst.e, kontekst.N, kontekst.q, kontekst.d, ustawienia, statystyki);
+}
+
+
+// Atak podstawowy w arytmetyce stalej na kontekscie danej szerokosci
+template <class Liczba>
+static bool atakuj_stala(KontekstAtaku<Liczba>& kontekst, const ZZ& e, const ZZ& N, ZZ& q, ZZ& d, long& indeks,
+                         const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    conv(kontekst.e, e);
+    conv(kontekst.N, N);
+    if (!atak_wienera(kontekst, kontekst.e, kontekst.N, kontekst.q, kontekst.d, ustawienia, statystyki))
+    {
+        return false;
+    }
+    conv(q, kontekst.q);
+    conv(d, kontekst.d);
+    indeks = kontekst.z.indeks;
+    return true;
+}
+
+
+// Atak podstawowy w najwezszej arytmetyce stalej, w ktorej miesci sie klucz
+// o dlugosci bity (najwyzej 2048)
+static bool atak_staly(long bity, const ZZ& e, const ZZ& N, ZZ& q, ZZ& d, long& indeks, KontekstyStale& kontekst,
+                       const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    if (bity <= 64)
+    {
+        return atakuj_stala(kontekst.bity_64, e, N, q, d, indeks, ustawienia, statystyki);
+    }
+    if (bity <= 128)
+    {
+        return atakuj_stala(kontekst.bity_128, e, N, q, d, indeks, ustawienia, statystyki);
+    }
+    if (bity <= 256)
+    {
+        return atakuj_stala(kontekst.bity_256, e, N, q, d, indeks, ustawienia, statystyki);
+    }
+    if (bity <= 512)
+    {
+        return atakuj_stala(kontekst.bity_512, e, N, q, d, indeks, ustawienia, statystyki);
+    }
+    if (bity <= 1024)
+    {
+        return atakuj_stala(kontekst.bity_1024, e, N, q, d, indeks, ustawienia, statystyki);
+    }
+    return atakuj_stala(kontekst.bity_2048, e, N, q, d, indeks, ustawienia, statystyki);
+}
+
+
+// atak() w arytmetyce z ustawien, juz z terminem budzetu
+static bool atak_w_arytmetyce(const ZZ& e, const ZZ& N, ZZ& q, ZZ& d, KontekstWatku& kontekst,
+                              const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    if (ustawienia.arytmetyka == ARYTMETYKA_GMP)
+    {
+        KontekstAtaku<LiczbaGMP>& gmp = kontekst.gmp;
+        conv(gmp.e, e, kontekst.bajty);
+        conv(gmp.N, N, kontekst.bajty);
+        if (!atakuj(gmp, ustawienia, statystyki))
+        {
+            return false;
+        }
+        conv(q, gmp.q, kontekst.bajty);
+        conv(d, gmp.d, kontekst.bajty);
+        kontekst.indeks = gmp.z.indeks;
+        return true;
+    }
+    if (ustawienia.arytmetyka == ARYTMETYKA_STALA)
+    {
+        // Etap rozszerzony i klucze dluzsze niz 2048 bitow w NTL
+        long bity = max(NumBits(e), NumBits(N));
+        if (bity <= 2048)
+        {
+            return (ustawienia.rozszerzenie.czesci == 1
+                    && atak_staly(bity, e, N, q, d, kontekst.indeks, kontekst.stale, ustawienia, statystyki))
+                   || rozszerz(e, N, q, d, ustawienia, statystyki);
+        }
+    }
+    KontekstAtaku<ZZ>& ntl = kontekst.ntl;
+    ntl.e = e;
+    ntl.N = N;
+    if (!atakuj(ntl, ustawienia, statystyki))
+    {
+        return false;
+    }
+    q = ntl.q;
+    d = ntl.d;
+    kontekst.indeks = ntl.z.indeks;
+    return true;
+}
+
+
+bool atak(const ZZ& e, const ZZ& N, ZZ& q, ZZ& d, KontekstWatku& kontekst,
+          const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    kontekst.indeks = -1;
+    if (!ustawienia.budzet.ustawiony() || ustawienia.termin)
+    {
+        return atak_w_arytmetyce(e, N, q, d, kontekst, ustawienia, statystyki);
+    }
+    // Ustawienia z terminem tego ataku; kopia jest mala w porownaniu z atakiem
+    UstawieniaAtaku z_terminem = ustawienia;
+    z_terminem.termin = &kontekst.termin;
+    kontekst.termin.start(ustawienia.budzet);
+    if (atak_w_arytmetyce(e, N, q, d, kontekst, z_terminem, statystyki))
+    {
+        return true;
+    }
+    statystyki.przerwane_budzet += po_terminie(&kontekst.termin);
+    return false;
+}
+
+
+vector<ZZ> atak(ZZ e, ZZ N, const UstawieniaAtaku& ustawienia, StatystykiAtaku* statystyki)
+{
+    vector<ZZ> wynik;
+    ZZ q, d;
+    KontekstWatku kontekst;
+    StatystykiAtaku statystyki_klucza;
+    bool znaleziono = atak(e, N, q, d, kontekst, ustawienia, statystyki_klucza);
+    if (statystyki)
+    {
+        statystyki->dodaj(statystyki_klucza);
+    }
+
+    if (znaleziono)
+    {
+        wynik.push_back(q);
+        wynik.push_back(d);
+        return wynik;
+    }
+    wynik.push_back(conv<ZZ>("0"));
+    return wynik;
+}
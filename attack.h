@@ -0,0 +1,993 @@
+#ifndef WIENER_ATTACK_H
+#define WIENER_ATTACK_H
+
+#include <NTL/ZZ.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <climits>
+#include <chrono>
+#include <iostream>
+#include "thread_pool.h"
+#include "gmp_backend.h"
+#include "fixed_backend.h"
+#include "perfect_square.h"
+#include "continued_fraction.h"
+#include "instrumentation.h"
+
+NTL_CLIENT
+
+
+// Arytmetyka duzych liczb, na ktorej wykonywany jest atak. NTL jest
+// implementacja referencyjna, GMP wykonuje wszystkie kroki w miejscu na mpz_t,
+// arytmetyka stala (fixed_backend.h) liczy na slowach w obiekcie, z szerokoscia
+// dobrana do dlugosci modulu (do 2048 bitow, dluzsze klucze w NTL).
+enum Arytmetyka
+{
+    ARYTMETYKA_NTL,
+    ARYTMETYKA_GMP,
+    ARYTMETYKA_STALA
+};
+
+
+// Silnik rozwiniecia e/N w ulamek lancuchowy (continued_fraction.h)
+enum SilnikRozwiniecia
+{
+    ROZWINIECIE_EUKLIDES,
+    ROZWINIECIE_LEHMER,
+    ROZWINIECIE_HGCD,   // half-GCD dla kazdego rozmiaru
+    ROZWINIECIE_AUTO    // half-GCD od prog_hgcd bitow, ponizej Lehmer
+};
+
+// Domyslny prog przejscia z Lehmera na half-GCD (z wiener --cf-crossover)
+const long PROG_HGCD = 131072;
+
+// Od tylu bitow modulu redukty sprawdzane sa w potoku (watki_reduktow > 1);
+// dla krotszych kluczy start watkow kosztuje wiecej niz caly atak
+const long PROG_POTOKU = 4096;
+
+
+// Filtry odrzucajace redukty tanimi testami (bity najnizszego slowa,
+// dlugosci bitowe) zanim policzone zostanie pelne e*d - 1 i dzielenie przez k
+struct FiltryReduktow
+{
+    bool nieparzyste_d;   // e*d = 1 + k*phi(N) jest nieparzyste, wiec d tez
+    bool parzyste_phi;    // 4 | phi(N), wiec v2(e*d - 1) >= v2(k) + 2 (najnizsze slowa)
+    bool przedzial_phi;   // phi(N) z przedzialu (N - 3 sqrt(N), N): dlugosc bitowa
+                          // (e*d - 1)/k przed dzieleniem i N - phi(N) po dzieleniu
+
+    FiltryReduktow() : nieparzyste_d(true), parzyste_phi(true), przedzial_phi(true) {}
+};
+
+
+// Granice przeszukiwania reduktow. Mianowniki reduktow rosna, wiec po
+// przekroczeniu granicy przez d dalsze redukty nie moga jej spelnic.
+struct GranicaSzukania
+{
+    bool wiener;      // d < N^(1/4) / 3, granica z twierdzenia Wienera
+    long max_bity_d;  // NumBits(d) <= max_bity_d, 0 = bez ograniczenia
+    long max_indeks;  // indeks reduktu <= max_indeks, -1 = bez ograniczenia
+
+    GranicaSzukania() : wiener(false), max_bity_d(0), max_indeks(-1) {}
+};
+
+
+// Metoda etapu rozszerzonego
+enum MetodaRozszerzenia
+{
+    ROZSZERZENIE_VVT,     // Verheul i van Tilborg, pelny przeglad (r, s) w watkach (extension.h)
+    ROZSZERZENIE_DUJELLA  // Dujella, kroki male i duze z tablica mieszajaca (dujella.h)
+};
+
+// Postep etapu rozszerzonego jednego klucza dla punktow kontrolnych
+// (checkpoint.h). Zadania to pary (i, r) Verheula-van Tilborga albo porcje
+// (i, r0) krokow malych Dujelli, numerowane w kolejnosci przegladu.
+struct PostepRozszerzenia
+{
+    long poczatek;               // zadania przed nim sprawdzono przed wznowieniem
+    std::atomic<long> wykonane;  // wszystkie zadania przed tym numerem sa sprawdzone
+
+    PostepRozszerzenia() : poczatek(0), wykonane(0) {}
+};
+
+// Etap rozszerzony po nieudanym ataku podstawowym: kandydaci
+// d = r Q_{i+1} +- s Q_i, 0 <= r, s < 2^bity, dla reduktow z Q do
+// N^(1/4) / 3 * 2^bity
+// Wieksze bity nie sa wykonalne (2^(2 bity) kandydatow w VvT), a 1L << bity
+// przestaje byc poprawne
+const long MAKS_BITY_ROZSZERZENIA = 40;
+
+struct RozszerzenieAtaku
+{
+    MetodaRozszerzenia metoda;
+    long bity;    // liczba dodatkowych bitow d ponad granice Wienera, 0 = bez etapu, najwyzej MAKS_BITY_ROZSZERZENIA
+    long watki;   // liczba watkow przeszukujacych (i, r, s), 0 = wszystkie rdzenie
+    long pamiec;  // limit pamieci tablicy krokow malych Dujelli w bajtach
+    PostepRozszerzenia* postep;  // wznowienie i zapis postepu, 0 = od poczatku
+    long czesc, czesci;          // sprawdzane sa tylko zadania o numerze = czesc mod czesci;
+                                 // z czesci > 1 bez ataku podstawowego
+    const std::atomic<bool>* przerwij;  // zewnetrzny sygnal konca szukania, 0 = brak
+
+    RozszerzenieAtaku()
+        : metoda(ROZSZERZENIE_VVT), bity(0), watki(1), pamiec(64L << 20), postep(0), czesc(0), czesci(1), przerwij(0)
+    {
+    }
+};
+
+
+// Rozwiniecie obcietej pary: polowa bitow N i zapas. Redukty potrzebne do
+// granicy Wienera (d < N^(1/4)) sa wtedy potwierdzone bez rozszerzania.
+const long OBCIECIE_POLOWA = -1;
+const long ZAPAS_OBCIECIA = 64;
+
+
+// Budzet jednego ataku, np. opoznienia zapytania uslugi: czas od poczatku
+// atak() i liczba krokow (redukty i kroki s etapu rozszerzonego). Kazdy watek
+// sprawdza budzet co KROK_BUDZETU krokow, wiec atak konczy sie najwyzej tyle
+// krokow watku po jego wyczerpaniu.
+const long KROK_BUDZETU = 64;
+
+struct BudzetAtaku
+{
+    long long czas_ns;  // 0 = bez limitu czasu
+    long kroki;         // 0 = bez limitu krokow
+
+    BudzetAtaku() : czas_ns(0), kroki(0) {}
+
+    bool ustawiony() const { return czas_ns > 0 || kroki > 0; }
+};
+
+// Miejsce, w ktorym wyczerpal sie budzet ataku
+struct PrzerwanieBudzetu
+{
+    bool rozszerzenie;  // w etapie rozszerzonym; indeks to wtedy i pary reduktow (i, i + 1)
+    long indeks;        // indeks ostatniego reduktu, -1 = nieznany (wynik z punktu kontrolnego lub wezla)
+    long bity_d;        // dlugosc bitowa ostatniego sprawdzanego d (Dujella: ograniczenie z Q_{i+1})
+
+    PrzerwanieBudzetu() : rozszerzenie(false), indeks(-1), bity_d(0) {}
+};
+
+// Budzet w trakcie ataku, wspolny dla watkow potoku i etapu rozszerzonego
+struct TerminAtaku
+{
+    BudzetAtaku budzet;
+    std::chrono::steady_clock::time_point koniec;
+    std::atomic<long> wykonane;      // kroki zgloszone przez wszystkie watki
+    std::atomic<bool> wyczerpany;
+    PrzerwanieBudzetu przerwanie;    // zapisuje watek, ktory wyczerpal budzet
+
+    TerminAtaku() : wykonane(0), wyczerpany(false) {}
+
+    void start(const BudzetAtaku& budzet_ataku)
+    {
+        budzet = budzet_ataku;
+        koniec = std::chrono::steady_clock::now() + std::chrono::nanoseconds(budzet.czas_ns);
+        wykonane.store(0);
+        wyczerpany.store(false);
+        przerwanie = PrzerwanieBudzetu();
+    }
+
+    // Dolicza kroki watku i sprawdza zegar; zwraca true, gdy budzet jest
+    // wyczerpany. Miejsce to (rozszerzenie, indeks, bity_d) wolajacego.
+    bool dolicz(long kroki, bool rozszerzenie, long indeks, long bity_d)
+    {
+        if (wyczerpany.load(std::memory_order_relaxed))
+        {
+            return true;
+        }
+        long razem = wykonane.fetch_add(kroki, std::memory_order_relaxed) + kroki;
+        if (!(budzet.kroki > 0 && razem >= budzet.kroki)
+            && !(budzet.czas_ns > 0 && std::chrono::steady_clock::now() >= koniec))
+        {
+            return false;
+        }
+        bool oczekiwane = false;
+        if (wyczerpany.compare_exchange_strong(oczekiwane, true))
+        {
+            przerwanie.rozszerzenie = rozszerzenie;
+            przerwanie.indeks = indeks;
+            przerwanie.bity_d = bity_d;
+        }
+        return true;
+    }
+};
+
+// Czy budzet ataku z ustawien (UstawieniaAtaku::termin) jest juz wyczerpany
+inline bool po_terminie(const TerminAtaku* termin)
+{
+    return termin && termin->wyczerpany.load(std::memory_order_relaxed);
+}
+
+
+// Ustawienia pojedynczego ataku
+struct UstawieniaAtaku
+{
+    Arytmetyka arytmetyka;
+    SilnikRozwiniecia rozwiniecie;
+    FiltryReduktow filtry;
+    GranicaSzukania granica;
+    RozszerzenieAtaku rozszerzenie;
+
+    long prog_hgcd;     // rozmiar pary, od ktorego ROZWINIECIE_AUTO uzywa half-GCD
+    long obciecie;      // bity e i N w rozwinieciu, 0 = pelne, OBCIECIE_POLOWA
+    bool pomiary;       // mierz czas faz ataku (StatystykiAtaku::pomiary)
+    long watki_reduktow; // watki sprawdzajace redukty jednego klucza, <= 1 = bez potoku
+    BudzetAtaku budzet;  // budzet kazdego atak(), domyslnie bez limitu
+    TerminAtaku* termin; // stan budzetu biezacego ataku, ustawiany przez atak(); 0 = bez budzetu
+
+    UstawieniaAtaku()
+        : arytmetyka(ARYTMETYKA_NTL), rozwiniecie(ROZWINIECIE_AUTO), prog_hgcd(PROG_HGCD), obciecie(0),
+          pomiary(false), watki_reduktow(1), termin(0) {}
+};
+
+
+// Liczniki ataku: liczba sprawdzonych reduktow i to, ile z nich odrzucil
+// kazdy kolejny etap sprawdzania
+struct StatystykiAtaku
+{
+    long redukty;
+    long odrzucone_k_zero;
+    long odrzucone_nieparzyste_d;
+    long odrzucone_parzyste_phi;
+    long odrzucone_dlugosc_phi;   // przedzial_phi przed dzieleniem
+    long odrzucone_dzielenie;     // k nie dzieli e*d - 1
+    long odrzucone_przedzial_phi; // przedzial_phi po dzieleniu
+    long odrzucone_delta;         // delta ujemna lub niebedaca kwadratem
+    long odrzucone_pierwiastek;   // pierwiastek nie jest dzielnikiem N
+    long przerwane_granica;       // ataki zakonczone na granicy d lub indeksu
+    long przerwane_budzet;        // ataki zakonczone po wyczerpaniu budzetu (BudzetAtaku)
+    long rozszerzenia_precyzji;   // podwojenia precyzji obcietego rozwiniecia
+    long kandydaci_rozszerzenia;  // pary (k, d) sprawdzone w etapie rozszerzonym
+    PomiaryAtaku pomiary;         // dlugosc rozwiniecia, testy i czasy faz
+
+    StatystykiAtaku()
+        : redukty(0), odrzucone_k_zero(0), odrzucone_nieparzyste_d(0), odrzucone_parzyste_phi(0),
+          odrzucone_dlugosc_phi(0), odrzucone_dzielenie(0), odrzucone_przedzial_phi(0),
+          odrzucone_delta(0), odrzucone_pierwiastek(0), przerwane_granica(0), przerwane_budzet(0),
+          rozszerzenia_precyzji(0), kandydaci_rozszerzenia(0) {}
+
+    void dodaj(const StatystykiAtaku& s)
+    {
+        redukty += s.redukty;
+        odrzucone_k_zero += s.odrzucone_k_zero;
+        odrzucone_nieparzyste_d += s.odrzucone_nieparzyste_d;
+        odrzucone_parzyste_phi += s.odrzucone_parzyste_phi;
+        odrzucone_dlugosc_phi += s.odrzucone_dlugosc_phi;
+        odrzucone_dzielenie += s.odrzucone_dzielenie;
+        odrzucone_przedzial_phi += s.odrzucone_przedzial_phi;
+        odrzucone_delta += s.odrzucone_delta;
+        odrzucone_pierwiastek += s.odrzucone_pierwiastek;
+        przerwane_granica += s.przerwane_granica;
+        przerwane_budzet += s.przerwane_budzet;
+        rozszerzenia_precyzji += s.rozszerzenia_precyzji;
+        kandydaci_rozszerzenia += s.kandydaci_rozszerzenia;
+        pomiary.dodaj(s.pomiary);
+    }
+};
+
+
+// Strumieniowy generator reduktow ulamka lancuchowego e/N.
+// Kolejne wyrazy a_i pobierane sa z silnika rozwiniecia, a redukty
+// k_i/d_i = P_i/Q_i wyznaczane sa w locie; pamietane sa jedynie dwa ostatnie
+// redukty, wiec zuzycie pamieci nie rosnie z dlugoscia rozwiniecia.
+//
+// Po obetnij() wyrazy liczone sa z najstarszych bitow pary (e >> s, N >> s).
+// Na koncu kazdej partii silnika generator sprawdza warunek Jebeleana dla
+// reszt r_i = |Q_i E - P_i M| obcietej pary: r_i >= max(Q_i, P_i) oraz
+// r_{i-1} - r_i >= max(Q_{i-1} + Q_i, P_{i-1} + P_i) gwarantuje, ze wszystkie
+// dotychczasowe wyrazy sa takie same jak dla pelnej pary. Gdy warunek nie
+// zachodzi, precyzja jest podwajana i rozwiniecie wznawiane od ostatniego
+// potwierdzonego reduktu, wiec redukty z tego odcinka moga zostac zwrocone
+// ponownie.
+template <class Liczba, class Rozwiniecie = RozwiniecieEuklidesa<Liczba> >
+class GeneratorReduktow
+{
+public:
+    GeneratorReduktow(const Liczba& e, const Liczba& N)
+        : rozwiniecie(e, N), indeks_reduktu(-1), przesuniecie(0), liczba_rozszerzen(0), stoper(0)
+    {
+        zeruj();
+    }
+
+    // Dla silnikow z parametrem (prog bitow RozwiniecieHGCD)
+    GeneratorReduktow(const Liczba& e, const Liczba& N, long parametr)
+        : rozwiniecie(e, N, parametr), indeks_reduktu(-1), przesuniecie(0), liczba_rozszerzen(0), stoper(0)
+    {
+        zeruj();
+    }
+
+    // Generator wielokrotnego uzytku; kazdy klucz zaczyna uruchom()
+    GeneratorReduktow() : indeks_reduktu(-1), przesuniecie(0), liczba_rozszerzen(0), stoper(0)
+    {
+        zeruj();
+    }
+
+    // Zaczyna redukty nowej pary e/N od poczatku, bez obciecia i pomiarow
+    void uruchom(const Liczba& e, const Liczba& N)
+    {
+        rozwiniecie.ustaw(e, N);
+        wyzeruj_stan();
+    }
+
+    void uruchom(const Liczba& e, const Liczba& N, long parametr)
+    {
+        rozwiniecie.ustaw(e, N, parametr);
+        wyzeruj_stan();
+    }
+
+    // Rezerwuje pamiec na klucze o module do bity bitow
+    void przygotuj(long bity)
+    {
+        rozwiniecie.przygotuj(bity);
+        Liczba* liczby[] = { &iloraz, &P, &P_1, &Q, &Q_1, &e_pelne, &N_pelne, &E, &M, &t, &w, &x,
+                             &P_pewny, &P_1_pewny, &Q_pewny, &Q_1_pewny };
+        for (size_t i = 0; i < sizeof(liczby) / sizeof(liczby[0]); i++)
+        {
+            zarezerwuj(*liczby[i], 2 * bity);
+        }
+    }
+
+    // Przechodzi na rozwiniecie bity_precyzji najstarszych bitow e i N
+    // (przed pierwszym nastepny())
+    void obetnij(const Liczba& e, const Liczba& N, long bity_precyzji)
+    {
+        e_pelne = e;
+        N_pelne = N;
+        precyzja = bity_precyzji;
+        zapamietaj_pewny();
+        ustaw_precyzje();
+    }
+
+    // Czas pobierania wyrazow i rekurencji reduktow liczony jest w stoperze
+    void mierz(StoperFaz* stoper_faz)
+    {
+        stoper = stoper_faz;
+    }
+
+    // Wyznacza kolejny wyraz i redukt, zwraca false gdy rozwiniecie sie skonczylo
+    bool nastepny()
+    {
+        for (;;)
+        {
+            przelacz(FAZA_ROZWINIECIE);
+            bool jest_wyraz = rozwiniecie.nastepny(iloraz);
+            przelacz(FAZA_REDUKTY);
+            if (!jest_wyraz)
+            {
+                if (przesuniecie == 0)
+                {
+                    return false;
+                }
+                // Obciete rozwiniecie skonczylo sie przed pelnym
+                rozszerz_precyzje();
+                continue;
+            }
+
+            // P_i = a_i * P_{i-1} + P_{i-2}, Q_i = a_i * Q_{i-1} + Q_{i-2}
+            dolacz_wyraz(P, P_1, iloraz);
+            dolacz_wyraz(Q, Q_1, iloraz);
+            indeks_reduktu++;
+
+            if (przesuniecie == 0 || !rozwiniecie.koniec_partii())
+            {
+                return true;
+            }
+            if (!reszty_potwierdzaja())
+            {
+                rozszerz_precyzje();
+                continue;
+            }
+            zapamietaj_pewny();
+            return true;
+        }
+    }
+
+    long indeks() const { return indeks_reduktu; }
+    const Liczba& a() const { return iloraz; }
+    const Liczba& k() const { return P; }
+    const Liczba& d() const { return Q; }
+
+    // Czy biezacy redukt jest redukt pelnego e/N (zawsze poza trybem obcietym)
+    bool pewny() const { return przesuniecie == 0 || indeks_reduktu <= indeks_pewny; }
+    long rozszerzenia() const { return liczba_rozszerzen; }
+
+private:
+    Rozwiniecie rozwiniecie;
+    Liczba iloraz;
+
+    void przelacz(FazaAtaku faza)
+    {
+        if (stoper)
+        {
+            stoper->przelacz(faza);
+        }
+    }
+
+    void wyzeruj_stan()
+    {
+        indeks_reduktu = -1;
+        przesuniecie = 0;
+        liczba_rozszerzen = 0;
+        stoper = 0;
+        zeruj();
+    }
+
+    void zeruj()
+    {
+        // P_{-1} = 1, P_{-2} = 0, Q_{-1} = 0, Q_{-2} = 1
+        P = 1;
+        P_1 = 0;
+        Q = 0;
+        Q_1 = 1;
+    }
+
+    // x = |Q E - P M|
+    void reszta(Liczba& x, const Liczba& Q_i, const Liczba& P_i)
+    {
+        mul(x, Q_i, E);
+        MulSubFrom(x, P_i, M);
+        if (sign(x) < 0)
+        {
+            mul(x, P_i, M);
+            MulSubFrom(x, Q_i, E);
+        }
+    }
+
+    // Warunek Jebeleana dla reszt silnika po biezacym wyrazie
+    bool reszty_potwierdzaja()
+    {
+        const Liczba& r_1 = rozwiniecie.licznik();
+        const Liczba& r = rozwiniecie.mianownik();
+        if (r < (Q < P ? P : Q))
+        {
+            return false;
+        }
+        sub(t, r_1, r);
+        add(w, Q_1, Q);
+        add(x, P_1, P);
+        return !(t < (w < x ? x : w));
+    }
+
+    void zapamietaj_pewny()
+    {
+        P_pewny = P;
+        P_1_pewny = P_1;
+        Q_pewny = Q;
+        Q_1_pewny = Q_1;
+        indeks_pewny = indeks_reduktu;
+    }
+
+    // Obcina pelna pare do biezacej precyzji i wznawia rozwiniecie od
+    // ostatniego potwierdzonego reduktu
+    void ustaw_precyzje()
+    {
+        przesuniecie = NumBits(N_pelne) - precyzja;
+        if (przesuniecie < 0)
+        {
+            przesuniecie = 0;
+        }
+        RightShift(E, e_pelne, przesuniecie);
+        RightShift(M, N_pelne, przesuniecie);
+        P = P_pewny;
+        P_1 = P_1_pewny;
+        Q = Q_pewny;
+        Q_1 = Q_1_pewny;
+        indeks_reduktu = indeks_pewny;
+        reszta(t, Q_1, P_1);
+        reszta(w, Q, P);
+        rozwiniecie.ustaw(t, w);
+    }
+
+    void rozszerz_precyzje()
+    {
+        precyzja *= 2;
+        liczba_rozszerzen++;
+        ustaw_precyzje();
+    }
+
+    Liczba P, P_1, Q, Q_1; // biezacy i poprzedni redukt
+    long indeks_reduktu;
+
+    // Tryb obciety
+    Liczba e_pelne, N_pelne, E, M, t, w, x;
+    Liczba P_pewny, P_1_pewny, Q_pewny, Q_1_pewny; // ostatni potwierdzony redukt
+    long indeks_pewny, precyzja, przesuniecie, liczba_rozszerzen;
+
+    StoperFaz* stoper;
+};
+
+
+// Jesli a jest kwadratem liczby calkowitej, ustawia x = sqrt(a) i zwraca 1.
+// SqrRoot liczony jest raz; sito kwadratow (moze_byc_kwadratem()) sprawdza
+// wolajacy, zanim zliczy pierwiastek.
+inline long pierwiastek_dokladny(ZZ& x, const ZZ& a, ZZ& tmp)
+{
+    SqrRoot(x, a);
+    sqr(tmp, x);
+    return tmp == a;
+}
+
+
+// Zmienne robocze sprawdzania reduktu, deklarowane raz na klucz (i watek)
+// lub trzymane w KontekstAtaku
+template <class Liczba>
+struct ZmienneRobocze
+{
+    Liczba phiN, s, delta, pierwiastek, p, tmp, granica_wienera;
+    Liczba N_granicy; // modul, dla ktorego policzono granica_wienera, 0 = zaden
+    StoperFaz stoper; // bez pomiarow, gdy UstawieniaAtaku::pomiary == false
+    long indeks;      // indeks w rozwinieciu e/N reduktu z rozkladem, -1 = brak
+
+    ZmienneRobocze() : indeks(-1) {}
+
+    // Rezerwuje pamiec na klucze o module do bity bitow (e*d i s^2 maja do 2 bity)
+    void przygotuj(long bity)
+    {
+        Liczba* liczby[] = { &phiN, &s, &delta, &pierwiastek, &p, &tmp, &granica_wienera, &N_granicy };
+        for (size_t i = 0; i < sizeof(liczby) / sizeof(liczby[0]); i++)
+        {
+            zarezerwuj(*liczby[i], 2 * bity + 2);
+        }
+    }
+};
+
+
+// Tanie filtry reduktu; zwraca false, gdy k/d na pewno nie jest szukana para
+template <class Liczba>
+bool przepusc_redukt(const Liczba& e, const Liczba& N, const Liczba& k, const Liczba& d,
+                     const FiltryReduktow& filtry, StatystykiAtaku& statystyki)
+{
+    if (filtry.nieparzyste_d && !IsOdd(d))
+    {
+        statystyki.odrzucone_nieparzyste_d++;
+        return false;
+    }
+    if (filtry.parzyste_phi)
+    {
+        // Najnizsze slowo e*d - 1; gdy jest zerem, wykladnik dwojki jest nieznany
+        const long bity_slowa = 8 * sizeof(unsigned long);
+        unsigned long ed_1 = (unsigned long)trunc_long(e, bity_slowa) * (unsigned long)trunc_long(d, bity_slowa) - 1;
+        unsigned long slowo_k = (unsigned long)trunc_long(k, bity_slowa);
+        if (ed_1 != 0 && slowo_k != 0 && __builtin_ctzl(ed_1) < __builtin_ctzl(slowo_k) + 2)
+        {
+            statystyki.odrzucone_parzyste_phi++;
+            return false;
+        }
+    }
+    if (filtry.przedzial_phi)
+    {
+        // N - 3 sqrt(N) < phi(N) < N, wiec phi(N) ma NumBits(N) lub NumBits(N) - 1 bitow
+        long bity_N = NumBits(N);
+        long bity_ed = NumBits(e) + NumBits(d);
+        long bity_k = NumBits(k);
+        if (bity_ed - bity_k + 1 < bity_N - 1 || bity_ed - bity_k - 2 > bity_N)
+        {
+            statystyki.odrzucone_dlugosc_phi++;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Sprawdza, czy redukt k/d wyznacza rozklad N. Dla phi(N) = (e*d - 1)/k
+// czynniki p, q sa pierwiastkami x^2 - s*x + N, gdzie s = p + q = N - phi(N) + 1.
+// W razie sukcesu zapisuje drugi czynnik w q.
+template <class Liczba>
+bool sprawdz_redukt(const Liczba& e, const Liczba& N, const Liczba& k, const Liczba& d,
+                    Liczba& q, ZmienneRobocze<Liczba>& z,
+                    const FiltryReduktow& filtry, StatystykiAtaku& statystyki)
+{
+    statystyki.redukty++;
+    z.stoper.przelacz(FAZA_FILTRY);
+    if (IsZero(k))
+    {
+        statystyki.odrzucone_k_zero++;
+        return false;
+    }
+    if (!przepusc_redukt(e, N, k, d, filtry, statystyki))
+    {
+        return false;
+    }
+    z.stoper.przelacz(FAZA_DZIELENIE);
+    policz(statystyki.pomiary.dzielenia);
+    mul(z.phiN, e, d);
+    sub(z.phiN, z.phiN, 1);
+    if (!divide(z.phiN, z.phiN, k))
+    {
+        statystyki.odrzucone_dzielenie++;
+        return false;
+    }
+    sub(z.s, N, z.phiN);
+    add(z.s, z.s, 1);
+    // s = p + q nalezy do (2 sqrt(N), 3 sqrt(N)), wiec ma co najwyzej
+    // ceil(NumBits(N) / 2) + 2 bity
+    if (filtry.przedzial_phi && (sign(z.s) <= 0 || NumBits(z.s) > (NumBits(N) + 1) / 2 + 2))
+    {
+        statystyki.odrzucone_przedzial_phi++;
+        return false;
+    }
+    // Delta rownania: s^2 - 4N
+    z.stoper.przelacz(FAZA_PIERWIASTEK);
+    sqr(z.delta, z.s);
+    LeftShift(z.tmp, N, 2);
+    sub(z.delta, z.delta, z.tmp);
+    if (sign(z.delta) < 0 || !moze_byc_kwadratem(z.delta))
+    {
+        statystyki.odrzucone_delta++;
+        return false;
+    }
+    policz(statystyki.pomiary.pierwiastki);
+    if (!pierwiastek_dokladny(z.pierwiastek, z.delta, z.tmp))
+    {
+        statystyki.odrzucone_delta++;
+        return false;
+    }
+    // Pierwiastek p = (s + sqrt(delta)) / 2 musi byc calkowity i dzielic N
+    add(z.p, z.s, z.pierwiastek);
+    if (IsOdd(z.p))
+    {
+        statystyki.odrzucone_pierwiastek++;
+        return false;
+    }
+    RightShift(z.p, z.p, 1);
+    if (sign(z.p) <= 0 || !divide(q, N, z.p))
+    {
+        statystyki.odrzucone_pierwiastek++;
+        return false;
+    }
+    return true;
+}
+
+
+// Czy biezacy redukt generatora lezy poza granica szukania
+template <class Liczba, class Generator>
+bool poza_granica(const Generator& generator, const GranicaSzukania& granica, const Liczba& granica_wienera)
+{
+    return (granica.wiener && granica_wienera < generator.d())
+           || (granica.max_bity_d > 0 && NumBits(generator.d()) > granica.max_bity_d)
+           || (granica.max_indeks >= 0 && generator.indeks() > granica.max_indeks);
+}
+
+
+// Redukt w pierscieniu potoku, z numerem w kolejnosci generatora
+template <class Liczba>
+struct ReduktPotoku
+{
+    Liczba k, d;
+    long numer, indeks;
+};
+
+// Stan watku sprawdzajacego redukty potoku
+template <class Liczba>
+struct SprawdzajacyPotoku
+{
+    ZmienneRobocze<Liczba> z;
+    StatystykiAtaku statystyki;
+    Liczba q, d;
+    long numer;   // numer reduktu z rozkladem, LONG_MAX = brak
+    long indeks;  // jego indeks w rozwinieciu
+
+    SprawdzajacyPotoku() : numer(LONG_MAX), indeks(-1) {}
+};
+
+
+// przeszukaj_redukty() w potoku: watek wolajacy liczy redukty i granice,
+// a watki_reduktow watkow sprawdza je rownolegle (sprawdz_redukt()), biorac
+// je z pierscienia bez blokad. Pierwszy rozklad zatrzymuje generator; wynikiem
+// jest redukt o najmniejszym numerze, jak w przeszukiwaniu po kolei, ale
+// liczniki i wyrazy moga objac kilka reduktow za nim, sprawdzonych lub
+// policzonych w tym samym czasie.
+template <class Liczba, class Generator>
+bool przeszukaj_potokiem(Generator& generator, const Liczba& e, const Liczba& N, Liczba& q, Liczba& d,
+                         const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki, ZmienneRobocze<Liczba>& z)
+{
+    long watki = ustawienia.watki_reduktow;
+    PierscienZadan<ReduktPotoku<Liczba> > pierscien(8 * watki);
+    for (size_t i = 0; i < pierscien.pojemnosc(); i++)
+    {
+        zarezerwuj(pierscien[i].k, NumBits(N));
+        zarezerwuj(pierscien[i].d, NumBits(N));
+    }
+    vector<SprawdzajacyPotoku<Liczba> > sprawdzajace(watki);
+    std::atomic<long> najmniejszy(LONG_MAX);   // najmniejszy numer reduktu z rozkladem
+    std::atomic<bool> koniec(false);           // generator nie doda juz reduktow
+
+    auto sprawdzaj = [&](long t) {
+        SprawdzajacyPotoku<Liczba>& s = sprawdzajace[t];
+        s.z.przygotuj(NumBits(N));
+        s.z.stoper = StoperFaz(ustawienia.pomiary ? &s.statystyki.pomiary : 0);
+        for (;;)
+        {
+            size_t pozycja;
+            ReduktPotoku<Liczba>* redukt = pierscien.zajmij(pozycja);
+            if (!redukt)
+            {
+                // Koniec sprawdzany przed ponowna proba, zeby nie zgubic ostatnich reduktow
+                if (koniec.load(std::memory_order_acquire) && !(redukt = pierscien.zajmij(pozycja)))
+                {
+                    break;
+                }
+                if (!redukt)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+            }
+            if (redukt->numer < najmniejszy.load(std::memory_order_relaxed)
+                && sprawdz_redukt(e, N, redukt->k, redukt->d, s.q, s.z, ustawienia.filtry, s.statystyki))
+            {
+                s.d = redukt->d;
+                s.numer = redukt->numer;
+                s.indeks = redukt->indeks;
+                long obecny = najmniejszy.load();
+                while (s.numer < obecny && !najmniejszy.compare_exchange_weak(obecny, s.numer))
+                {
+                }
+            }
+            pierscien.zwolnij(pozycja);
+        }
+        s.z.stoper.zatrzymaj();
+    };
+    vector<std::thread> watki_sprawdzajace;
+    for (long t = 0; t < watki; t++)
+    {
+        watki_sprawdzajace.push_back(std::thread(sprawdzaj, t));
+    }
+
+    const GranicaSzukania& granica = ustawienia.granica;
+    long numer = 0, kroki = 0;
+    bool za_granica = false;
+    while (najmniejszy.load(std::memory_order_relaxed) == LONG_MAX && generator.nastepny())
+    {
+        if (ustawienia.termin && ++kroki % KROK_BUDZETU == 0
+            && ustawienia.termin->dolicz(KROK_BUDZETU, false, generator.indeks(), NumBits(generator.d())))
+        {
+            break;
+        }
+        if (poza_granica(generator, granica, z.granica_wienera))
+        {
+            if (!generator.pewny())
+            {
+                continue;
+            }
+            za_granica = true;
+            break;
+        }
+        ReduktPotoku<Liczba>* redukt;
+        while (!(redukt = pierscien.wolna()) && najmniejszy.load(std::memory_order_relaxed) == LONG_MAX)
+        {
+            std::this_thread::yield();
+        }
+        if (!redukt)
+        {
+            break;
+        }
+        redukt->k = generator.k();
+        redukt->d = generator.d();
+        redukt->numer = numer++;
+        redukt->indeks = generator.indeks();
+        pierscien.opublikuj();
+    }
+    koniec.store(true, std::memory_order_release);
+    for (long t = 0; t < watki; t++)
+    {
+        watki_sprawdzajace[t].join();
+    }
+
+    long zwyciezca = -1;
+    for (long t = 0; t < watki; t++)
+    {
+        statystyki.dodaj(sprawdzajace[t].statystyki);
+        if (sprawdzajace[t].numer < LONG_MAX
+            && (zwyciezca < 0 || sprawdzajace[t].numer < sprawdzajace[zwyciezca].numer))
+        {
+            zwyciezca = t;
+        }
+    }
+    if (zwyciezca < 0)
+    {
+        statystyki.przerwane_granica += za_granica;
+        return false;
+    }
+    q = sprawdzajace[zwyciezca].q;
+    d = sprawdzajace[zwyciezca].d;
+    z.indeks = sprawdzajace[zwyciezca].indeks;
+    return true;
+}
+
+
+// Przeszukuje redukty e/N z generatora. Zwraca true i ustawia q (czynnik N)
+// oraz d (wykladnik prywatny), gdy ktorys redukt daje rozklad. Klucze od
+// PROG_POTOKU bitow z watki_reduktow > 1 przeszukiwane sa potokiem.
+template <class Liczba, class Generator>
+bool przeszukaj_redukty(Generator& generator, const Liczba& e, const Liczba& N, Liczba& q, Liczba& d,
+                        const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki, ZmienneRobocze<Liczba>& z)
+{
+    z.stoper = StoperFaz(ustawienia.pomiary ? &statystyki.pomiary : 0);
+    if (ustawienia.pomiary)
+    {
+        generator.mierz(&z.stoper);
+    }
+    const GranicaSzukania& granica = ustawienia.granica;
+    Liczba& granica_wienera = z.granica_wienera;
+    if (granica.wiener && !(z.N_granicy == N))
+    {
+        // floor(N^(1/4) / 3) = floor(floor(sqrt(floor(sqrt(N)))) / 3); kolejne
+        // klucze z tym samym N (atakuj_wykladniki()) uzywaja jej ponownie
+        SqrRoot(granica_wienera, N);
+        SqrRoot(granica_wienera, granica_wienera);
+        div(granica_wienera, granica_wienera, 3);
+        z.N_granicy = N;
+    }
+
+    long bity_precyzji = ustawienia.obciecie == OBCIECIE_POLOWA ? NumBits(N) / 2 + ZAPAS_OBCIECIA
+                                                                 : ustawienia.obciecie;
+    if (bity_precyzji > 0)
+    {
+        generator.obetnij(e, N, bity_precyzji);
+    }
+
+    bool znaleziono = false;
+    z.indeks = -1;
+    if (ustawienia.watki_reduktow > 1 && NumBits(N) >= PROG_POTOKU)
+    {
+        znaleziono = przeszukaj_potokiem(generator, e, N, q, d, ustawienia, statystyki, z);
+    }
+    else
+    {
+        TerminAtaku* termin = ustawienia.termin;
+        long kroki = 0;
+        while (generator.nastepny())
+        {
+            if (termin && ++kroki % KROK_BUDZETU == 0
+                && termin->dolicz(KROK_BUDZETU, false, generator.indeks(), NumBits(generator.d())))
+            {
+                break;
+            }
+            if (poza_granica(generator, granica, granica_wienera))
+            {
+                if (!generator.pewny())
+                {
+                    // Redukt obcietego rozwiniecia moze byc bledny, rozstrzyga koniec partii
+                    continue;
+                }
+                statystyki.przerwane_granica++;
+                break;
+            }
+            // Sprawdzanie czy wyznaczony w tej iteracji redukt to szukane k i d
+            if (sprawdz_redukt(e, N, generator.k(), generator.d(), q, z, ustawienia.filtry, statystyki))
+            {
+                d = generator.d();
+                z.indeks = generator.indeks();
+                znaleziono = true;
+                break;
+            }
+        }
+    }
+    z.stoper.zatrzymaj();
+    statystyki.rozszerzenia_precyzji += generator.rozszerzenia();
+    policz(statystyki.pomiary.wyrazy, generator.indeks() + 1);
+    return znaleziono;
+}
+
+
+// Stan ataku wielokrotnego uzytku: generatory reduktow wszystkich silnikow
+// i zmienne robocze. Watek atakujacy wiele kluczy trzyma jeden kontekst;
+// po przygotuj() na najdluzszy modul (lub po pierwszym kluczu danej dlugosci)
+// atak podstawowy nie alokuje pamieci.
+template <class Liczba>
+struct KontekstAtaku
+{
+    GeneratorReduktow<Liczba, RozwiniecieEuklidesa<Liczba> > euklides;
+    GeneratorReduktow<Liczba, RozwiniecieLehmera<Liczba> > lehmer;
+    GeneratorReduktow<Liczba, RozwiniecieHGCD<Liczba> > hgcd;
+    ZmienneRobocze<Liczba> z;
+    Liczba e, N, q, d;    // klucz i wynik po konwersji do arytmetyki Liczba
+    long bity;            // dlugosc modulu, na ktora zarezerwowano pamiec
+
+    KontekstAtaku() : bity(0) {}
+
+    void przygotuj(long bity_modulu)
+    {
+        if (bity_modulu <= bity)
+        {
+            return;
+        }
+        bity = bity_modulu;
+        euklides.przygotuj(bity);
+        lehmer.przygotuj(bity);
+        hgcd.przygotuj(bity);
+        z.przygotuj(bity);
+        Liczba* liczby[] = { &e, &N, &q, &d };
+        for (size_t i = 0; i < sizeof(liczby) / sizeof(liczby[0]); i++)
+        {
+            zarezerwuj(*liczby[i], bity);
+        }
+    }
+};
+
+
+// Atak Wienera na klucz (e, N) w wybranej arytmetyce i silnikiem rozwiniecia
+// z ustawien, na generatorach i zmiennych roboczych kontekstu
+template <class Liczba>
+bool atak_wienera(KontekstAtaku<Liczba>& kontekst, const Liczba& e, const Liczba& N, Liczba& q, Liczba& d,
+                  const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    kontekst.przygotuj(NumBits(N));
+    if (ustawienia.rozwiniecie == ROZWINIECIE_LEHMER)
+    {
+        kontekst.lehmer.uruchom(e, N);
+        return przeszukaj_redukty(kontekst.lehmer, e, N, q, d, ustawienia, statystyki, kontekst.z);
+    }
+    if (ustawienia.rozwiniecie == ROZWINIECIE_HGCD || ustawienia.rozwiniecie == ROZWINIECIE_AUTO)
+    {
+        long prog = ustawienia.rozwiniecie == ROZWINIECIE_HGCD ? 0 : ustawienia.prog_hgcd;
+        kontekst.hgcd.uruchom(e, N, prog);
+        return przeszukaj_redukty(kontekst.hgcd, e, N, q, d, ustawienia, statystyki, kontekst.z);
+    }
+    kontekst.euklides.uruchom(e, N);
+    return przeszukaj_redukty(kontekst.euklides, e, N, q, d, ustawienia, statystyki, kontekst.z);
+}
+
+
+// Jednorazowy atak Wienera na klucz (e, N) z wlasnym kontekstem
+template <class Liczba>
+bool atak_wienera(const Liczba& e, const Liczba& N, Liczba& q, Liczba& d,
+                  const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    KontekstAtaku<Liczba> kontekst;
+    return atak_wienera(kontekst, e, N, q, d, ustawienia, statystyki);
+}
+
+
+// Pelne rozwiniecie e/N w ulamek lancuchowy wybranym silnikiem
+// (prog_hgcd jak w UstawieniaAtaku)
+vector<ZZ> oblicz_wartosc_ulamka_lancuchowego(ZZ e, ZZ N, SilnikRozwiniecia silnik = ROZWINIECIE_EUKLIDES,
+                                              long prog_hgcd = PROG_HGCD);
+
+// Arytmetyka stala dla modulu do 64 * SLOWA_MODULU bitow: e*d i s^2 maja
+// do dwa razy wiecej bitow, plus slowo zapasu na przeniesienia
+template <long SLOWA_MODULU>
+struct LiczbaModulu
+{
+    typedef LiczbaStala<2 * SLOWA_MODULU + 2> Typ;
+};
+
+// Konteksty ataku w arytmetyce stalej, po jednym na obslugiwana szerokosc
+struct KontekstyStale
+{
+    KontekstAtaku<LiczbaModulu<1>::Typ> bity_64;
+    KontekstAtaku<LiczbaModulu<2>::Typ> bity_128;
+    KontekstAtaku<LiczbaModulu<4>::Typ> bity_256;
+    KontekstAtaku<LiczbaModulu<8>::Typ> bity_512;
+    KontekstAtaku<LiczbaModulu<16>::Typ> bity_1024;
+    KontekstAtaku<LiczbaModulu<32>::Typ> bity_2048;
+};
+
+// Konteksty ataku watku roboczego we wszystkich arytmetykach i bufor konwersji
+struct KontekstWatku
+{
+    KontekstAtaku<ZZ> ntl;
+    KontekstAtaku<LiczbaGMP> gmp;
+    KontekstyStale stale;
+    std::vector<unsigned char> bajty;
+    long indeks;   // indeks reduktu z rozkladem w ostatnim atak(), -1 = brak lub etap rozszerzony
+    TerminAtaku termin;  // budzet ostatniego atak(); miejsce przerwania, gdy zwiekszyl przerwane_budzet
+
+    KontekstWatku() : indeks(-1) {}
+};
+
+// Atak Wienera na klucz (e, N) na kontekscie watku; zwraca true i ustawia q
+// oraz d (i kontekst.indeks) w razie sukcesu. Liczniki etapow dodawane sa
+// do statystyki. Z ustawienia.budzet atak przerwany po wyczerpaniu budzetu
+// zwraca false, zwieksza przerwane_budzet i zapisuje miejsce w kontekst.termin.
+bool atak(const ZZ& e, const ZZ& N, ZZ& q, ZZ& d, KontekstWatku& kontekst,
+          const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki);
+
+// Atak Wienera na klucz (e, N); zwraca [q, d] w razie sukcesu, [0] gdy nie
+// znaleziono wykladnika prywatnego. Liczniki etapow dodawane sa do statystyki.
+vector<ZZ> atak(ZZ e, ZZ N, const UstawieniaAtaku& ustawienia = UstawieniaAtaku(),
+                StatystykiAtaku* statystyki = 0);
+
+#endif
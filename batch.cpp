@@ -0,0 +1,1144 @@
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <map>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include "batch.h"
+#include "corpus.h"
+#include "batch_gcd.h"
+#include "key_import.h"
+#include "thread_pool.h"
+#include "lanes.h"
+#include "cache.h"
+#include "checkpoint.h"
+#include "generator.h"
+#ifdef WIENER_CUDA
+#include "gpu.h"
+#endif
+
+
+static void split(const std::string &s, char delim, std::vector<std::string> &elems)
+{
+    std::stringstream ss;
+    ss.str(s);
+    std::string item;
+    while (std::getline(ss, item, delim))
+    {
+        elems.push_back(item);
+    }
+}
+
+
+static long znajdz_kolumne(const std::vector<std::string>& naglowek, const std::string& nazwa)
+{
+    for (long i = 0; i < (long)naglowek.size(); i++)
+    {
+        if (naglowek[i] == nazwa)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+
+bool wczytaj_wsad(const std::string& sciezka, vector<KluczWsadu>& klucze)
+{
+    if (jest_korpusem(sciezka))
+    {
+        return wczytaj_korpus(sciezka, klucze);
+    }
+    if (jest_plikiem_kluczy(sciezka))
+    {
+        return wczytaj_klucze_publiczne(sciezka, klucze);
+    }
+    std::ifstream plik(sciezka.c_str());
+    std::string line;
+    if (!plik || !std::getline(plik, line))
+    {
+        std::cerr << "Nie mozna odczytac pliku " << sciezka << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> naglowek;
+    split(line, '\t', naglowek);
+    long kol_bin_size = znajdz_kolumne(naglowek, "bin_size");
+    long kol_e = znajdz_kolumne(naglowek, "e");
+    long kol_N = znajdz_kolumne(naglowek, "N");
+    long kol_d = znajdz_kolumne(naglowek, "d");
+    if (kol_e < 0 || kol_N < 0)
+    {
+        std::cerr << "Brak kolumny e lub N w naglowku pliku " << sciezka << std::endl;
+        return false;
+    }
+
+    long nr_linii = 1;
+    while (std::getline(plik, line))
+    {
+        nr_linii++;
+        if (line.empty())
+        {
+            continue;
+        }
+        std::vector<std::string> line_values;
+        split(line, '\t', line_values);
+        if ((long)line_values.size() <= kol_e || (long)line_values.size() <= kol_N)
+        {
+            std::cerr << "Pomijam niepelna linie " << nr_linii << std::endl;
+            continue;
+        }
+
+        KluczWsadu klucz;
+        std::istringstream(line_values[kol_e]) >> klucz.e;
+        std::istringstream(line_values[kol_N]) >> klucz.N;
+        if (kol_d >= 0 && (long)line_values.size() > kol_d)
+        {
+            std::istringstream(line_values[kol_d]) >> klucz.d;
+        }
+        if (kol_bin_size >= 0 && (long)line_values.size() > kol_bin_size)
+        {
+            klucz.bin_size = atol(line_values[kol_bin_size].c_str());
+        }
+        else
+        {
+            klucz.bin_size = NumBits(klucz.N);
+        }
+        if (sign(klucz.e) <= 0 || sign(klucz.N) <= 0)
+        {
+            std::cerr << "Pomijam niepoprawny klucz w linii " << nr_linii << std::endl;
+            continue;
+        }
+        klucze.push_back(klucz);
+    }
+    return true;
+}
+
+
+void generuj_klucze(long bin_size, long liczba, vector<KluczWsadu>& klucze)
+{
+    KluczGeneratora klucz;
+    for (long i = 0; i < liczba; i++)
+    {
+        generuj_klucz(bin_size, 0, false, klucz);
+        klucze.push_back(klucz.klucz);
+    }
+}
+
+
+// Lista filtrow rozdzielona przecinkami (odd-d, even-phi, phi-range) lub none
+static bool wczytaj_filtry(const std::string& lista, FiltryReduktow& filtry)
+{
+    filtry.nieparzyste_d = false;
+    filtry.parzyste_phi = false;
+    filtry.przedzial_phi = false;
+    if (lista == "none")
+    {
+        return true;
+    }
+    size_t poczatek = 0;
+    while (poczatek <= lista.size())
+    {
+        size_t koniec = lista.find(',', poczatek);
+        if (koniec == std::string::npos)
+        {
+            koniec = lista.size();
+        }
+        std::string filtr = lista.substr(poczatek, koniec - poczatek);
+        if (filtr == "odd-d")
+        {
+            filtry.nieparzyste_d = true;
+        }
+        else if (filtr == "even-phi")
+        {
+            filtry.parzyste_phi = true;
+        }
+        else if (filtr == "phi-range")
+        {
+            filtry.przedzial_phi = true;
+        }
+        else
+        {
+            return false;
+        }
+        poczatek = koniec + 1;
+    }
+    return true;
+}
+
+
+bool wczytaj_arytmetyke(const std::string& nazwa, Arytmetyka& arytmetyka)
+{
+    if (nazwa == "ntl")
+    {
+        arytmetyka = ARYTMETYKA_NTL;
+    }
+    else if (nazwa == "gmp")
+    {
+        arytmetyka = ARYTMETYKA_GMP;
+    }
+    else if (nazwa == "fixed")
+    {
+        arytmetyka = ARYTMETYKA_STALA;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+bool wczytaj_silnik(const std::string& nazwa, SilnikRozwiniecia& silnik)
+{
+    if (nazwa == "euclid")
+    {
+        silnik = ROZWINIECIE_EUKLIDES;
+    }
+    else if (nazwa == "lehmer")
+    {
+        silnik = ROZWINIECIE_LEHMER;
+    }
+    else if (nazwa == "hgcd")
+    {
+        silnik = ROZWINIECIE_HGCD;
+    }
+    else if (nazwa == "auto")
+    {
+        silnik = ROZWINIECIE_AUTO;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+const char* nazwa_arytmetyki(Arytmetyka arytmetyka)
+{
+    switch (arytmetyka)
+    {
+    case ARYTMETYKA_GMP:
+        return "gmp";
+    case ARYTMETYKA_STALA:
+        return "fixed";
+    default:
+        return "ntl";
+    }
+}
+
+
+const char* nazwa_silnika(SilnikRozwiniecia silnik)
+{
+    switch (silnik)
+    {
+    case ROZWINIECIE_EUKLIDES:
+        return "euclid";
+    case ROZWINIECIE_LEHMER:
+        return "lehmer";
+    case ROZWINIECIE_HGCD:
+        return "hgcd";
+    default:
+        return "auto";
+    }
+}
+
+
+bool wczytaj_opcje_wsadu(int argc, char* argv[], int& i, UstawieniaWsadu& ustawienia)
+{
+    std::string opcja = argv[i];
+    if (opcja == "--threads" && i + 1 < argc)
+    {
+        ustawienia.watki = atol(argv[++i]);
+    }
+    else if (opcja == "--backend" && i + 1 < argc)
+    {
+        return wczytaj_arytmetyke(argv[++i], ustawienia.atak.arytmetyka);
+    }
+    else if (opcja == "--cf" && i + 1 < argc)
+    {
+        return wczytaj_silnik(argv[++i], ustawienia.atak.rozwiniecie);
+    }
+    else if (opcja == "--truncate" && i + 1 < argc)
+    {
+        std::string bity = argv[++i];
+        ustawienia.atak.obciecie = bity == "half" ? OBCIECIE_POLOWA : bity == "off" ? 0 : atol(bity.c_str());
+    }
+    else if (opcja == "--extend-bits" && i + 1 < argc)
+    {
+        ustawienia.atak.rozszerzenie.bity = atol(argv[++i]);
+        if (ustawienia.atak.rozszerzenie.bity < 0 || ustawienia.atak.rozszerzenie.bity > MAKS_BITY_ROZSZERZENIA)
+        {
+            std::cerr << "Liczba bitow --extend-bits musi byc z zakresu 0.." << MAKS_BITY_ROZSZERZENIA << std::endl;
+            return false;
+        }
+    }
+    else if (opcja == "--extend-method" && i + 1 < argc && std::string(argv[i + 1]) == "vvt")
+    {
+        ustawienia.atak.rozszerzenie.metoda = ROZSZERZENIE_VVT;
+        i++;
+    }
+    else if (opcja == "--extend-method" && i + 1 < argc && std::string(argv[i + 1]) == "dujella")
+    {
+        ustawienia.atak.rozszerzenie.metoda = ROZSZERZENIE_DUJELLA;
+        i++;
+    }
+    else if (opcja == "--extend-memory" && i + 1 < argc)
+    {
+        ustawienia.atak.rozszerzenie.pamiec = atol(argv[++i]) << 20;
+    }
+    else if (opcja == "--extend-threads" && i + 1 < argc)
+    {
+        ustawienia.atak.rozszerzenie.watki = atol(argv[++i]);
+    }
+    else if (opcja == "--convergent-threads" && i + 1 < argc)
+    {
+        ustawienia.atak.watki_reduktow = atol(argv[++i]);
+    }
+    else if (opcja == "--hgcd-threshold" && i + 1 < argc)
+    {
+        ustawienia.atak.prog_hgcd = atol(argv[++i]);
+    }
+    else if (opcja == "--filters" && i + 1 < argc)
+    {
+        return wczytaj_filtry(argv[++i], ustawienia.atak.filtry);
+    }
+    else if (opcja == "--bound" && i + 1 < argc && std::string(argv[i + 1]) == "wiener")
+    {
+        ustawienia.atak.granica.wiener = true;
+        i++;
+    }
+    else if (opcja == "--max-d-bits" && i + 1 < argc)
+    {
+        ustawienia.atak.granica.max_bity_d = atol(argv[++i]);
+    }
+    else if (opcja == "--max-index" && i + 1 < argc)
+    {
+        ustawienia.atak.granica.max_indeks = atol(argv[++i]);
+    }
+    else if (opcja == "--time-budget-us" && i + 1 < argc)
+    {
+        ustawienia.atak.budzet.czas_ns = (long long)(atof(argv[++i]) * 1000);
+        return ustawienia.atak.budzet.czas_ns > 0;
+    }
+    else if (opcja == "--step-budget" && i + 1 < argc)
+    {
+        ustawienia.atak.budzet.kroki = atol(argv[++i]);
+        return ustawienia.atak.budzet.kroki > 0;
+    }
+    else if (opcja == "--profile")
+    {
+        ustawienia.atak.pomiary = true;
+    }
+    else if (opcja == "--shared-factors")
+    {
+        ustawienia.wspolne_czynniki = true;
+    }
+    else if (opcja == "--gcd-spill" && i + 1 < argc)
+    {
+        ustawienia.wspolne_czynniki = true;
+        ustawienia.katalog_wymiany = argv[++i];
+    }
+    else if (opcja == "--repeat" && i + 1 < argc)
+    {
+        ustawienia.powtorzenia = atol(argv[++i]);
+    }
+    else if (opcja == "--cache" && i + 1 < argc)
+    {
+        ustawienia.pamiec = argv[++i];
+    }
+    else if (opcja == "--checkpoint" && i + 1 < argc)
+    {
+        ustawienia.punkt_kontrolny = argv[++i];
+    }
+    else if (opcja == "--checkpoint-every" && i + 1 < argc)
+    {
+        ustawienia.interwal_punktow = atol(argv[++i]);
+        return ustawienia.interwal_punktow > 0;
+    }
+    else if (opcja == "--lanes" && i + 1 < argc)
+    {
+        ustawienia.pasma = atol(argv[++i]);
+        return ustawienia.pasma >= 0 && ustawienia.pasma <= MAKS_PASM;
+    }
+    else if (opcja == "--gpu")
+    {
+#ifdef WIENER_CUDA
+        ustawienia.gpu = true;
+#else
+        std::cerr << "Program zbudowany bez silnika GPU (WIENER_CUDA, zob. build.sh)" << std::endl;
+        return false;
+#endif
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+
+void liczniki_wyniku(StatystykiAtaku& s, long* liczniki[LICZNIKI_WYNIKU])
+{
+    long* pola[LICZNIKI_WYNIKU] = { &s.redukty, &s.odrzucone_k_zero, &s.odrzucone_nieparzyste_d,
+                                    &s.odrzucone_parzyste_phi, &s.odrzucone_dlugosc_phi, &s.odrzucone_dzielenie,
+                                    &s.odrzucone_przedzial_phi, &s.odrzucone_delta, &s.odrzucone_pierwiastek,
+                                    &s.przerwane_granica, &s.rozszerzenia_precyzji, &s.kandydaci_rozszerzenia,
+                                    &s.pomiary.wyrazy, &s.pomiary.dzielenia, &s.pomiary.pierwiastki,
+                                    &s.przerwane_budzet };
+    memcpy(liczniki, pola, sizeof(pola));
+}
+
+
+void wypisz_przerwanie(std::ostream& wyjscie, const PrzerwanieBudzetu& przerwanie)
+{
+    wyjscie << "Przekroczony budzet";
+    if (przerwanie.indeks >= 0)
+    {
+        wyjscie << (przerwanie.rozszerzenie ? " extension_pair = " : " convergent = ") << przerwanie.indeks
+                << " d_bits = " << przerwanie.bity_d;
+    }
+}
+
+
+// Sprawdza, czy znalezione d odwraca e modulo phi(N) i zgadza sie z d z pliku
+static void sprawdz_wynik(const KluczWsadu& klucz, WynikKlucza& wynik_klucza, KontekstWsadu& kontekst)
+{
+    wynik_klucza.poprawny = false;
+    if (wynik_klucza.znaleziono)
+    {
+        // phi(N) = N - p - q + 1
+        div(kontekst.p, klucz.N, kontekst.q);
+        sub(kontekst.phiN, klucz.N, kontekst.p);
+        sub(kontekst.phiN, kontekst.phiN, kontekst.q);
+        add(kontekst.phiN, kontekst.phiN, 1);
+        MulMod(kontekst.p, klucz.e, wynik_klucza.d, kontekst.phiN);
+        wynik_klucza.poprawny = IsOne(kontekst.p) && (IsZero(klucz.d) || klucz.d == wynik_klucza.d);
+    }
+}
+
+
+void atakuj_klucz(const KluczWsadu& klucz, const UstawieniaAtaku& ustawienia, WynikKlucza& wynik_klucza,
+                  KontekstWsadu& kontekst)
+{
+    wynik_klucza.statystyki = StatystykiAtaku();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    wynik_klucza.znaleziono = atak(klucz.e, klucz.N, kontekst.q, wynik_klucza.d, kontekst.atak, ustawienia,
+                                   wynik_klucza.statystyki);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    wynik_klucza.czas_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    wynik_klucza.przerwanie = przekroczony_budzet(wynik_klucza) ? kontekst.atak.termin.przerwanie : PrzerwanieBudzetu();
+    sprawdz_wynik(klucz, wynik_klucza, kontekst);
+}
+
+
+// Atakuje grupe kluczy jednoslowowych w pasmach; klucz, ktorego pasmo
+// zrezygnowalo, atakowany jest osobno
+static void atakuj_pasmami(const vector<KluczWsadu>& klucze, const long* indeksy, long liczba,
+                           const UstawieniaAtaku& ustawienia, vector<WynikKlucza>& wyniki,
+                           KontekstWsadu& kontekst)
+{
+    KluczPasma pasma[MAKS_PASM];
+    for (long j = 0; j < liczba; j++)
+    {
+        const KluczWsadu& klucz = klucze[indeksy[j]];
+        pasma[j].e = (unsigned long long)trunc_long(klucz.e, 64);
+        pasma[j].N = (unsigned long long)trunc_long(klucz.N, 64);
+    }
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    atak_pasmowy(pasma, liczba, ustawienia);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    long long czas_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+
+    for (long j = 0; j < liczba; j++)
+    {
+        const KluczWsadu& klucz = klucze[indeksy[j]];
+        WynikKlucza& wynik_klucza = wyniki[indeksy[j]];
+        if (pasma[j].wynik == PASMO_REZYGNACJA)
+        {
+            atakuj_klucz(klucz, ustawienia, wynik_klucza, kontekst);
+            continue;
+        }
+        wynik_klucza.statystyki = pasma[j].statystyki;
+        wynik_klucza.czas_ns = czas_ns / liczba;
+        wynik_klucza.znaleziono = pasma[j].wynik == PASMO_ZNALEZIONO;
+        if (wynik_klucza.znaleziono)
+        {
+            conv(kontekst.q, (unsigned long)pasma[j].q);
+            conv(wynik_klucza.d, (unsigned long)pasma[j].d);
+        }
+        sprawdz_wynik(klucz, wynik_klucza, kontekst);
+    }
+}
+
+
+#ifdef WIENER_CUDA
+// Atakuje klucze na GPU; czas przebiegu dzielony jest po rowno miedzy klucze.
+// Klucze, ktore GPU oddalo, a po bledzie CUDA wszystkie, trafiaja do
+// rezygnacje i sa atakowane na procesorze.
+static void atakuj_na_gpu(const vector<KluczWsadu>& klucze, const vector<long>& indeksy,
+                          const UstawieniaAtaku& ustawienia, vector<WynikKlucza>& wyniki, KontekstWsadu& kontekst,
+                          vector<long>& rezygnacje)
+{
+    vector<ZadanieGpu> zadania(indeksy.size());
+    for (size_t j = 0; j < indeksy.size(); j++)
+    {
+        zadania[j].e = klucze[indeksy[j]].e;
+        zadania[j].N = klucze[indeksy[j]].N;
+    }
+    std::string blad;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    if (!atak_gpu(zadania, ustawienia, blad))
+    {
+        std::cerr << "Blad GPU: " << blad << ", klucze atakowane na procesorze" << std::endl;
+        rezygnacje = indeksy;
+        return;
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    long long czas_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+
+    for (size_t j = 0; j < indeksy.size(); j++)
+    {
+        const KluczWsadu& klucz = klucze[indeksy[j]];
+        WynikKlucza& wynik_klucza = wyniki[indeksy[j]];
+        if (zadania[j].rezygnacja)
+        {
+            rezygnacje.push_back(indeksy[j]);
+            continue;
+        }
+        wynik_klucza.statystyki = zadania[j].statystyki;
+        wynik_klucza.czas_ns = czas_ns / (long long)indeksy.size();
+        wynik_klucza.znaleziono = zadania[j].znaleziono;
+        if (wynik_klucza.znaleziono)
+        {
+            kontekst.q = zadania[j].q;
+            wynik_klucza.d = zadania[j].d;
+        }
+        sprawdz_wynik(klucz, wynik_klucza, kontekst);
+    }
+}
+#endif
+
+
+// Czy klucz ma byc atakowany na GPU
+#ifdef WIENER_CUDA
+static bool na_gpu(const KluczWsadu& klucz, const UstawieniaWsadu& ustawienia)
+{
+    return ustawienia.gpu && pasuje_do_gpu(klucz.e, klucz.N, ustawienia.atak);
+}
+#else
+static bool na_gpu(const KluczWsadu&, const UstawieniaWsadu&)
+{
+    return false;
+}
+#endif
+
+
+// Klucz rozlozony przez batch-GCD: d = e^(-1) mod phi(N) z czynnika
+static void rozloz_klucz(const KluczWsadu& klucz, const ZZ& czynnik, WynikKlucza& wynik_klucza,
+                         KontekstWsadu& kontekst)
+{
+    wynik_klucza.statystyki = StatystykiAtaku();
+    wynik_klucza.wspolny_czynnik = true;
+    wynik_klucza.czas_ns = 0;
+    // phi(N) = (p - 1)(q - 1)
+    div(kontekst.q, klucz.N, czynnik);
+    sub(kontekst.q, kontekst.q, 1);
+    sub(kontekst.p, czynnik, 1);
+    mul(kontekst.phiN, kontekst.p, kontekst.q);
+    rem(kontekst.p, klucz.e, kontekst.phiN);
+    wynik_klucza.znaleziono = InvModStatus(wynik_klucza.d, kontekst.p, kontekst.phiN) == 0;
+    wynik_klucza.poprawny = wynik_klucza.znaleziono && (IsZero(klucz.d) || klucz.d == wynik_klucza.d);
+}
+
+
+// Ile reduktow odrzucil kazdy etap sprawdzania
+void wypisz_statystyki(const StatystykiAtaku& s)
+{
+    std::cout << "    convergents = " << s.redukty
+              << " rejected: k_zero = " << s.odrzucone_k_zero
+              << " odd_d = " << s.odrzucone_nieparzyste_d
+              << " even_phi = " << s.odrzucone_parzyste_phi
+              << " phi_bits = " << s.odrzucone_dlugosc_phi
+              << " divide = " << s.odrzucone_dzielenie
+              << " phi_range = " << s.odrzucone_przedzial_phi
+              << " delta = " << s.odrzucone_delta
+              << " root = " << s.odrzucone_pierwiastek
+              << " stopped_at_bound = " << s.przerwane_granica
+              << " budget_exceeded = " << s.przerwane_budzet
+              << " precision_extensions = " << s.rozszerzenia_precyzji
+              << " extension_candidates = " << s.kandydaci_rozszerzenia
+              << std::endl;
+}
+
+
+void wypisz_pomiary(const PomiaryAtaku& p, bool czasy)
+{
+    if (!WIENER_POMIARY)
+    {
+        return;
+    }
+    std::cout << "    cf_terms = " << p.wyrazy
+              << " divide_tests = " << p.dzielenia
+              << " sqrt_calls = " << p.pierwiastki;
+    if (czasy)
+    {
+        std::cout << " time[" << JEDNOSTKA_CZASU << "]:";
+        for (long f = 0; f < LICZBA_FAZ; f++)
+        {
+            std::cout << " " << nazwa_fazy(f) << " = " << p.czas[f];
+        }
+    }
+    std::cout << std::endl;
+}
+
+
+long wypisz_wyniki(const vector<KluczWsadu>& klucze, const vector<WynikKlucza>& wyniki, const vector<ZZ>& czynniki,
+                   const UstawieniaWsadu& ustawienia)
+{
+    // Statystyki zbiorcze dla kazdego bin_size
+    struct Podsumowanie
+    {
+        long klucze, znalezione, bledne, wspolne, z_pamieci;
+        long long czas_ns;
+        StatystykiAtaku statystyki;
+    };
+    std::map<long, Podsumowanie> podsumowanie;
+    long bledne = 0;
+
+    for (long i = 0; i < (long)klucze.size(); i++)
+    {
+        const WynikKlucza& wynik_klucza = wyniki[i];
+
+        std::cout << "[" << i + 1 << "] bin_size = " << klucze[i].bin_size << "[b] ";
+        if (wynik_klucza.znaleziono)
+        {
+            std::cout << "d = " << wynik_klucza.d << " ";
+        }
+        if (wynik_klucza.wspolny_czynnik)
+        {
+            std::cout << "shared_factor = " << czynniki[i] << " ";
+        }
+        else if (wynik_klucza.z_pamieci)
+        {
+            std::cout << "cached ";
+        }
+        else
+        {
+            std::cout << "Time = " << wynik_klucza.czas_ns / 1000.0 << "[µs] ";
+        }
+        if (przekroczony_budzet(wynik_klucza))
+        {
+            wypisz_przerwanie(std::cout, wynik_klucza.przerwanie);
+            std::cout << std::endl;
+        }
+        else if (!wynik_klucza.znaleziono)
+        {
+            std::cout << "Nic nie znalazlem :(" << std::endl;
+        }
+        else if (wynik_klucza.poprawny)
+        {
+            std::cout << "OK" << std::endl;
+        }
+        else
+        {
+            std::cout << "Niepoprawny wynik" << std::endl;
+        }
+        if (ustawienia.atak.pomiary)
+        {
+            wypisz_statystyki(wynik_klucza.statystyki);
+            wypisz_pomiary(wynik_klucza.statystyki.pomiary, true);
+        }
+
+        Podsumowanie& p = podsumowanie[klucze[i].bin_size];
+        p.klucze++;
+        p.znalezione += wynik_klucza.znaleziono;
+        p.wspolne += wynik_klucza.wspolny_czynnik;
+        p.z_pamieci += wynik_klucza.z_pamieci;
+        p.bledne += wynik_klucza.znaleziono && !wynik_klucza.poprawny;
+        p.czas_ns += wynik_klucza.czas_ns;
+        p.statystyki.dodaj(wynik_klucza.statystyki);
+        bledne += wynik_klucza.znaleziono && !wynik_klucza.poprawny;
+    }
+
+    for (std::map<long, Podsumowanie>::const_iterator it = podsumowanie.begin(); it != podsumowanie.end(); ++it)
+    {
+        const Podsumowanie& p = it->second;
+        std::cout << "bin_size = " << it->first << "[b] keys = " << p.klucze
+                  << " found = " << p.znalezione << " wrong = " << p.bledne;
+        if (ustawienia.wspolne_czynniki)
+        {
+            std::cout << " shared = " << p.wspolne;
+        }
+        if (!ustawienia.pamiec.empty())
+        {
+            std::cout << " cached = " << p.z_pamieci;
+        }
+        std::cout << " Time = " << p.czas_ns / 1000.0 << "[µs]"
+                  << " throughput = " << (p.czas_ns > 0 ? p.klucze * 1e9 / p.czas_ns : 0.0) << "[keys/s]"
+                  << std::endl;
+        wypisz_statystyki(p.statystyki);
+        wypisz_pomiary(p.statystyki.pomiary, ustawienia.atak.pomiary);
+    }
+    return bledne;
+}
+
+
+int uruchom_wsad(const std::string& sciezka, const UstawieniaWsadu& ustawienia)
+{
+    vector<KluczWsadu> klucze;
+    if (!wczytaj_wsad(sciezka, klucze))
+    {
+        return 1;
+    }
+
+    // Kazdy watek zapisuje wynik na pozycji klucza, wiec raport jest
+    // deterministyczny niezaleznie od liczby watkow
+    vector<WynikKlucza> wyniki(klucze.size());
+    long watki = liczba_watkow_roboczych(ustawienia.watki);
+    // Liczniki kazdego watku sumowane sa tylko przez ten watek
+    vector<StatystykiAtaku> statystyki_watkow(watki);
+    vector<KontekstWsadu> konteksty(watki);
+
+    // Klucze rozlozone przez batch-GCD nie trafiaja do kolejki ataku
+    vector<ZZ> czynniki;
+    long powtorzone = 0, rozlozone = 0;
+    long long czas_nwd_ns = 0;
+    if (ustawienia.wspolne_czynniki)
+    {
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        if (!wspolne_czynniki(klucze, watki, ustawienia.katalog_wymiany, czynniki, powtorzone))
+        {
+            return 1;
+        }
+        for (long i = 0; i < (long)klucze.size(); i++)
+        {
+            if (!IsZero(czynniki[i]))
+            {
+                rozloz_klucz(klucze[i], czynniki[i], wyniki[i], konteksty[0]);
+                rozlozone++;
+            }
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        czas_nwd_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    }
+
+    // Klucze ukonczone przed przerwaniem przebiegu nie sa atakowane ponownie;
+    // ostatni stan punktow kontrolnych nalezy do watku GPU
+    PunktyKontrolne punkty(klucze, wyniki, watki + 1);
+    bool z_punktami = !ustawienia.punkt_kontrolny.empty();
+    long wznowione = 0;
+    if (z_punktami && !punkty.otworz(ustawienia.punkt_kontrolny, ustawienia.atak, wznowione))
+    {
+        return 1;
+    }
+
+    // Klucze z wynikiem w pamieci wynikow tez nie sa atakowane
+    PamiecWynikow pamiec;
+    bool z_pamiecia = !ustawienia.pamiec.empty();
+    if (z_pamiecia && !pamiec.otworz(ustawienia.pamiec))
+    {
+        return 1;
+    }
+
+    // Klucze jednoslowowe ida do pasm, w grupach kolejnych kluczy z pliku, a z
+    // --gpu klucze, ktore mieszcza sie na GPU, w calosci na GPU
+    vector<long> kolejnosc, pasmowe, gpu;
+    for (long i = 0; i < (long)klucze.size(); i++)
+    {
+        if (wyniki[i].wspolny_czynnik || (z_punktami && punkty.ukonczony(i)))
+        {
+            continue;
+        }
+        if (z_pamiecia && pamiec.znajdz(klucze[i].e, klucze[i].N, ustawienia.atak, wyniki[i].znaleziono, wyniki[i].d))
+        {
+            wyniki[i].z_pamieci = true;
+            wyniki[i].poprawny = wyniki[i].znaleziono && (IsZero(klucze[i].d) || klucze[i].d == wyniki[i].d);
+            continue;
+        }
+        if (na_gpu(klucze[i], ustawienia))
+        {
+            gpu.push_back(i);
+        }
+        else if (ustawienia.pasma > 1 && pasuje_do_pasm(klucze[i].e, klucze[i].N, ustawienia.atak))
+        {
+            pasmowe.push_back(i);
+        }
+        else
+        {
+            kolejnosc.push_back(i);
+        }
+    }
+    DluzszyModul porzadek = { &klucze };
+    std::sort(kolejnosc.begin(), kolejnosc.end(), porzadek);
+    vector<long> grupy;
+    for (long j = 0; j < (long)pasmowe.size(); j += ustawienia.pasma)
+    {
+        grupy.push_back(j);
+    }
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    if (z_punktami)
+    {
+        punkty.uruchom(ustawienia.interwal_punktow);
+    }
+    // GPU liczy swoje klucze w czasie, gdy watki atakuja pozostale
+    vector<long> rezygnacje_gpu;
+    std::thread watek_gpu;
+#ifdef WIENER_CUDA
+    KontekstWsadu kontekst_gpu;
+    if (!gpu.empty())
+    {
+        watek_gpu = std::thread([&]() {
+            atakuj_na_gpu(klucze, gpu, ustawienia.atak, wyniki, kontekst_gpu, rezygnacje_gpu);
+            std::sort(rezygnacje_gpu.begin(), rezygnacje_gpu.end());
+            for (size_t j = 0; z_punktami && j < gpu.size(); j++)
+            {
+                if (!std::binary_search(rezygnacje_gpu.begin(), rezygnacje_gpu.end(), gpu[j]))
+                {
+                    punkty.zakoncz(watki, gpu[j]);
+                }
+            }
+        });
+    }
+#endif
+    auto atakuj = [&](long i, long nr_watku) {
+        UstawieniaAtaku ustawienia_klucza = ustawienia.atak;
+        if (z_punktami)
+        {
+            punkty.rozpocznij(nr_watku, i, ustawienia_klucza);
+        }
+        atakuj_klucz(klucze[i], ustawienia_klucza, wyniki[i], konteksty[nr_watku]);
+        statystyki_watkow[nr_watku].dodaj(wyniki[i].statystyki);
+        if (z_punktami)
+        {
+            punkty.zakoncz(nr_watku, i);
+        }
+    };
+    wykonaj_rownolegle(kolejnosc, watki, atakuj);
+    wykonaj_rownolegle(grupy, watki, [&](long j, long nr_watku) {
+        long liczba = min((long)pasmowe.size() - j, ustawienia.pasma);
+        atakuj_pasmami(klucze, &pasmowe[j], liczba, ustawienia.atak, wyniki, konteksty[nr_watku]);
+        for (long i = j; i < j + liczba; i++)
+        {
+            statystyki_watkow[nr_watku].dodaj(wyniki[pasmowe[i]].statystyki);
+            if (z_punktami)
+            {
+                punkty.zakoncz(nr_watku, pasmowe[i]);
+            }
+        }
+    });
+    if (watek_gpu.joinable())
+    {
+        watek_gpu.join();
+        std::sort(rezygnacje_gpu.begin(), rezygnacje_gpu.end(), porzadek);
+        wykonaj_rownolegle(rezygnacje_gpu, watki, atakuj);
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    long long czas_calkowity_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    if (z_punktami && !punkty.zatrzymaj(true))
+    {
+        return 1;
+    }
+
+    // Do pamieci trafiaja tylko sprawdzone wyniki
+    for (long i = 0; z_pamiecia && i < (long)klucze.size(); i++)
+    {
+        const WynikKlucza& wynik_klucza = wyniki[i];
+        if (!wynik_klucza.wspolny_czynnik && !wynik_klucza.z_pamieci && !przekroczony_budzet(wynik_klucza)
+            && (!wynik_klucza.znaleziono || wynik_klucza.poprawny))
+        {
+            pamiec.dodaj(klucze[i].e, klucze[i].N, ustawienia.atak, wynik_klucza.znaleziono, wynik_klucza.d);
+        }
+    }
+    if (z_pamiecia && !pamiec.zapisz())
+    {
+        return 1;
+    }
+
+    long bledne = wypisz_wyniki(klucze, wyniki, czynniki, ustawienia);
+    if (ustawienia.atak.pomiary)
+    {
+        for (long t = 0; t < watki; t++)
+        {
+            std::cout << "thread = " << t << std::endl;
+            wypisz_statystyki(statystyki_watkow[t]);
+            wypisz_pomiary(statystyki_watkow[t].pomiary, true);
+        }
+    }
+    if (ustawienia.wspolne_czynniki)
+    {
+        std::cout << "batch-gcd keys = " << klucze.size() << " factored = " << rozlozone
+                  << " duplicate_moduli = " << powtorzone
+                  << " Time = " << czas_nwd_ns / 1000.0 << "[µs]" << std::endl;
+    }
+    if (z_punktami)
+    {
+        std::cout << "checkpoint resumed = " << wznowione << std::endl;
+    }
+    std::cout << "threads = " << watki << " keys = " << klucze.size()
+              << " Wall time = " << czas_calkowity_ns / 1000.0 << "[µs]"
+              << " throughput = " << (czas_calkowity_ns > 0 ? klucze.size() * 1e9 / czas_calkowity_ns : 0.0) << "[keys/s]"
+              << std::endl;
+    return bledne == 0 ? 0 : 1;
+}
+
+
+int skanuj_klucze(const std::string& sciezka, const UstawieniaWsadu& ustawienia)
+{
+    CzytnikKluczy czytnik;
+    if (!czytnik.otworz(sciezka))
+    {
+        return 1;
+    }
+
+    struct KluczSkanu
+    {
+        long nr, linia;
+        KluczWsadu klucz;
+    };
+    long watki = liczba_watkow_roboczych(ustawienia.watki);
+    KolejkaOgraniczona<KluczSkanu> kolejka(4 * watki);
+    std::mutex wyjscie;
+    std::atomic<long> znalezione(0), bledne(0);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    vector<std::thread> pracownicy;
+    for (long t = 0; t < watki; t++)
+    {
+        pracownicy.push_back(std::thread([&]() {
+            KontekstWsadu kontekst;
+            WynikKlucza wynik_klucza;
+            KluczSkanu k;
+            while (kolejka.pobierz(k))
+            {
+                atakuj_klucz(k.klucz, ustawienia.atak, wynik_klucza, kontekst);
+                std::ostringstream linia;
+                linia << "[" << k.nr << "] line = " << k.linia << " bin_size = " << k.klucz.bin_size << "[b] ";
+                if (wynik_klucza.znaleziono)
+                {
+                    linia << "d = " << wynik_klucza.d << " ";
+                }
+                linia << "Time = " << wynik_klucza.czas_ns / 1000.0 << "[µs] ";
+                if (przekroczony_budzet(wynik_klucza))
+                {
+                    wypisz_przerwanie(linia, wynik_klucza.przerwanie);
+                }
+                else
+                {
+                    linia << (!wynik_klucza.znaleziono ? "Nic nie znalazlem :(" : wynik_klucza.poprawny ? "OK" : "Niepoprawny wynik");
+                }
+                linia << "\n";
+                znalezione += wynik_klucza.znaleziono;
+                bledne += wynik_klucza.znaleziono && !wynik_klucza.poprawny;
+                std::lock_guard<std::mutex> blokada(wyjscie);
+                std::cout << linia.str();
+            }
+        }));
+    }
+
+    KluczSkanu k;
+    long klucze = 0;
+    while (czytnik.nastepny(k.klucz.e, k.klucz.N))
+    {
+        k.nr = ++klucze;
+        k.linia = czytnik.linia();
+        k.klucz.bin_size = NumBits(k.klucz.N);
+        kolejka.wstaw(k);
+    }
+    kolejka.zamknij();
+    for (size_t t = 0; t < pracownicy.size(); t++)
+    {
+        pracownicy[t].join();
+    }
+    long long czas_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+    std::cout << "threads = " << watki << " keys = " << klucze << " found = " << znalezione
+              << " wrong = " << bledne << " Wall time = " << czas_ns / 1000.0 << "[µs]"
+              << " throughput = " << (czas_ns > 0 ? klucze * 1e9 / czas_ns : 0.0) << "[keys/s]" << std::endl;
+    return bledne == 0 ? 0 : 1;
+}
+
+
+// Mediana czasu ataku na klucz: jedno uruchomienie rozgrzewajace, potem
+// zadana liczba pomiarow
+static long long mediana_czasu(const KluczWsadu& klucz, const UstawieniaAtaku& ustawienia, long powtorzenia,
+                               WynikKlucza& wynik_klucza, KontekstWsadu& kontekst)
+{
+    vector<long long> czasy;
+    atakuj_klucz(klucz, ustawienia, wynik_klucza, kontekst);
+    for (long r = 0; r < powtorzenia; r++)
+    {
+        atakuj_klucz(klucz, ustawienia, wynik_klucza, kontekst);
+        czasy.push_back(wynik_klucza.czas_ns);
+    }
+    std::sort(czasy.begin(), czasy.end());
+    return czasy.empty() ? wynik_klucza.czas_ns : czasy[czasy.size() / 2];
+}
+
+
+int porownaj_arytmetyki(const std::string& sciezka, const UstawieniaWsadu& ustawienia)
+{
+    vector<KluczWsadu> klucze;
+    if (!wczytaj_wsad(sciezka, klucze))
+    {
+        return 1;
+    }
+
+    struct Porownanie
+    {
+        long klucze;
+        long long czas_ntl_ns, czas_gmp_ns;
+    };
+    std::map<long, Porownanie> porownanie;
+    long bledne = 0;
+    KontekstWsadu kontekst;
+
+    for (long i = 0; i < (long)klucze.size(); i++)
+    {
+        WynikKlucza wynik_ntl, wynik_gmp;
+        UstawieniaAtaku ntl = ustawienia.atak, gmp = ustawienia.atak;
+        ntl.arytmetyka = ARYTMETYKA_NTL;
+        gmp.arytmetyka = ARYTMETYKA_GMP;
+        long long czas_ntl = mediana_czasu(klucze[i], ntl, ustawienia.powtorzenia, wynik_ntl, kontekst);
+        long long czas_gmp = mediana_czasu(klucze[i], gmp, ustawienia.powtorzenia, wynik_gmp, kontekst);
+        if (wynik_ntl.znaleziono != wynik_gmp.znaleziono || wynik_ntl.poprawny != wynik_gmp.poprawny
+            || (wynik_ntl.znaleziono && wynik_ntl.d != wynik_gmp.d))
+        {
+            std::cout << "[" << i + 1 << "] Rozne wyniki NTL i GMP" << std::endl;
+            bledne++;
+        }
+        Porownanie& p = porownanie[klucze[i].bin_size];
+        p.klucze++;
+        p.czas_ntl_ns += czas_ntl;
+        p.czas_gmp_ns += czas_gmp;
+    }
+
+    for (std::map<long, Porownanie>::const_iterator it = porownanie.begin(); it != porownanie.end(); ++it)
+    {
+        const Porownanie& p = it->second;
+        std::cout << "bin_size = " << it->first << "[b] keys = " << p.klucze
+                  << " NTL = " << p.czas_ntl_ns / 1000.0 / p.klucze << "[µs/key]"
+                  << " GMP = " << p.czas_gmp_ns / 1000.0 / p.klucze << "[µs/key]"
+                  << " speedup = " << (p.czas_gmp_ns > 0 ? (double)p.czas_ntl_ns / p.czas_gmp_ns : 0.0)
+                  << std::endl;
+    }
+    return bledne == 0 ? 0 : 1;
+}
+
+
+// Pobiera wszystkie wyrazy z silnika rozwiniecia, zwraca ich liczbe
+template <class Liczba, class Rozwiniecie>
+static long przejdz_rozwiniecie(Rozwiniecie& rozwiniecie, Liczba& ostatni)
+{
+    long wyrazy = 0;
+    while (rozwiniecie.nastepny(ostatni))
+    {
+        wyrazy++;
+    }
+    return wyrazy;
+}
+
+
+static long long czas_od(std::chrono::steady_clock::time_point poczatek)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - poczatek).count();
+}
+
+
+// Czas samego rozwiniecia e/N (bez reduktow i ich sprawdzania) w silniku
+// Euklidesa, Lehmera i czystym half-GCD
+template <class Liczba>
+static void zmierz_rozwiniecia(const ZZ& e, const ZZ& N, long long czasy[3], bool& zgodne)
+{
+    Liczba e_l, N_l, ostatni[3];
+    conv(e_l, e);
+    conv(N_l, N);
+    long wyrazy[3];
+
+    std::chrono::steady_clock::time_point poczatek = std::chrono::steady_clock::now();
+    RozwiniecieEuklidesa<Liczba> euklides(e_l, N_l);
+    wyrazy[0] = przejdz_rozwiniecie(euklides, ostatni[0]);
+    czasy[0] = czas_od(poczatek);
+
+    poczatek = std::chrono::steady_clock::now();
+    RozwiniecieLehmera<Liczba> lehmer(e_l, N_l);
+    wyrazy[1] = przejdz_rozwiniecie(lehmer, ostatni[1]);
+    czasy[1] = czas_od(poczatek);
+
+    poczatek = std::chrono::steady_clock::now();
+    RozwiniecieHGCD<Liczba> hgcd(e_l, N_l, 0);
+    wyrazy[2] = przejdz_rozwiniecie(hgcd, ostatni[2]);
+    czasy[2] = czas_od(poczatek);
+
+    zgodne = wyrazy[0] == wyrazy[1] && wyrazy[0] == wyrazy[2]
+             && ostatni[0] == ostatni[1] && ostatni[0] == ostatni[2];
+}
+
+
+int porownaj_rozwiniecia(long maks_bity, const UstawieniaWsadu& ustawienia)
+{
+    // Mediana wymaga co najmniej jednego pomiaru
+    if (ustawienia.powtorzenia < 1)
+    {
+        std::cerr << "Liczba pomiarow --repeat musi byc dodatnia" << std::endl;
+        return 1;
+    }
+    long prog = 0;
+    long bledne = 0;
+    for (long bity = 1024; bity <= maks_bity; bity *= 2)
+    {
+        vector<long long> euklides, lehmer, hgcd;
+        for (long r = 0; r < ustawienia.powtorzenia; r++)
+        {
+            ZZ N = RandomBits_ZZ(bity);
+            SetBit(N, bity - 1);
+            ZZ e = RandomBnd(N);
+            long long czasy[3];
+            bool zgodne;
+            if (ustawienia.atak.arytmetyka == ARYTMETYKA_GMP)
+            {
+                zmierz_rozwiniecia<LiczbaGMP>(e, N, czasy, zgodne);
+            }
+            else
+            {
+                zmierz_rozwiniecia<ZZ>(e, N, czasy, zgodne);
+            }
+            if (!zgodne)
+            {
+                std::cout << "[" << bity << "] Rozna liczba wyrazow rozwiniecia" << std::endl;
+                bledne++;
+            }
+            euklides.push_back(czasy[0]);
+            lehmer.push_back(czasy[1]);
+            hgcd.push_back(czasy[2]);
+        }
+        std::sort(euklides.begin(), euklides.end());
+        std::sort(lehmer.begin(), lehmer.end());
+        std::sort(hgcd.begin(), hgcd.end());
+        long long m_euklides = euklides[euklides.size() / 2];
+        long long m_lehmer = lehmer[lehmer.size() / 2];
+        long long m_hgcd = hgcd[hgcd.size() / 2];
+        if (prog == 0 && m_hgcd < m_lehmer)
+        {
+            prog = bity;
+        }
+        std::cout << "bits = " << bity
+                  << " euclid = " << m_euklides / 1000.0 << "[µs]"
+                  << " lehmer = " << m_lehmer / 1000.0 << "[µs]"
+                  << " hgcd = " << m_hgcd / 1000.0 << "[µs]"
+                  << " speedup = " << (m_hgcd > 0 ? (double)m_lehmer / m_hgcd : 0.0) << std::endl;
+    }
+    if (prog > 0)
+    {
+        std::cout << "hgcd-threshold = " << prog << std::endl;
+    }
+    else
+    {
+        std::cout << "hgcd-threshold > " << maks_bity << std::endl;
+    }
+    return bledne == 0 ? 0 : 1;
+}
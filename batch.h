@@ -0,0 +1,157 @@
+#ifndef WIENER_BATCH_H
+#define WIENER_BATCH_H
+
+#include <string>
+#include <ostream>
+#include "attack.h"
+
+// Pojedynczy klucz wczytany z pliku wsadowego
+struct KluczWsadu
+{
+    long bin_size; // rozmiar modulu z kolumny bin_size (lub NumBits(N))
+    ZZ e;
+    ZZ N;
+    ZZ d;          // oczekiwany wykladnik prywatny, 0 gdy plik go nie zawiera
+};
+
+// Wynik ataku na pojedynczy klucz z pliku wsadowego
+struct WynikKlucza
+{
+    bool znaleziono;
+    bool poprawny;
+    bool wspolny_czynnik;   // rozlozony przez batch-GCD, bez ataku
+    bool z_pamieci;         // wynik z pamieci wynikow (cache.h), bez ataku
+    ZZ d;
+    long long czas_ns;
+    StatystykiAtaku statystyki;
+    PrzerwanieBudzetu przerwanie; // miejsce wyczerpania budzetu (przekroczony_budzet())
+
+    WynikKlucza() : znaleziono(false), poprawny(false), wspolny_czynnik(false), z_pamieci(false), czas_ns(0) {}
+};
+
+// Czy atak na klucz przerwano po wyczerpaniu budzetu (UstawieniaAtaku::budzet)
+inline bool przekroczony_budzet(const WynikKlucza& wynik)
+{
+    return !wynik.znaleziono && wynik.statystyki.przerwane_budzet > 0;
+}
+
+// Wypisuje "Przekroczony budzet" i miejsce przerwania, gdy jest znane
+void wypisz_przerwanie(std::ostream& wyjscie, const PrzerwanieBudzetu& przerwanie);
+
+// Liczniki StatystykiAtaku i PomiaryAtaku (bez czasow faz) w stalej
+// kolejnosci, w jakiej wynik klucza zapisywany jest poza procesem
+// (checkpoint.h, distributed.h)
+const long LICZNIKI_WYNIKU = 16;
+void liczniki_wyniku(StatystykiAtaku& s, long* liczniki[LICZNIKI_WYNIKU]);
+
+// Ustawienia przebiegu wsadowego
+struct UstawieniaWsadu
+{
+    long watki;             // liczba watkow roboczych, 0 = wszystkie rdzenie
+    UstawieniaAtaku atak;   // arytmetyka i filtry uzywane w ataku
+    long powtorzenia;       // liczba pomiarow na klucz przy porownaniu arytmetyk
+    bool wspolne_czynniki;  // przebieg wstepny batch-GCD (batch_gcd.h)
+    std::string katalog_wymiany; // katalog na poziomy drzew batch-GCD, pusty = pamiec
+    long pasma;             // klucze jednoslowowe atakowane po tyle naraz (lanes.h), <= 1 = osobno
+    std::string pamiec;     // plik pamieci wynikow (cache.h), pusty = bez pamieci
+    std::string punkt_kontrolny; // plik punktow kontrolnych (checkpoint.h), pusty = bez
+    long interwal_punktow;  // sekundy miedzy zapisami punktow kontrolnych
+    bool gpu;               // klucze do BITY_GPU bitow atakowane na GPU (gpu.h, tylko z WIENER_CUDA)
+
+    UstawieniaWsadu()
+        : watki(1), powtorzenia(10), wspolne_czynniki(false), pasma(8), interwal_punktow(60), gpu(false) {}
+};
+
+// Wczytuje plik w formacie test_values.txt: kolumny rozdzielone tabulatorem,
+// pierwszy wiersz to naglowek z nazwami kolumn (wymagane sa e oraz N), albo
+// korpus binarny (corpus.h), albo klucze PEM/DER/OpenSSH (key_import.h)
+bool wczytaj_wsad(const std::string& sciezka, vector<KluczWsadu>& klucze);
+
+// Dopisuje liczba kluczy o module bin_size bitow podatnych na atak Wienera,
+// tak jak generate_test_values.py: p, q po bin_size / 2 bitow,
+// d z [2, floor(N^(1/4) / 3)], e = d^(-1) mod phi(N)
+void generuj_klucze(long bin_size, long liczba, vector<KluczWsadu>& klucze);
+
+// Stan watku przebiegu wsadowego, uzywany dla kolejnych kluczy: kontekst
+// ataku i liczby do sprawdzenia wyniku
+struct KontekstWsadu
+{
+    KontekstWatku atak;
+    ZZ q, p, phiN;
+};
+
+// Porzadek szeregowania: najpierw najdluzsze moduly, przy rownej dlugosci
+// kolejnosc z pliku
+struct DluzszyModul
+{
+    const vector<KluczWsadu>* klucze;
+
+    bool operator()(long a, long b) const
+    {
+        long bity_a = NumBits((*klucze)[a].N);
+        long bity_b = NumBits((*klucze)[b].N);
+        return bity_a != bity_b ? bity_a > bity_b : a < b;
+    }
+};
+
+// Atakuje pojedynczy klucz, mierzy czas ataku i sprawdza wynik. Z budzetem
+// ataku klucz moze zakonczyc sie przekroczonym budzetem (przekroczony_budzet()).
+void atakuj_klucz(const KluczWsadu& klucz, const UstawieniaAtaku& ustawienia, WynikKlucza& wynik_klucza,
+                  KontekstWsadu& kontekst);
+
+// Nazwy arytmetyk (ntl, gmp, fixed) i silnikow rozwiniecia (euclid, lehmer, hgcd, auto)
+// uzywane w opcjach --backend i --cf
+bool wczytaj_arytmetyke(const std::string& nazwa, Arytmetyka& arytmetyka);
+bool wczytaj_silnik(const std::string& nazwa, SilnikRozwiniecia& silnik);
+const char* nazwa_arytmetyki(Arytmetyka arytmetyka);
+const char* nazwa_silnika(SilnikRozwiniecia silnik);
+
+// Wczytuje opcje argv[i] (wraz z wartoscia, i wskazuje wtedy na wartosc) do
+// ustawien; zwraca false dla nieznanej opcji lub niepoprawnej wartosci
+bool wczytaj_opcje_wsadu(int argc, char* argv[], int& i, UstawieniaWsadu& ustawienia);
+
+// Wypisuje liczniki etapow sprawdzania reduktow w jednej linii
+void wypisz_statystyki(const StatystykiAtaku& s);
+
+// Dlugosc rozwiniecia, liczba testow i czas faz (czasy, przy --profile);
+// nic, gdy program zbudowano bez WIENER_POMIARY
+void wypisz_pomiary(const PomiaryAtaku& p, bool czasy);
+
+// Wypisuje wynik i czas kazdego klucza (w kolejnosci z pliku) oraz
+// podsumowanie dla kazdego bin_size; zwraca liczbe niepoprawnych wynikow.
+// czynniki to wyniki batch-GCD (tylko dla kluczy z wspolny_czynnik).
+long wypisz_wyniki(const vector<KluczWsadu>& klucze, const vector<WynikKlucza>& wyniki, const vector<ZZ>& czynniki,
+                   const UstawieniaWsadu& ustawienia);
+
+// Atakuje w jednym procesie wszystkie klucze z pliku, wypisuje wynik i czas
+// dla kazdego klucza (w kolejnosci z pliku) oraz przepustowosc w rozbiciu na
+// bin_size. Klucze rozdzielane sa miedzy watki od najdluzszego modulu. Z
+// wspolne_czynniki najpierw cala lista przechodzi przez batch-GCD, a klucze
+// rozlozone wspolnym czynnikiem nie sa juz atakowane. Klucze o module do 64
+// bitow atakowane sa grupami po ustawienia.pasma (atak_pasmowy()), a czas
+// grupy dzielony jest po rowno miedzy jej klucze. Z pamiec atakowane sa tylko
+// klucze, ktorych wyniku nie ma w pamieci wynikow, a ich wyniki sa do niej
+// dopisywane. Z punkt_kontrolny przebieg przerwany w trakcie wznawiany jest od
+// ostatniego punktu kontrolnego, a po jego ukonczeniu plik jest usuwany. Z
+// gpu klucze, ktore pasuja do GPU (pasuje_do_gpu()), atakowane sa na GPU
+// rownolegle z watkami, a te, z ktorymi GPU sobie nie poradzilo, na koncu w
+// watkach.
+int uruchom_wsad(const std::string& sciezka, const UstawieniaWsadu& ustawienia);
+
+// Atakuje klucze PEM/DER/OpenSSH strumieniowo: czytanie pliku wstrzymuje sie,
+// gdy watki nie nadazaja, wiec pamiec nie zalezy od liczby kluczy. Wyniki
+// wypisywane sa w kolejnosci zakonczenia, z numerem klucza i linii w pliku.
+int skanuj_klucze(const std::string& sciezka, const UstawieniaWsadu& ustawienia);
+
+// Mierzy czas ataku na kazdym kluczu z pliku w arytmetyce NTL i GMP
+// (rozgrzewka i ustawienia.powtorzenia pomiarow, brana jest mediana) i wypisuje
+// porownanie w rozbiciu na bin_size
+int porownaj_arytmetyki(const std::string& sciezka, const UstawieniaWsadu& ustawienia);
+
+// Porownuje czas rozwiniecia losowych par e < N (od 1024 do maks_bity bitow,
+// co dwa razy wiecej, mediana z ustawienia.powtorzenia par) w silnikach
+// Euklidesa, Lehmera i half-GCD; wypisuje rozmiar, od ktorego half-GCD
+// wygrywa z Lehmerem, jako propozycje progu --hgcd-threshold
+int porownaj_rozwiniecia(long maks_bity, const UstawieniaWsadu& ustawienia);
+
+#endif
@@ -0,0 +1,388 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <deque>
+#include <cstdio>
+#include <unistd.h>
+#include "batch_gcd.h"
+#include "thread_pool.h"
+
+
+// Najwiekszy blok poziomu wczytywany naraz przy katalogu wymiany
+static const long BLOK_WYMIANY = 64L << 20;
+
+
+// Poziom drzewa iloczynow lub reszt zapisywany raz i czytany po kolei od
+// poczatku (przewin). Bez sciezki liczby zostaja w pamieci, ze sciezka trafiaja
+// do pliku jako dlugosc (uint64) i bajty liczby od najmlodszego.
+class PoziomDrzewa
+{
+public:
+    PoziomDrzewa() : liczba(0), odczytane(0), poprawny(true) {}
+
+    ~PoziomDrzewa()
+    {
+        zwolnij();
+    }
+
+    void utworz(const std::string& sciezka_pliku)
+    {
+        sciezka = sciezka_pliku;
+        if (!sciezka.empty())
+        {
+            zapis.open(sciezka.c_str(), std::ios::binary | std::ios::trunc);
+            poprawny = (bool)zapis;
+        }
+    }
+
+    void dopisz(const ZZ& x)
+    {
+        liczba++;
+        if (sciezka.empty())
+        {
+            liczby.push_back(x);
+            return;
+        }
+        unsigned long long bajty = NumBytes(x);
+        bufor.resize(8 + bajty);
+        for (int i = 0; i < 8; i++)
+        {
+            bufor[i] = (unsigned char)(bajty >> (8 * i));
+        }
+        BytesFromZZ(bufor.data() + 8, x, bajty);
+        poprawny = poprawny && zapis.write((const char*)bufor.data(), bufor.size());
+    }
+
+    void przewin()
+    {
+        odczytane = 0;
+        if (!sciezka.empty())
+        {
+            if (zapis.is_open())
+            {
+                zapis.close();
+                poprawny = poprawny && !zapis.fail();
+            }
+            odczyt.close();
+            odczyt.clear();
+            odczyt.open(sciezka.c_str(), std::ios::binary);
+            poprawny = poprawny && odczyt;
+        }
+    }
+
+    void czytaj(ZZ& x)
+    {
+        if (sciezka.empty())
+        {
+            x = liczby[odczytane++];
+            return;
+        }
+        odczytane++;
+        unsigned char dlugosc[8];
+        unsigned long long bajty = 0;
+        poprawny = poprawny && odczyt.read((char*)dlugosc, sizeof(dlugosc));
+        for (int i = 7; poprawny && i >= 0; i--)
+        {
+            bajty = (bajty << 8) | dlugosc[i];
+        }
+        bufor.resize(bajty);
+        poprawny = poprawny && odczyt.read((char*)bufor.data(), bajty);
+        ZZFromBytes(x, bufor.data(), poprawny ? bajty : 0);
+    }
+
+    // Zwalnia pamiec poziomu i usuwa jego plik
+    void zwolnij()
+    {
+        std::vector<ZZ>().swap(liczby);
+        std::vector<unsigned char>().swap(bufor);
+        if (!sciezka.empty())
+        {
+            zapis.close();
+            odczyt.close();
+            std::remove(sciezka.c_str());
+            sciezka.clear();
+        }
+    }
+
+    long rozmiar() const
+    {
+        return liczba;
+    }
+
+    bool blad() const
+    {
+        return !poprawny;
+    }
+
+    const std::string& plik() const
+    {
+        return sciezka;
+    }
+
+private:
+    std::string sciezka;
+    std::vector<ZZ> liczby;
+    std::ofstream zapis;
+    std::ifstream odczyt;
+    std::vector<unsigned char> bufor;
+    long liczba, odczytane;
+    bool poprawny;
+};
+
+
+// Odczyt poziomu 0 drzewa prosto z kluczy, bez kopii wszystkich modulow
+struct OdczytModulow
+{
+    const vector<KluczWsadu>* klucze;
+    long nastepny;
+
+    void czytaj(ZZ& x)
+    {
+        x = (*klucze)[nastepny++].N;
+    }
+};
+
+
+// Wczytuje kolejne liczby poziomu, az blok przekroczy BLOK_WYMIANY bajtow
+// (zawsze parzysta liczba, chyba ze to koniec poziomu) albo do konca poziomu
+template <class Odczyt>
+static long wczytaj_blok(Odczyt& poziom, long pozostalo, vector<ZZ>& blok)
+{
+    long m = 0, bajty = 0;
+    while (m < pozostalo && (bajty < BLOK_WYMIANY || m % 2 == 1))
+    {
+        if (m == (long)blok.size())
+        {
+            blok.resize(m + 1);
+        }
+        poziom.czytaj(blok[m]);
+        bajty += NumBytes(blok[m]);
+        m++;
+    }
+    return m;
+}
+
+
+static void indeksy(long m, vector<long>& kolejnosc)
+{
+    kolejnosc.resize(m);
+    for (long j = 0; j < m; j++)
+    {
+        kolejnosc[j] = j;
+    }
+}
+
+
+// Poziom iloczynow sasiednich par poziomu nizej
+template <class Odczyt>
+static void zbuduj_poziom(Odczyt& dzieci, long n, PoziomDrzewa& cel, long watki)
+{
+    vector<ZZ> blok, iloczyny;
+    vector<long> kolejnosc;
+    for (long i = 0; i < n; )
+    {
+        long m = wczytaj_blok(dzieci, n - i, blok);
+        iloczyny.resize((m + 1) / 2);
+        indeksy(iloczyny.size(), kolejnosc);
+        wykonaj_rownolegle(kolejnosc, watki, [&](long j, long) {
+            if (2 * j + 1 < m)
+            {
+                mul(iloczyny[j], blok[2 * j], blok[2 * j + 1]);
+            }
+            else
+            {
+                iloczyny[j] = blok[2 * j];
+            }
+        });
+        for (long j = 0; j < (long)iloczyny.size(); j++)
+        {
+            cel.dopisz(iloczyny[j]);
+        }
+        i += m;
+    }
+}
+
+
+// Reszty poziomu z reszt rodzicow: R_j = R_rodzica mod X_j^2. Na poziomie 0
+// (ostatni) zamiast reszty zapisywane jest gcd(N_j, R_j / N_j).
+template <class Odczyt>
+static void zejdz_poziom(Odczyt& dzieci, long n, PoziomDrzewa& rodzice, PoziomDrzewa& cel, bool ostatni,
+                         long watki)
+{
+    vector<ZZ> blok, reszty_rodzicow, wynik;
+    vector<ZZ> kwadraty(watki), reszty(watki);
+    vector<long> kolejnosc;
+    rodzice.przewin();
+    for (long i = 0; i < n; )
+    {
+        long m = wczytaj_blok(dzieci, n - i, blok);
+        reszty_rodzicow.resize((m + 1) / 2);
+        for (long j = 0; j < (long)reszty_rodzicow.size(); j++)
+        {
+            rodzice.czytaj(reszty_rodzicow[j]);
+        }
+        wynik.resize(m);
+        indeksy(m, kolejnosc);
+        wykonaj_rownolegle(kolejnosc, watki, [&](long j, long nr_watku) {
+            ZZ& kwadrat = kwadraty[nr_watku];
+            if (IsZero(blok[j]))
+            {
+                // tylko po bledzie odczytu pliku wymiany
+                clear(wynik[j]);
+                return;
+            }
+            sqr(kwadrat, blok[j]);
+            if (!ostatni)
+            {
+                rem(wynik[j], reszty_rodzicow[j / 2], kwadrat);
+                return;
+            }
+            ZZ& reszta = reszty[nr_watku];
+            rem(reszta, reszty_rodzicow[j / 2], kwadrat);
+            div(reszta, reszta, blok[j]);
+            GCD(wynik[j], blok[j], reszta);
+        });
+        for (long j = 0; j < m; j++)
+        {
+            cel.dopisz(wynik[j]);
+        }
+        i += m;
+    }
+}
+
+
+static std::string plik_poziomu(const std::string& katalog, const char* drzewo, long poziom)
+{
+    if (katalog.empty())
+    {
+        return "";
+    }
+    std::ostringstream nazwa;
+    nazwa << katalog << "/wiener_" << getpid() << "_" << drzewo << poziom << ".tmp";
+    return nazwa.str();
+}
+
+
+static bool sprawdz_poziom(const PoziomDrzewa& poziom)
+{
+    if (poziom.blad())
+    {
+        std::cerr << "Blad zapisu lub odczytu pliku wymiany " << poziom.plik() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+bool wspolne_czynniki(const vector<KluczWsadu>& klucze, long watki, const std::string& katalog_wymiany,
+                      vector<ZZ>& czynniki, long& powtorzone)
+{
+    long n = klucze.size();
+    czynniki.assign(n, ZZ());
+    powtorzone = 0;
+    if (n < 2)
+    {
+        return true;
+    }
+    watki = liczba_watkow_roboczych(watki);
+
+    // iloczyny[k] to poziom k + 1 drzewa, ostatni ma jeden element P
+    std::deque<PoziomDrzewa> iloczyny;
+    OdczytModulow moduly = { &klucze, 0 };
+    iloczyny.emplace_back();
+    iloczyny.back().utworz(plik_poziomu(katalog_wymiany, "product", 1));
+    zbuduj_poziom(moduly, n, iloczyny.back(), watki);
+    while (iloczyny.back().rozmiar() > 1)
+    {
+        PoziomDrzewa& dzieci = iloczyny.back();
+        if (!sprawdz_poziom(dzieci))
+        {
+            return false;
+        }
+        dzieci.przewin();
+        iloczyny.emplace_back();
+        iloczyny.back().utworz(plik_poziomu(katalog_wymiany, "product", iloczyny.size()));
+        zbuduj_poziom(dzieci, dzieci.rozmiar(), iloczyny.back(), watki);
+    }
+
+    // Reszta w korzeniu to samo P (P mod P^2); kazdy poziom iloczynow jest
+    // zwalniany zaraz po policzeniu reszt jego dzieci
+    std::deque<PoziomDrzewa> reszty;
+    for (long k = (long)iloczyny.size() - 1; k >= 0; k--)
+    {
+        PoziomDrzewa& rodzice = reszty.empty() ? iloczyny[k] : reszty.back();
+        reszty.emplace_back();
+        PoziomDrzewa& cel = reszty.back();
+        cel.utworz(plik_poziomu(katalog_wymiany, "remainder", k));
+        if (k > 0)
+        {
+            PoziomDrzewa& dzieci = iloczyny[k - 1];
+            dzieci.przewin();
+            zejdz_poziom(dzieci, dzieci.rozmiar(), rodzice, cel, false, watki);
+            if (!sprawdz_poziom(dzieci))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            moduly.nastepny = 0;
+            zejdz_poziom(moduly, n, rodzice, cel, true, watki);
+        }
+        if (!sprawdz_poziom(rodzice))
+        {
+            return false;
+        }
+        rodzice.zwolnij();
+        iloczyny[k].zwolnij();
+        if (reszty.size() > 1)
+        {
+            reszty.pop_front();
+        }
+    }
+
+    PoziomDrzewa& nwd = reszty.back();
+    nwd.przewin();
+    vector<long> wspolny_modul, z_czynnikiem;
+    for (long i = 0; i < n; i++)
+    {
+        ZZ g;
+        nwd.czytaj(g);
+        if (IsOne(g))
+        {
+            continue;
+        }
+        z_czynnikiem.push_back(i);
+        if (g == klucze[i].N)
+        {
+            wspolny_modul.push_back(i);
+        }
+        else
+        {
+            czynniki[i] = g;
+        }
+    }
+    if (!sprawdz_poziom(nwd))
+    {
+        return false;
+    }
+
+    // gcd rowne N_i: oba czynniki wspolne z innymi modulami albo powtorzony
+    // modul; tych kluczy jest zwykle niewiele, wiec wystarcza porownanie par
+    ZZ g;
+    for (long a = 0; a < (long)wspolny_modul.size(); a++)
+    {
+        long i = wspolny_modul[a];
+        for (long b = 0; b < (long)z_czynnikiem.size() && IsZero(czynniki[i]); b++)
+        {
+            long j = z_czynnikiem[b];
+            GCD(g, klucze[i].N, klucze[j].N);
+            if (!IsOne(g) && g != klucze[i].N)
+            {
+                czynniki[i] = g;
+            }
+        }
+        powtorzone += IsZero(czynniki[i]);
+    }
+    return true;
+}
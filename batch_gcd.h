@@ -0,0 +1,28 @@
+#ifndef WIENER_BATCH_GCD_H
+#define WIENER_BATCH_GCD_H
+
+#include <string>
+#include "batch.h"
+
+// Batch-GCD Bernsteina: wspolne czynniki pierwsze wszystkich modulow naraz.
+//
+// Drzewo iloczynow: poziom 0 to moduly N_i, kazdy wyzszy poziom to iloczyny
+// sasiednich par (nieparzysty ostatni element przechodzi bez zmian), az do
+// iloczynu P wszystkich modulow. Drzewo reszt schodzi od P w dol:
+// R_i = R_rodzica mod X_i^2, wiec na poziomie 0 R_i = P mod N_i^2 i
+// gcd(N_i, R_i / N_i) = gcd(N_i, P / N_i). Calosc kosztuje tyle, co kilka
+// mnozen liczb dlugosci P, zamiast porownywania kazdej pary kluczy.
+//
+// Kazdy poziom drzewa zajmuje okolo tyle pamieci, co P. Z katalogiem wymiany
+// poziomy zapisywane sa do plikow i czytane blokami, wiec w pamieci naraz jest
+// tylko blok poziomu i blok jego rodzicow; bez niego cale drzewo jest w pamieci.
+
+// Dla kazdego klucza czynniki[i] to nietrywialny dzielnik N_i wspolny z innym
+// modulem albo 0. Gdy oba czynniki N_i sa wspolne z innymi modulami (gcd
+// rowne N_i), dzielnik szukany jest parami wsrod kluczy z nietrywialnym gcd;
+// powtorzone moduly nie daja dzielnika i sa liczone w powtorzone. Zwraca
+// false po bledzie zapisu lub odczytu katalogu wymiany.
+bool wspolne_czynniki(const vector<KluczWsadu>& klucze, long watki, const std::string& katalog_wymiany,
+                      vector<ZZ>& czynniki, long& powtorzone);
+
+#endif
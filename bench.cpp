@@ -0,0 +1,329 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include "batch.h"
+
+// Pomiar czasu ataku w rozbiciu na bin_size, arytmetyke i silnik rozwiniecia.
+// Kazdy klucz atakowany jest --warmup razy bez pomiaru, potem --repeat razy
+// z pomiarem; z wszystkich pomiarow danego bin_size liczone sa min, mediana,
+// p95, p99 i przepustowosc. Wynik w CSV lub JSON, zeby porownywac kolejne
+// wersje programu i ustawienia miedzy soba.
+//
+//   bench <plik> [opcje]
+//   bench --generate 512,1024,2048 [--keys K] [--seed S] [opcje]
+//
+// Opcje: --warmup W, --repeat N, --format csv|json, --output plik,
+// --backends ntl,gmp,fixed, --engines euclid,lehmer,hgcd,auto oraz opcje ataku
+// z wiener --batch.
+
+
+struct WynikPomiaru
+{
+    Arytmetyka arytmetyka;
+    SilnikRozwiniecia silnik;
+    long bin_size;
+    long klucze, proby, znalezione, bledne;
+    long long min_ns, mediana_ns, p95_ns, p99_ns, suma_ns;
+};
+
+
+static void podziel(const std::string& lista, std::vector<std::string>& elementy)
+{
+    std::stringstream ss(lista);
+    std::string element;
+    while (std::getline(ss, element, ','))
+    {
+        elementy.push_back(element);
+    }
+}
+
+
+// Percentyl z posortowanych czasow (najblizsza pozycja)
+static long long percentyl(const vector<long long>& czasy, double p)
+{
+    long pozycja = (long)std::ceil(p / 100.0 * czasy.size()) - 1;
+    if (pozycja < 0)
+    {
+        pozycja = 0;
+    }
+    return czasy[pozycja];
+}
+
+
+static void zmierz(const vector<KluczWsadu>& klucze, const UstawieniaAtaku& ustawienia, long rozgrzewka,
+                   long powtorzenia, vector<WynikPomiaru>& wyniki)
+{
+    std::map<long, vector<long> > grupy;
+    for (long i = 0; i < (long)klucze.size(); i++)
+    {
+        grupy[klucze[i].bin_size].push_back(i);
+    }
+
+    KontekstWsadu kontekst;
+    for (std::map<long, vector<long> >::const_iterator it = grupy.begin(); it != grupy.end(); ++it)
+    {
+        WynikPomiaru w = WynikPomiaru();
+        w.arytmetyka = ustawienia.arytmetyka;
+        w.silnik = ustawienia.rozwiniecie;
+        w.bin_size = it->first;
+        vector<long long> czasy;
+        for (long j = 0; j < (long)it->second.size(); j++)
+        {
+            const KluczWsadu& klucz = klucze[it->second[j]];
+            WynikKlucza wynik_klucza;
+            for (long r = 0; r < rozgrzewka; r++)
+            {
+                atakuj_klucz(klucz, ustawienia, wynik_klucza, kontekst);
+            }
+            for (long r = 0; r < powtorzenia; r++)
+            {
+                atakuj_klucz(klucz, ustawienia, wynik_klucza, kontekst);
+                czasy.push_back(wynik_klucza.czas_ns);
+                w.suma_ns += wynik_klucza.czas_ns;
+            }
+            w.klucze++;
+            // Wynik liczony tylko z pomiaru, nie z samej rozgrzewki
+            if (powtorzenia > 0)
+            {
+                w.znalezione += wynik_klucza.znaleziono;
+                w.bledne += wynik_klucza.znaleziono && !wynik_klucza.poprawny;
+            }
+        }
+        std::sort(czasy.begin(), czasy.end());
+        w.proby = czasy.size();
+        if (!czasy.empty())
+        {
+            w.min_ns = czasy[0];
+            w.mediana_ns = percentyl(czasy, 50);
+            w.p95_ns = percentyl(czasy, 95);
+            w.p99_ns = percentyl(czasy, 99);
+        }
+        wyniki.push_back(w);
+    }
+}
+
+
+static double klucze_na_sekunde(const WynikPomiaru& w)
+{
+    return w.suma_ns > 0 ? w.proby * 1e9 / w.suma_ns : 0.0;
+}
+
+
+static void wypisz_csv(std::ostream& wyjscie, const vector<WynikPomiaru>& wyniki)
+{
+    wyjscie << "backend,engine,bin_size,keys,samples,found,wrong,min_us,median_us,p95_us,p99_us,mean_us,keys_per_s" << std::endl;
+    for (long i = 0; i < (long)wyniki.size(); i++)
+    {
+        const WynikPomiaru& w = wyniki[i];
+        wyjscie << nazwa_arytmetyki(w.arytmetyka) << "," << nazwa_silnika(w.silnik) << "," << w.bin_size
+                << "," << w.klucze << "," << w.proby << "," << w.znalezione << "," << w.bledne
+                << "," << w.min_ns / 1000.0 << "," << w.mediana_ns / 1000.0
+                << "," << w.p95_ns / 1000.0 << "," << w.p99_ns / 1000.0
+                << "," << (w.proby > 0 ? w.suma_ns / 1000.0 / w.proby : 0.0)
+                << "," << klucze_na_sekunde(w) << std::endl;
+    }
+}
+
+
+// Tekst jako napis JSON: cudzyslow, ukosnik wsteczny i znaki sterujace
+// zamieniane na sekwencje ucieczki
+static std::string napis_json(const std::string& tekst)
+{
+    std::ostringstream wynik;
+    wynik << '"';
+    for (size_t i = 0; i < tekst.size(); i++)
+    {
+        unsigned char c = tekst[i];
+        if (c == '"' || c == '\\')
+        {
+            wynik << '\\' << c;
+        }
+        else if (c < 0x20)
+        {
+            static const char cyfry[] = "0123456789abcdef";
+            wynik << "\\u00" << cyfry[c >> 4] << cyfry[c & 15];
+        }
+        else
+        {
+            wynik << c;
+        }
+    }
+    wynik << '"';
+    return wynik.str();
+}
+
+
+static void wypisz_json(std::ostream& wyjscie, const vector<WynikPomiaru>& wyniki, const std::string& zrodlo,
+                        long rozgrzewka, long powtorzenia)
+{
+    wyjscie << "{\"source\": " << napis_json(zrodlo) << ", \"warmup\": " << rozgrzewka
+            << ", \"repeat\": " << powtorzenia << ", \"results\": [" << std::endl;
+    for (long i = 0; i < (long)wyniki.size(); i++)
+    {
+        const WynikPomiaru& w = wyniki[i];
+        wyjscie << "  {\"backend\": \"" << nazwa_arytmetyki(w.arytmetyka) << "\""
+                << ", \"engine\": \"" << nazwa_silnika(w.silnik) << "\""
+                << ", \"bin_size\": " << w.bin_size << ", \"keys\": " << w.klucze
+                << ", \"samples\": " << w.proby << ", \"found\": " << w.znalezione
+                << ", \"wrong\": " << w.bledne
+                << ", \"min_us\": " << w.min_ns / 1000.0 << ", \"median_us\": " << w.mediana_ns / 1000.0
+                << ", \"p95_us\": " << w.p95_ns / 1000.0 << ", \"p99_us\": " << w.p99_ns / 1000.0
+                << ", \"mean_us\": " << (w.proby > 0 ? w.suma_ns / 1000.0 / w.proby : 0.0)
+                << ", \"keys_per_s\": " << klucze_na_sekunde(w) << "}"
+                << (i + 1 < (long)wyniki.size() ? "," : "") << std::endl;
+    }
+    wyjscie << "]}" << std::endl;
+}
+
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Uzycie: bench <plik> | --generate <bin_size,...> [opcje]" << std::endl;
+        return 1;
+    }
+
+    UstawieniaWsadu ustawienia;
+    std::string zrodlo = argv[1];
+    std::string rozmiary, format = "csv", sciezka_wyjscia;
+    long rozgrzewka = 1, liczba_kluczy = 10, ziarno = 0;
+    std::vector<std::string> arytmetyki, silniki;
+    int pierwsza_opcja = 2;
+    if (zrodlo == "--generate" && argc >= 3)
+    {
+        rozmiary = argv[2];
+        pierwsza_opcja = 3;
+    }
+
+    for (int i = pierwsza_opcja; i < argc; i++)
+    {
+        std::string opcja = argv[i];
+        if (opcja == "--warmup" && i + 1 < argc)
+        {
+            rozgrzewka = atol(argv[++i]);
+        }
+        else if (opcja == "--keys" && i + 1 < argc)
+        {
+            liczba_kluczy = atol(argv[++i]);
+        }
+        else if (opcja == "--seed" && i + 1 < argc)
+        {
+            ziarno = atol(argv[++i]);
+        }
+        else if (opcja == "--format" && i + 1 < argc)
+        {
+            format = argv[++i];
+        }
+        else if (opcja == "--output" && i + 1 < argc)
+        {
+            sciezka_wyjscia = argv[++i];
+        }
+        else if (opcja == "--backends" && i + 1 < argc)
+        {
+            podziel(argv[++i], arytmetyki);
+        }
+        else if (opcja == "--engines" && i + 1 < argc)
+        {
+            podziel(argv[++i], silniki);
+        }
+        else if (!wczytaj_opcje_wsadu(argc, argv, i, ustawienia))
+        {
+            std::cerr << "Nieznana opcja lub wartosc " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    if (format != "csv" && format != "json")
+    {
+        std::cerr << "Nieznany format " << format << std::endl;
+        return 1;
+    }
+
+    vector<KluczWsadu> klucze;
+    if (!rozmiary.empty())
+    {
+        std::vector<std::string> lista;
+        podziel(rozmiary, lista);
+        SetSeed(conv<ZZ>(ziarno));
+        for (long i = 0; i < (long)lista.size(); i++)
+        {
+            generuj_klucze(atol(lista[i].c_str()), liczba_kluczy, klucze);
+        }
+        zrodlo = "generated:" + rozmiary;
+    }
+    else if (!wczytaj_wsad(zrodlo, klucze))
+    {
+        return 1;
+    }
+
+    // Bez --backends i --engines mierzone sa ustawienia z --backend i --cf
+    vector<Arytmetyka> lista_arytmetyk(1, ustawienia.atak.arytmetyka);
+    vector<SilnikRozwiniecia> lista_silnikow(1, ustawienia.atak.rozwiniecie);
+    if (!arytmetyki.empty())
+    {
+        lista_arytmetyk.resize(arytmetyki.size());
+    }
+    for (long i = 0; i < (long)arytmetyki.size(); i++)
+    {
+        if (!wczytaj_arytmetyke(arytmetyki[i], lista_arytmetyk[i]))
+        {
+            std::cerr << "Nieznana arytmetyka " << arytmetyki[i] << std::endl;
+            return 1;
+        }
+    }
+    if (!silniki.empty())
+    {
+        lista_silnikow.resize(silniki.size());
+    }
+    for (long i = 0; i < (long)silniki.size(); i++)
+    {
+        if (!wczytaj_silnik(silniki[i], lista_silnikow[i]))
+        {
+            std::cerr << "Nieznany silnik " << silniki[i] << std::endl;
+            return 1;
+        }
+    }
+
+    vector<WynikPomiaru> wyniki;
+    long bledne = 0;
+    for (long a = 0; a < (long)lista_arytmetyk.size(); a++)
+    {
+        for (long s = 0; s < (long)lista_silnikow.size(); s++)
+        {
+            UstawieniaAtaku atak = ustawienia.atak;
+            atak.arytmetyka = lista_arytmetyk[a];
+            atak.rozwiniecie = lista_silnikow[s];
+            zmierz(klucze, atak, rozgrzewka, ustawienia.powtorzenia, wyniki);
+        }
+    }
+    for (long i = 0; i < (long)wyniki.size(); i++)
+    {
+        bledne += wyniki[i].bledne;
+    }
+
+    std::ofstream plik;
+    if (!sciezka_wyjscia.empty())
+    {
+        plik.open(sciezka_wyjscia.c_str());
+        if (!plik)
+        {
+            std::cerr << "Nie mozna zapisac pliku " << sciezka_wyjscia << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& wyjscie = sciezka_wyjscia.empty() ? std::cout : plik;
+    if (format == "json")
+    {
+        wypisz_json(wyjscie, wyniki, zrodlo, rozgrzewka, ustawienia.powtorzenia);
+    }
+    else
+    {
+        wypisz_csv(wyjscie, wyniki);
+    }
+    return bledne == 0 ? 0 : 1;
+}
@@ -1,2 +1,12 @@
 #!/bin/bash
-g++ -g -O2 -std=c++11 -pthread -march=native wiener.cpp -o wiener -lntl -lgmp -lm
+g++ -g -O2 -std=c++11 -pthread -march=native wiener.cpp attack.cpp library.cpp batch.cpp batch_gcd.cpp corpus.cpp key_import.cpp service.cpp lanes.cpp cache.cpp checkpoint.cpp distributed.cpp generator.cpp shared_modulus.cpp -o wiener -lntl -lgmp -lm
+g++ -g -O2 -std=c++11 -pthread -march=native bench.cpp attack.cpp batch.cpp batch_gcd.cpp corpus.cpp key_import.cpp lanes.cpp cache.cpp checkpoint.cpp generator.cpp -o bench -lntl -lgmp -lm
+# libwiener: atak bez wejscia/wyjscia (library.h) do linkowania w innych programach
+g++ -g -O2 -std=c++11 -pthread -march=native -fPIC -c attack.cpp -o attack.o
+g++ -g -O2 -std=c++11 -pthread -march=native -fPIC -c library.cpp -o library.o
+ar rcs libwiener.a attack.o library.o
+g++ -shared -pthread attack.o library.o -o libwiener.so -lntl -lgmp -lm
+rm -f attack.o library.o
+# Z silnikiem GPU dla --gpu (gpu.cu, wymaga CUDA): zamiast pierwszej linii
+# nvcc -O2 -std=c++11 -c gpu.cu -o gpu.o
+# g++ -g -O2 -std=c++11 -pthread -march=native -DWIENER_CUDA wiener.cpp attack.cpp library.cpp batch.cpp batch_gcd.cpp corpus.cpp key_import.cpp service.cpp lanes.cpp cache.cpp checkpoint.cpp distributed.cpp generator.cpp shared_modulus.cpp gpu.o -o wiener -lntl -lgmp -lm -lcudart
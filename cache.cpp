@@ -0,0 +1,365 @@
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cache.h"
+
+
+static const char SYGNATURA[8] = { 'W', 'I', 'E', 'N', 'P', 'A', 'M', 'I' };
+static const size_t ROZMIAR_NAGLOWKA = 16;
+static const size_t ROZMIAR_WPISU = 64;    // wpis bez slow d
+
+
+Sha256::Sha256() : dlugosc(0), w_buforze(0)
+{
+    static const unsigned int poczatek[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                              0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+    memcpy(h, poczatek, sizeof(h));
+}
+
+
+void Sha256::dodaj(const unsigned char* dane, size_t n)
+{
+    dlugosc += n;
+    while (n > 0)
+    {
+        size_t ile = std::min(n, (size_t)64 - w_buforze);
+        memcpy(bufor + w_buforze, dane, ile);
+        w_buforze += ile;
+        dane += ile;
+        n -= ile;
+        if (w_buforze == 64)
+        {
+            blok(bufor);
+            w_buforze = 0;
+        }
+    }
+}
+
+
+void Sha256::koniec(unsigned char wynik[32])
+{
+    unsigned long long bity = dlugosc * 8;
+    unsigned char dopelnienie[72] = { 0x80 };
+    size_t ile = (w_buforze < 56 ? 56 : 120) - w_buforze;
+    for (int i = 0; i < 8; i++)
+    {
+        dopelnienie[ile + i] = (unsigned char)(bity >> (56 - 8 * i));
+    }
+    dodaj(dopelnienie, ile + 8);
+    for (int i = 0; i < 32; i++)
+    {
+        wynik[i] = (unsigned char)(h[i / 4] >> (24 - 8 * (i % 4)));
+    }
+}
+
+
+static unsigned int obrot(unsigned int x, int n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+
+void Sha256::blok(const unsigned char* p)
+{
+    static const unsigned int K[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+        0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+        0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+        0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+        0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+        0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+    unsigned int w[64];
+    for (int i = 0; i < 16; i++)
+    {
+        w[i] = (unsigned int)p[4 * i] << 24 | (unsigned int)p[4 * i + 1] << 16
+               | (unsigned int)p[4 * i + 2] << 8 | p[4 * i + 3];
+    }
+    for (int i = 16; i < 64; i++)
+    {
+        unsigned int s0 = obrot(w[i - 15], 7) ^ obrot(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        unsigned int s1 = obrot(w[i - 2], 17) ^ obrot(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    unsigned int a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++)
+    {
+        unsigned int t1 = k + (obrot(e, 6) ^ obrot(e, 11) ^ obrot(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+        unsigned int t2 = (obrot(a, 2) ^ obrot(a, 13) ^ obrot(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        k = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += k;
+}
+
+
+static unsigned long long czytaj(const unsigned char* p, int bajty)
+{
+    unsigned long long x = 0;
+    for (int i = bajty - 1; i >= 0; i--)
+    {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+
+static void dopisz(std::vector<unsigned char>& bufor, unsigned long long x, int bajty)
+{
+    for (int i = 0; i < bajty; i++)
+    {
+        bufor.push_back((unsigned char)(x >> (8 * i)));
+    }
+}
+
+
+// Dlugosc w bajtach i bajty od najmlodszego, jak w BytesFromZZ
+static void dodaj_liczbe(Sha256& sha, const ZZ& x)
+{
+    long bajty = NumBytes(x);
+    std::vector<unsigned char> bufor;
+    dopisz(bufor, bajty, 8);
+    bufor.resize(8 + bajty);
+    BytesFromZZ(bufor.data() + 8, x, bajty);
+    sha.dodaj(bufor.data(), bufor.size());
+}
+
+
+OdciskKlucza odcisk_klucza(const ZZ& e, const ZZ& N)
+{
+    Sha256 sha;
+    dodaj_liczbe(sha, e);
+    dodaj_liczbe(sha, N);
+    unsigned char wynik[32];
+    sha.koniec(wynik);
+    return OdciskKlucza((const char*)wynik, sizeof(wynik));
+}
+
+
+// Flagi i pola granicy szukania z ustawien, tak jak zapisywane we wpisie
+static unsigned int flagi_granicy(const UstawieniaAtaku& ustawienia)
+{
+    unsigned int flagi = 0;
+    if (ustawienia.granica.wiener)
+    {
+        flagi |= PAMIEC_GRANICA_WIENERA;
+    }
+    if (ustawienia.rozszerzenie.bity > 0 && ustawienia.rozszerzenie.metoda == ROZSZERZENIE_DUJELLA)
+    {
+        flagi |= PAMIEC_DUJELLA;
+    }
+    return flagi;
+}
+
+
+static long bity_rozszerzenia(const UstawieniaAtaku& ustawienia)
+{
+    return ustawienia.rozszerzenie.bity > 0 ? ustawienia.rozszerzenie.bity : 0;
+}
+
+
+PamiecWynikow::PamiecWynikow() : dane(0), rozmiar(0), zapisane(0), liczba_trafien(0)
+{
+}
+
+
+PamiecWynikow::~PamiecWynikow()
+{
+    if (dane)
+    {
+        munmap((void*)dane, rozmiar);
+    }
+}
+
+
+bool PamiecWynikow::otworz(const std::string& sciezka_pliku)
+{
+    sciezka = sciezka_pliku;
+    int plik = open(sciezka.c_str(), O_RDWR | O_CREAT, 0644);
+    struct stat opis;
+    if (plik < 0 || fstat(plik, &opis) != 0)
+    {
+        std::cerr << "Nie mozna otworzyc pamieci wynikow " << sciezka << std::endl;
+        if (plik >= 0)
+        {
+            close(plik);
+        }
+        return false;
+    }
+    size_t rozmiar_pliku = opis.st_size;
+    if (rozmiar_pliku == 0)
+    {
+        // Nowy plik: sam naglowek
+        std::vector<unsigned char> naglowek(SYGNATURA, SYGNATURA + sizeof(SYGNATURA));
+        dopisz(naglowek, WERSJA_PAMIECI, 4);
+        dopisz(naglowek, 0, 4);
+        bool zapisany = write(plik, naglowek.data(), naglowek.size()) == (ssize_t)naglowek.size();
+        close(plik);
+        if (!zapisany)
+        {
+            std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+        }
+        return zapisany;
+    }
+    void* odwzorowanie = mmap(0, rozmiar_pliku, PROT_READ, MAP_SHARED, plik, 0);
+    close(plik);
+    if (odwzorowanie == MAP_FAILED)
+    {
+        std::cerr << "Nie mozna odwzorowac pliku " << sciezka << std::endl;
+        return false;
+    }
+    dane = (const unsigned char*)odwzorowanie;
+    rozmiar = rozmiar_pliku;
+    if (rozmiar < ROZMIAR_NAGLOWKA || memcmp(dane, SYGNATURA, sizeof(SYGNATURA)) != 0
+        || czytaj(dane + 8, 4) != WERSJA_PAMIECI)
+    {
+        std::cerr << "Uszkodzona pamiec wynikow " << sciezka << std::endl;
+        return false;
+    }
+
+    // Uciety ostatni wpis (przerwany zapis) jest pomijany i obcinany z pliku,
+    // zeby kolejne wpisy dopisywane byly od granicy wpisu
+    size_t pozycja = ROZMIAR_NAGLOWKA;
+    while (rozmiar - pozycja >= ROZMIAR_WPISU)
+    {
+        const unsigned char* p = dane + pozycja;
+        unsigned long long slowa_d = czytaj(p + 56, 4);
+        if (slowa_d > (rozmiar - pozycja - ROZMIAR_WPISU) / 8)
+        {
+            break;
+        }
+        pozycja += ROZMIAR_WPISU + 8 * slowa_d;
+        OdciskKlucza odcisk((const char*)p, 32);
+        std::unordered_map<OdciskKlucza, Wpis>::iterator it = wpisy.find(odcisk);
+        if (it == wpisy.end() || !(czytaj(rekord(it->second) + 36, 4) & PAMIEC_ZNALEZIONO))
+        {
+            Wpis wpis = { p, -1 };
+            wpisy[odcisk] = wpis;
+        }
+    }
+    if (pozycja < rozmiar && truncate(sciezka.c_str(), pozycja) != 0)
+    {
+        std::cerr << "Nie mozna obciac pliku " << sciezka << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+const unsigned char* PamiecWynikow::rekord(const Wpis& wpis) const
+{
+    return wpis.nowy >= 0 ? nowe[wpis.nowy].data() : wpis.rekord;
+}
+
+
+bool PamiecWynikow::znajdz(const ZZ& e, const ZZ& N, const UstawieniaAtaku& ustawienia, bool& znaleziono, ZZ& d)
+{
+    OdciskKlucza odcisk = odcisk_klucza(e, N);
+    std::lock_guard<std::mutex> blokada_pamieci(blokada);
+    std::unordered_map<OdciskKlucza, Wpis>::const_iterator it = wpisy.find(odcisk);
+    if (it == wpisy.end())
+    {
+        return false;
+    }
+    const unsigned char* p = rekord(it->second);
+    unsigned int flagi = (unsigned int)czytaj(p + 36, 4);
+    znaleziono = (flagi & PAMIEC_ZNALEZIONO) != 0;
+    if (znaleziono)
+    {
+        ZZFromBytes(d, p + ROZMIAR_WPISU, 8 * czytaj(p + 56, 4));
+    }
+    else if (czytaj(p + 32, 4) != WERSJA_SILNIKA || (flagi & ~PAMIEC_ZNALEZIONO) != flagi_granicy(ustawienia)
+             || (long)czytaj(p + 40, 8) != ustawienia.granica.max_indeks
+             || (long)czytaj(p + 48, 4) != ustawienia.granica.max_bity_d
+             || (long)czytaj(p + 52, 4) != bity_rozszerzenia(ustawienia))
+    {
+        return false;
+    }
+    liczba_trafien++;
+    return true;
+}
+
+
+void PamiecWynikow::dodaj(const ZZ& e, const ZZ& N, const UstawieniaAtaku& ustawienia, bool znaleziono, const ZZ& d)
+{
+    OdciskKlucza odcisk = odcisk_klucza(e, N);
+    size_t slowa_d = znaleziono ? (NumBytes(d) + 7) / 8 : 0;
+    std::vector<unsigned char> bufor(odcisk.begin(), odcisk.end());
+    dopisz(bufor, WERSJA_SILNIKA, 4);
+    dopisz(bufor, flagi_granicy(ustawienia) | (znaleziono ? PAMIEC_ZNALEZIONO : 0), 4);
+    dopisz(bufor, ustawienia.granica.max_indeks, 8);
+    dopisz(bufor, ustawienia.granica.max_bity_d, 4);
+    dopisz(bufor, bity_rozszerzenia(ustawienia), 4);
+    dopisz(bufor, slowa_d, 4);
+    dopisz(bufor, 0, 4);
+    bufor.resize(ROZMIAR_WPISU + 8 * slowa_d);
+    if (znaleziono)
+    {
+        BytesFromZZ(bufor.data() + ROZMIAR_WPISU, d, 8 * slowa_d);
+    }
+
+    std::lock_guard<std::mutex> blokada_pamieci(blokada);
+    std::unordered_map<OdciskKlucza, Wpis>::iterator it = wpisy.find(odcisk);
+    if (it != wpisy.end() && (czytaj(rekord(it->second) + 36, 4) & PAMIEC_ZNALEZIONO))
+    {
+        return;
+    }
+    nowe.push_back(bufor);
+    Wpis wpis = { 0, (long)nowe.size() - 1 };
+    wpisy[odcisk] = wpis;
+}
+
+
+bool PamiecWynikow::zapisz()
+{
+    std::lock_guard<std::mutex> blokada_pamieci(blokada);
+    if (zapisane == nowe.size())
+    {
+        return true;
+    }
+    int plik = open(sciezka.c_str(), O_WRONLY | O_APPEND);
+    bool poprawny = plik >= 0;
+    while (poprawny && zapisane < nowe.size())
+    {
+        // Nieudany lub czesciowy zapis jest obcinany do granicy wpisu, a wpis
+        // zostaje w kolejce do ponowienia przy nastepnym zapisie
+        const std::vector<unsigned char>& wpis = nowe[zapisane];
+        off_t pozycja = lseek(plik, 0, SEEK_END);
+        poprawny = pozycja >= 0 && write(plik, wpis.data(), wpis.size()) == (ssize_t)wpis.size();
+        if (poprawny)
+        {
+            zapisane++;
+        }
+        else if (pozycja >= 0 && ftruncate(plik, pozycja) != 0)
+        {
+            std::cerr << "Nie mozna obciac pliku " << sciezka << std::endl;
+        }
+    }
+    if (plik >= 0)
+    {
+        close(plik);
+    }
+    if (!poprawny)
+    {
+        std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+    }
+    return poprawny;
+}
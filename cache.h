@@ -0,0 +1,111 @@
+#ifndef WIENER_CACHE_H
+#define WIENER_CACHE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include "attack.h"
+
+// Trwala pamiec wynikow ataku dla powtarzanych skanow. Kluczem jest odcisk
+// SHA-256 pary (e, N), wartoscia werdykt, odzyskane d, wersja silnika
+// i granica szukania. Plik jest dziennikiem wpisow dopisywanych na koncu;
+// otworz() odwzorowuje go w pamiec (mmap) i buduje tablice mieszajaca
+// odcisk -> wpis, wiec d wczytywane jest z odwzorowania dopiero przy trafieniu.
+// Wszystkie pola sa little-endian:
+//
+//   naglowek (16 bajtow)
+//     char[8]  "WIENPAMI"
+//     uint32   wersja pliku (WERSJA_PAMIECI)
+//     uint32   zarezerwowane (0)
+//   wpisy, kazdy od granicy 8 bajtow
+//     uint8[32] odcisk SHA-256
+//     uint32   wersja silnika (WERSJA_SILNIKA)
+//     uint32   flagi (PAMIEC_ZNALEZIONO, PAMIEC_GRANICA_WIENERA, PAMIEC_DUJELLA)
+//     int64    max_indeks
+//     uint32   max_bity_d
+//     uint32   bity rozszerzenia
+//     uint32   slowa d, uint32 0
+//     slowa d (uint64, od najmlodszego)
+//
+// Znalezione d jest poprawne niezaleznie od granicy, wiec takie wpisy
+// trafiaja zawsze. Wpis "nie znaleziono" trafia tylko przy tej samej wersji
+// silnika i granicy szukania (granica, max_bity_d, max_indeks, etap
+// rozszerzony); filtry, arytmetyka, silnik rozwiniecia i obciecie nie
+// zmieniaja wyniku. Nowszy wpis klucza zastepuje starszy "nie znaleziono".
+
+const unsigned int WERSJA_PAMIECI = 1;
+// Zwiekszana, gdy zmiana ataku moze zmienic werdykt dla tej samej granicy
+const unsigned int WERSJA_SILNIKA = 2;
+
+const unsigned int PAMIEC_ZNALEZIONO = 1;
+const unsigned int PAMIEC_GRANICA_WIENERA = 2;
+const unsigned int PAMIEC_DUJELLA = 4;
+
+// SHA-256 (FIPS 180-4)
+class Sha256
+{
+public:
+    Sha256();
+    void dodaj(const unsigned char* dane, size_t n);
+    void koniec(unsigned char wynik[32]);
+
+private:
+    unsigned int h[8];
+    unsigned char bufor[64];
+    unsigned long long dlugosc;
+    size_t w_buforze;
+
+    void blok(const unsigned char* p);
+};
+
+// Odcisk SHA-256 pary (e, N)
+typedef std::string OdciskKlucza;
+OdciskKlucza odcisk_klucza(const ZZ& e, const ZZ& N);
+
+// Wszystkie metody mozna wolac z wielu watkow naraz
+class PamiecWynikow
+{
+public:
+    PamiecWynikow();
+    ~PamiecWynikow();
+
+    // Otwiera plik pamieci, tworzy go, gdy nie istnieje
+    bool otworz(const std::string& sciezka);
+
+    // Szuka wyniku klucza dla ustawien; przy trafieniu ustawia znaleziono i d
+    bool znajdz(const ZZ& e, const ZZ& N, const UstawieniaAtaku& ustawienia, bool& znaleziono, ZZ& d);
+
+    // Zapamietuje wynik ataku (d tylko dla znaleziono); do pliku trafia po zapisz()
+    void dodaj(const ZZ& e, const ZZ& N, const UstawieniaAtaku& ustawienia, bool znaleziono, const ZZ& d);
+
+    // Dopisuje do pliku wpisy dodane od ostatniego zapisu
+    bool zapisz();
+
+    long trafienia() const { return liczba_trafien; }
+
+private:
+    // Wpis z pliku wskazuje rekord w odwzorowaniu, nowy - pozycje w nowe
+    struct Wpis
+    {
+        const unsigned char* rekord;
+        long nowy;
+    };
+
+    const unsigned char* rekord(const Wpis& wpis) const;
+
+    std::string sciezka;
+    const unsigned char* dane;
+    size_t rozmiar;
+    std::unordered_map<OdciskKlucza, Wpis> wpisy;
+    std::vector<std::vector<unsigned char> > nowe;  // zakodowane wpisy do dopisania
+    size_t zapisane;                                // ile z nowe jest juz w pliku
+    std::atomic<long> liczba_trafien;
+    std::mutex blokada;
+
+    PamiecWynikow(const PamiecWynikow&);
+    PamiecWynikow& operator=(const PamiecWynikow&);
+};
+
+#endif
@@ -0,0 +1,304 @@
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include "checkpoint.h"
+#include "cache.h"
+
+
+static const char SYGNATURA[8] = { 'W', 'I', 'E', 'N', 'P', 'U', 'N', 'K' };
+static const size_t ROZMIAR_NAGLOWKA = 56;
+static const size_t ROZMIAR_WYNIKU = 16 + 16 + LICZNIKI_WYNIKU * 8;   // wpis PUNKT_WYNIK bez slow d
+static const size_t ROZMIAR_POSTEPU = 16 + 8;
+
+
+static unsigned long long czytaj(const unsigned char* p, int bajty)
+{
+    unsigned long long x = 0;
+    for (int i = bajty - 1; i >= 0; i--)
+    {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+
+static void dopisz(std::vector<unsigned char>& bufor, unsigned long long x, int bajty)
+{
+    for (int i = 0; i < bajty; i++)
+    {
+        bufor.push_back((unsigned char)(x >> (8 * i)));
+    }
+}
+
+
+// Odcisk kluczy i ustawien, ktore zmieniaja wynik ataku
+static std::string odcisk_wsadu(const vector<KluczWsadu>& klucze, const UstawieniaAtaku& ustawienia)
+{
+    Sha256 sha;
+    std::vector<unsigned char> bufor;
+    dopisz(bufor, klucze.size(), 8);
+    dopisz(bufor, ustawienia.granica.wiener, 8);
+    dopisz(bufor, ustawienia.granica.max_bity_d, 8);
+    dopisz(bufor, ustawienia.granica.max_indeks, 8);
+    dopisz(bufor, ustawienia.rozszerzenie.bity > 0 ? ustawienia.rozszerzenie.bity : 0, 8);
+    dopisz(bufor, ustawienia.rozszerzenie.metoda, 8);
+    // Numer zadania Dujelli zalezy od porcji, a ta od limitu pamieci
+    dopisz(bufor, ustawienia.rozszerzenie.metoda == ROZSZERZENIE_DUJELLA ? ustawienia.rozszerzenie.pamiec : 0, 8);
+    sha.dodaj(bufor.data(), bufor.size());
+    for (size_t i = 0; i < klucze.size(); i++)
+    {
+        OdciskKlucza odcisk = odcisk_klucza(klucze[i].e, klucze[i].N);
+        sha.dodaj((const unsigned char*)odcisk.data(), odcisk.size());
+    }
+    unsigned char wynik[32];
+    sha.koniec(wynik);
+    return std::string((const char*)wynik, sizeof(wynik));
+}
+
+
+PunktyKontrolne::PunktyKontrolne(const vector<KluczWsadu>& klucze, vector<WynikKlucza>& wyniki, long watki)
+    : klucze(klucze), wyniki(wyniki), wczytane(klucze.size(), 0), stany(watki), zapis_poprawny(true),
+      koniec(false)
+{
+}
+
+
+PunktyKontrolne::~PunktyKontrolne()
+{
+    if (pisarz.joinable())
+    {
+        zatrzymaj(false);
+    }
+}
+
+
+bool PunktyKontrolne::otworz(const std::string& sciezka_pliku, const UstawieniaAtaku& ustawienia, long& wznowione)
+{
+    sciezka = sciezka_pliku;
+    wznowione = 0;
+    std::string odcisk = odcisk_wsadu(klucze, ustawienia);
+
+    std::vector<unsigned char> dane;
+    std::ifstream plik(sciezka.c_str(), std::ios::binary);
+    if (plik)
+    {
+        dane.assign(std::istreambuf_iterator<char>(plik), std::istreambuf_iterator<char>());
+    }
+    if (dane.empty())
+    {
+        // Nowy punkt kontrolny: sam naglowek
+        std::vector<unsigned char> naglowek(SYGNATURA, SYGNATURA + sizeof(SYGNATURA));
+        dopisz(naglowek, WERSJA_PUNKTU, 4);
+        dopisz(naglowek, 0, 4);
+        dopisz(naglowek, klucze.size(), 8);
+        naglowek.insert(naglowek.end(), odcisk.begin(), odcisk.end());
+        std::ofstream nowy(sciezka.c_str(), std::ios::binary);
+        if (!nowy || !nowy.write((const char*)naglowek.data(), naglowek.size()))
+        {
+            std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+            return false;
+        }
+        return true;
+    }
+    size_t rozmiar = dane.size();
+    if (rozmiar < ROZMIAR_NAGLOWKA || memcmp(dane.data(), SYGNATURA, sizeof(SYGNATURA)) != 0
+        || czytaj(&dane[8], 4) != WERSJA_PUNKTU)
+    {
+        std::cerr << "Uszkodzony punkt kontrolny " << sciezka << std::endl;
+        return false;
+    }
+    if (czytaj(&dane[16], 8) != klucze.size() || memcmp(&dane[24], odcisk.data(), odcisk.size()) != 0)
+    {
+        std::cerr << "Punkt kontrolny " << sciezka << " dotyczy innych kluczy lub ustawien" << std::endl;
+        return false;
+    }
+
+    // Uciety ostatni wpis (przerwany zapis) jest pomijany i obcinany z pliku
+    size_t pozycja = ROZMIAR_NAGLOWKA;
+    while (rozmiar - pozycja >= 16)
+    {
+        const unsigned char* p = &dane[pozycja];
+        unsigned long long rodzaj = czytaj(p, 4);
+        unsigned long long slowa_d = czytaj(p + 4, 4);
+        unsigned long long klucz = czytaj(p + 8, 8);
+        if (klucz >= klucze.size() || (rodzaj != PUNKT_WYNIK && rodzaj != PUNKT_POSTEP))
+        {
+            std::cerr << "Uszkodzony punkt kontrolny " << sciezka << std::endl;
+            return false;
+        }
+        size_t dlugosc = rodzaj == PUNKT_WYNIK ? ROZMIAR_WYNIKU : ROZMIAR_POSTEPU;
+        if (rozmiar - pozycja < dlugosc || slowa_d > (rozmiar - pozycja - dlugosc) / 8)
+        {
+            break;
+        }
+        pozycja += dlugosc + 8 * slowa_d;
+        if (rodzaj == PUNKT_POSTEP)
+        {
+            poczatki[klucz] = (long)czytaj(p + 16, 8);
+            continue;
+        }
+        WynikKlucza& wynik = wyniki[klucz];
+        if (wynik.wspolny_czynnik)
+        {
+            continue;
+        }
+        unsigned long long flagi = czytaj(p + 16, 4);
+        wynik.znaleziono = (flagi & 1) != 0;
+        wynik.poprawny = (flagi & 2) != 0;
+        wynik.czas_ns = (long long)czytaj(p + 24, 8);
+        wynik.statystyki = StatystykiAtaku();
+        long* pola[LICZNIKI_WYNIKU];
+        liczniki_wyniku(wynik.statystyki, pola);
+        for (long j = 0; j < LICZNIKI_WYNIKU; j++)
+        {
+            *pola[j] = (long)czytaj(p + 32 + 8 * j, 8);
+        }
+        ZZFromBytes(wynik.d, p + ROZMIAR_WYNIKU, 8 * slowa_d);
+        wznowione += !wczytane[klucz];
+        wczytane[klucz] = 1;
+    }
+    if (pozycja < rozmiar && truncate(sciezka.c_str(), pozycja) != 0)
+    {
+        std::cerr << "Nie mozna obciac pliku " << sciezka << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+void PunktyKontrolne::rozpocznij(long nr_watku, long i, UstawieniaAtaku& ustawienia)
+{
+    StanWatku& stan = stany[nr_watku];
+    std::lock_guard<std::mutex> blokada_stanu(stan.blokada);
+    std::map<long, long>::const_iterator it = poczatki.find(i);
+    stan.klucz = i;
+    stan.postep.poczatek = it != poczatki.end() ? it->second : 0;
+    stan.postep.wykonane.store(stan.postep.poczatek);
+    ustawienia.rozszerzenie.postep = &stan.postep;
+}
+
+
+void PunktyKontrolne::zakoncz(long nr_watku, long i)
+{
+    {
+        StanWatku& stan = stany[nr_watku];
+        std::lock_guard<std::mutex> blokada_stanu(stan.blokada);
+        stan.klucz = -1;
+    }
+    // Klucz przerwany po wyczerpaniu budzetu nie jest ukonczony; wznowienie
+    // atakuje go ponownie od ostatniego zapisanego postepu
+    if (przekroczony_budzet(wyniki[i]))
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> blokada_gotowych(blokada);
+    gotowe.push_back(i);
+}
+
+
+bool PunktyKontrolne::zapisz()
+{
+    std::lock_guard<std::mutex> blokada_zapisu(blokada);
+    std::vector<unsigned char> bufor;
+    for (size_t j = 0; j < gotowe.size(); j++)
+    {
+        long i = gotowe[j];
+        WynikKlucza& wynik = wyniki[i];
+        size_t slowa_d = wynik.znaleziono ? (NumBytes(wynik.d) + 7) / 8 : 0;
+        dopisz(bufor, PUNKT_WYNIK, 4);
+        dopisz(bufor, slowa_d, 4);
+        dopisz(bufor, i, 8);
+        dopisz(bufor, (wynik.znaleziono ? 1 : 0) | (wynik.poprawny ? 2 : 0), 4);
+        dopisz(bufor, 0, 4);
+        dopisz(bufor, wynik.czas_ns, 8);
+        long* pola[LICZNIKI_WYNIKU];
+        liczniki_wyniku(wynik.statystyki, pola);
+        for (long k = 0; k < LICZNIKI_WYNIKU; k++)
+        {
+            dopisz(bufor, *pola[k], 8);
+        }
+        size_t pozycja = bufor.size();
+        bufor.resize(pozycja + 8 * slowa_d);
+        if (slowa_d > 0)
+        {
+            BytesFromZZ(&bufor[pozycja], wynik.d, 8 * slowa_d);
+        }
+    }
+    gotowe.clear();
+    for (size_t t = 0; t < stany.size(); t++)
+    {
+        StanWatku& stan = stany[t];
+        std::lock_guard<std::mutex> blokada_stanu(stan.blokada);
+        long wykonane = stan.postep.wykonane.load();
+        if (stan.klucz >= 0 && wykonane > stan.postep.poczatek)
+        {
+            dopisz(bufor, PUNKT_POSTEP, 4);
+            dopisz(bufor, 0, 4);
+            dopisz(bufor, stan.klucz, 8);
+            dopisz(bufor, wykonane, 8);
+        }
+    }
+    if (bufor.empty())
+    {
+        return true;
+    }
+
+    // Jeden write na zapis: przerwany zapis zostawia najwyzej uciety ostatni wpis
+    int plik = open(sciezka.c_str(), O_WRONLY | O_APPEND);
+    bool poprawny = plik >= 0 && write(plik, bufor.data(), bufor.size()) == (ssize_t)bufor.size();
+    if (plik >= 0)
+    {
+        poprawny = close(plik) == 0 && poprawny;
+    }
+    if (!poprawny)
+    {
+        std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+        zapis_poprawny = false;
+    }
+    return poprawny;
+}
+
+
+void PunktyKontrolne::pisz(long interwal)
+{
+    std::unique_lock<std::mutex> blokada_budzika(blokada_watku);
+    while (!koniec)
+    {
+        budzik.wait_for(blokada_budzika, std::chrono::seconds(interwal));
+        if (!koniec)
+        {
+            blokada_budzika.unlock();
+            zapisz();
+            blokada_budzika.lock();
+        }
+    }
+}
+
+
+void PunktyKontrolne::uruchom(long interwal)
+{
+    pisarz = std::thread(&PunktyKontrolne::pisz, this, interwal > 0 ? interwal : 1);
+}
+
+
+bool PunktyKontrolne::zatrzymaj(bool usun)
+{
+    {
+        std::lock_guard<std::mutex> blokada_budzika(blokada_watku);
+        koniec = true;
+    }
+    budzik.notify_all();
+    if (pisarz.joinable())
+    {
+        pisarz.join();
+    }
+    if (usun && zapis_poprawny)
+    {
+        return remove(sciezka.c_str()) == 0;
+    }
+    return zapisz() && zapis_poprawny;
+}
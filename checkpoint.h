@@ -0,0 +1,102 @@
+#ifndef WIENER_CHECKPOINT_H
+#define WIENER_CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include "batch.h"
+
+// Punkty kontrolne przebiegu wsadowego. Plik jest dziennikiem dopisywanym co
+// interwal sekund: wyniki kluczy ukonczonych od poprzedniego zapisu i postep
+// etapu rozszerzonego kluczy w toku (PostepRozszerzenia), wiec koszt zapisu
+// nie zalezy od liczby kluczy juz zapisanych. Wznowiony przebieg przyjmuje
+// zapisane wyniki bez ataku, a etap rozszerzony klucza w toku zaczyna od
+// ostatniego zapisanego postepu. Wszystkie pola sa little-endian:
+//
+//   naglowek (56 bajtow)
+//     char[8]  "WIENPUNK"
+//     uint32   wersja (WERSJA_PUNKTU)
+//     uint32   zarezerwowane (0)
+//     uint64   liczba kluczy
+//     uint8[32] odcisk SHA-256 kluczy i granicy szukania
+//   wpisy, kazdy od granicy 8 bajtow
+//     uint32   rodzaj (PUNKT_WYNIK, PUNKT_POSTEP), uint32 slowa d
+//     uint64   numer klucza
+//     PUNKT_WYNIK:  uint32 flagi (znaleziono, poprawny), uint32 0,
+//                   int64 czas_ns, int64[16] liczniki StatystykiAtaku
+//                   i PomiaryAtaku (bez czasow faz), slowa d
+//     PUNKT_POSTEP: int64 wykonane zadania etapu rozszerzonego
+//
+// Odcisk obejmuje granice szukania i etap rozszerzony (z limitem pamieci
+// Dujelli, od ktorego zalezy numeracja zadan), wiec punkt kontrolny innego
+// pliku lub innych ustawien jest odrzucany, a nie wznawiany. Wynik klucza
+// przerwanego po wyczerpaniu budzetu nie jest zapisywany, wiec wznowiony
+// przebieg (np. z wiekszym budzetem) atakuje taki klucz ponownie.
+
+const unsigned int WERSJA_PUNKTU = 2;
+const unsigned int PUNKT_WYNIK = 1;
+const unsigned int PUNKT_POSTEP = 2;
+
+class PunktyKontrolne
+{
+public:
+    PunktyKontrolne(const vector<KluczWsadu>& klucze, vector<WynikKlucza>& wyniki, long watki);
+    ~PunktyKontrolne();
+
+    // Otwiera plik; gdy zawiera punkt kontrolny tych samych kluczy
+    // i ustawien, wczytuje wyniki ukonczonych kluczy i postep etapu rozszerzonego
+    bool otworz(const std::string& sciezka, const UstawieniaAtaku& ustawienia, long& wznowione);
+
+    // Czy wynik klucza wczytano z punktu kontrolnego
+    bool ukonczony(long i) const { return wczytane[i]; }
+
+    // Klucz i zaczyna atak w watku nr_watku; ustawienia dostaja postep etapu rozszerzonego klucza
+    void rozpocznij(long nr_watku, long i, UstawieniaAtaku& ustawienia);
+
+    // Wynik klucza i jest gotowy
+    void zakoncz(long nr_watku, long i);
+
+    // Zapis co interwal sekund w osobnym watku
+    void uruchom(long interwal);
+
+    // Konczy zapisy; po ukonczeniu calego przebiegu plik jest usuwany
+    bool zatrzymaj(bool usun);
+
+private:
+    struct StanWatku
+    {
+        std::mutex blokada;
+        long klucz;                  // -1 = brak klucza w toku
+        PostepRozszerzenia postep;
+
+        StanWatku() : klucz(-1) {}
+    };
+
+    const vector<KluczWsadu>& klucze;
+    vector<WynikKlucza>& wyniki;
+    std::string sciezka;
+    vector<char> wczytane;
+    std::map<long, long> poczatki;   // klucz -> wykonane zadania etapu rozszerzonego
+    vector<StanWatku> stany;
+
+    std::mutex blokada;              // gotowe i zapis pliku
+    vector<long> gotowe;             // ukonczone od ostatniego zapisu
+    bool zapis_poprawny;
+
+    std::mutex blokada_watku;
+    std::condition_variable budzik;
+    bool koniec;
+    std::thread pisarz;
+
+    bool zapisz();
+    void pisz(long interwal);
+
+    PunktyKontrolne(const PunktyKontrolne&);
+    PunktyKontrolne& operator=(const PunktyKontrolne&);
+};
+
+#endif
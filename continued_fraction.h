@@ -0,0 +1,544 @@
+#ifndef WIENER_CONTINUED_FRACTION_H
+#define WIENER_CONTINUED_FRACTION_H
+
+#include <vector>
+#include <deque>
+#include <utility>
+
+// Silniki rozwiniecia ulamka lancuchowego licznik/mianownik. Kazdy silnik
+// zwraca kolejne wyrazy (ilorazy niepelne) przez nastepny(iloraz) i daje
+// dokladnie ten sam ciag co szkolny algorytm Euklidesa. ustaw(l, m) zaczyna
+// rozwiniecie nowej pary. Gdy koniec_partii(), para licznik(), mianownik() to
+// dwie kolejne reszty Euklidesa po ostatnim zwroconym wyrazie (w trakcie
+// partii silnik moze byc juz dalej). przygotuj(bity) rezerwuje pamiec na pary
+// do bity bitow, zeby silnik uzywany dla wielu kluczy nie alokowal jej ponownie.
+
+
+// Przesuniecie reszt po kroku Euklidesa: (u, v) = (v, r), r dowolne. W NTL
+// i GMP zamiana liczb jest zamiana wskaznikow; arytmetyki trzymajace slowa
+// w obiekcie (fixed_backend.h) maja wlasne przeciazenia obu krokow.
+template <class Liczba>
+inline void przesun_reszty(Liczba& u, Liczba& v, Liczba& r)
+{
+    swap(u, v);
+    swap(v, r);
+}
+
+// Krok rekurencji reduktow: (P, P_1) = (q P + P_1, P)
+template <class Liczba>
+inline void dolacz_wyraz(Liczba& P, Liczba& P_1, const Liczba& q)
+{
+    swap(P, P_1);
+    MulAddTo(P, q, P_1);
+}
+
+// Rozwiniecie szkolnym algorytmem Euklidesa: jedno dzielenie wielokrotnej
+// precyzji na kazdy wyraz
+template <class Liczba>
+class RozwiniecieEuklidesa
+{
+public:
+    RozwiniecieEuklidesa() {}
+
+    RozwiniecieEuklidesa(const Liczba& licznik, const Liczba& mianownik)
+        : u(licznik), v(mianownik) {}
+
+    void przygotuj(long bity)
+    {
+        zarezerwuj(u, bity);
+        zarezerwuj(v, bity);
+        zarezerwuj(reszta, bity);
+    }
+
+    void ustaw(const Liczba& licznik, const Liczba& mianownik)
+    {
+        u = licznik;
+        v = mianownik;
+    }
+
+    bool nastepny(Liczba& iloraz)
+    {
+        if (IsZero(v))
+        {
+            return false;
+        }
+        DivRem(iloraz, reszta, u, v);
+        przesun_reszty(u, v, reszta);
+        return true;
+    }
+
+    bool koniec_partii() const { return true; }
+    const Liczba& licznik() const { return u; }
+    const Liczba& mianownik() const { return v; }
+
+private:
+    Liczba u, v, reszta;
+};
+
+
+// Rozwiniecie Lehmera (Knuth, TAOCP 4.5.2, algorytm L). Kroki Euklidesa
+// wykonywane sa na 62 najstarszych bitach u i v z ilorazami w jednym slowie,
+// dopoki oba ograniczenia (u' + A)/(v' + C) i (u' + B)/(v' + D) daja ten sam
+// iloraz. Zebrana macierz [A B; C D] stosowana jest do pelnych u, v raz na
+// partie. Gdy partia nie daje zadnego wyrazu, wykonywany jest jeden krok
+// wielokrotnej precyzji.
+template <class Liczba>
+class RozwiniecieLehmera
+{
+public:
+    static const long BITY_CZOLOWE = 62;
+
+    RozwiniecieLehmera() : pozycja(0), liczba_ilorazow(0) {}
+
+    RozwiniecieLehmera(const Liczba& licznik, const Liczba& mianownik)
+        : u(licznik), v(mianownik), pozycja(0), liczba_ilorazow(0) {}
+
+    void przygotuj(long bity)
+    {
+        zarezerwuj(u, bity);
+        zarezerwuj(v, bity);
+        zarezerwuj(reszta, bity);
+        zarezerwuj(t, bity);
+        zarezerwuj(w, bity);
+    }
+
+    // Rozpoczyna rozwiniecie nowej pary
+    void ustaw(const Liczba& licznik, const Liczba& mianownik)
+    {
+        u = licznik;
+        v = mianownik;
+        pozycja = 0;
+        liczba_ilorazow = 0;
+    }
+
+    bool nastepny(Liczba& iloraz)
+    {
+        if (pozycja < liczba_ilorazow)
+        {
+            iloraz = (long)ilorazy[pozycja++];
+            return true;
+        }
+        if (IsZero(v))
+        {
+            return false;
+        }
+        pozycja = 0;
+        liczba_ilorazow = 0;
+        if (NumBits(u) <= BITY_CZOLOWE && NumBits(v) <= BITY_CZOLOWE)
+        {
+            euklides_na_slowach();
+        }
+        else if (!(u < v))
+        {
+            partia_lehmera();
+        }
+        if (liczba_ilorazow == 0)
+        {
+            DivRem(iloraz, reszta, u, v);
+            przesun_reszty(u, v, reszta);
+            return true;
+        }
+        iloraz = (long)ilorazy[pozycja++];
+        return true;
+    }
+
+    bool koniec_partii() const { return pozycja == liczba_ilorazow; }
+    const Liczba& licznik() const { return u; }
+    const Liczba& mianownik() const { return v; }
+
+private:
+    static const long MAKS_ILORAZOW = 2 * BITY_CZOLOWE;
+
+    Liczba u, v, reszta, t, w;
+    unsigned long ilorazy[MAKS_ILORAZOW];
+    long pozycja, liczba_ilorazow;
+
+    // u i v mieszcza sie w slowie: cale pozostale rozwiniecie na slowach
+    void euklides_na_slowach()
+    {
+        unsigned long a = (unsigned long)trunc_long(u, BITY_CZOLOWE);
+        unsigned long b = (unsigned long)trunc_long(v, BITY_CZOLOWE);
+        while (b != 0 && liczba_ilorazow < MAKS_ILORAZOW)
+        {
+            unsigned long q = a / b;
+            unsigned long r = a - q * b;
+            ilorazy[liczba_ilorazow++] = q;
+            a = b;
+            b = r;
+        }
+        u = (long)a;
+        v = (long)b;
+    }
+
+    void partia_lehmera()
+    {
+        long przesuniecie = NumBits(u) - BITY_CZOLOWE;
+        RightShift(t, u, przesuniecie);
+        long u_c = trunc_long(t, BITY_CZOLOWE);
+        RightShift(t, v, przesuniecie);
+        long v_c = trunc_long(t, BITY_CZOLOWE);
+        long A = 1, B = 0, C = 0, D = 1;
+
+        while (v_c + C != 0 && v_c + D != 0 && liczba_ilorazow < MAKS_ILORAZOW)
+        {
+            long q = (u_c + A) / (v_c + C);
+            if (q != (u_c + B) / (v_c + D))
+            {
+                break;
+            }
+            ilorazy[liczba_ilorazow++] = q;
+            long T = A - q * C;
+            A = C;
+            C = T;
+            T = B - q * D;
+            B = D;
+            D = T;
+            T = u_c - q * v_c;
+            u_c = v_c;
+            v_c = T;
+        }
+        if (B == 0)
+        {
+            // Zaden iloraz nie jest pewny, krok wielokrotnej precyzji
+            liczba_ilorazow = 0;
+            return;
+        }
+        // (u, v) = (A u + B v, C u + D v)
+        mul(t, u, A);
+        MulAddTo(t, v, B);
+        mul(w, u, C);
+        MulAddTo(w, v, D);
+        swap(u, t);
+        swap(v, w);
+    }
+};
+
+
+// Macierz [P1 P0; Q1 Q0] = E(q_1) E(q_2) ... E(q_j), E(q) = [q 1; 1 0].
+// Dla (a, b) i jej pierwszych j wyrazow (a; b) = M (r_j; r_{j+1}), gdzie r_i to
+// kolejne reszty algorytmu Euklidesa, a P1/Q1 to j-ty redukt a/b.
+template <class Liczba>
+struct MacierzRozwiniecia
+{
+    Liczba P1, P0, Q1, Q0;
+    long dlugosc;
+
+    void jednostkowa()
+    {
+        P1 = 1;
+        P0 = 0;
+        Q1 = 0;
+        Q0 = 1;
+        dlugosc = 0;
+    }
+
+    void zamien(MacierzRozwiniecia& inna)
+    {
+        swap(P1, inna.P1);
+        swap(P0, inna.P0);
+        swap(Q1, inna.Q1);
+        swap(Q0, inna.Q0);
+        std::swap(dlugosc, inna.dlugosc);
+    }
+
+    // M = M E(q)
+    void dolacz(const Liczba& q)
+    {
+        dolacz_wyraz(P1, P0, q);
+        dolacz_wyraz(Q1, Q0, q);
+        dlugosc++;
+    }
+
+    // M = M E(q)^-1, cofa ostatni wyraz q
+    void cofnij(const Liczba& q)
+    {
+        MulSubFrom(P1, q, P0);
+        swap(P1, P0);
+        MulSubFrom(Q1, q, Q0);
+        swap(Q1, Q0);
+        dlugosc--;
+    }
+};
+
+
+// Rozwiniecie metoda half-GCD (Schonhage; weryfikacja jak u Mollera). Wyrazy
+// wyznaczane sa rekurencyjnie na najstarszych bitach: aby zmniejszyc pare o
+// k bitow, wystarcza zredukowac jej 2k najstarszych bitow (rekurencyjnie, dwie
+// polowy po k/2), a otrzymana macierz zastosowac do pelnych liczb w czasie
+// mnozenia. Wyrazy wyliczone z obcietej pary sa sprawdzane na pelnej parze:
+// M^-1 (a; b) = (a'; b') musi spelniac a' > b' >= 0 (a dla b' = 0 ostatni
+// wyraz rozny od 1), inaczej ostatnie wyrazy sa cofane. Daje to ciag
+// identyczny ze szkolnym w czasie O(M(n) log n).
+//
+// Wyrazy zwracane sa partiami po zredukowaniu pary o polowe; gdy para spadnie
+// ponizej progu bitow, reszte rozwiniecia liczy silnik Lehmera.
+template <class Liczba>
+class RozwiniecieHGCD
+{
+public:
+    // Ponizej tylu bitow do zredukowania rekurencja przechodzi na silnik Lehmera
+    static const long BITY_BAZY = 1024;
+    // Rozmiar wyrazow macierzy skladanej z pojedynczych wyrazow w przypadku bazowym
+    static const long BITY_CZESCIOWEJ = 60;
+
+    RozwiniecieHGCD(const Liczba& licznik, const Liczba& mianownik, long prog_bitow)
+        : u(licznik), v(mianownik), prog(prog_bitow), liczba_ilorazow(0), pozycja(0), tryb_lehmera(false),
+          lehmer(licznik, mianownik), baza(licznik, mianownik) {}
+
+    RozwiniecieHGCD() : prog(0), liczba_ilorazow(0), pozycja(0), tryb_lehmera(false) {}
+
+    // Rezerwuje pamiec pary i silnikow Lehmera; liczby posrednie rekurencji
+    // zostaja w poziomach po pierwszym kluczu danej dlugosci
+    void przygotuj(long bity)
+    {
+        zarezerwuj(u, bity);
+        zarezerwuj(v, bity);
+        zarezerwuj(reszta, bity);
+        lehmer.przygotuj(bity);
+        baza.przygotuj(bity);
+    }
+
+    void ustaw(const Liczba& licznik, const Liczba& mianownik)
+    {
+        u = licznik;
+        v = mianownik;
+        liczba_ilorazow = 0;
+        pozycja = 0;
+        tryb_lehmera = false;
+    }
+
+    // Nowa para z nowym progiem przejscia na silnik Lehmera
+    void ustaw(const Liczba& licznik, const Liczba& mianownik, long prog_bitow)
+    {
+        prog = prog_bitow;
+        ustaw(licznik, mianownik);
+    }
+
+    bool nastepny(Liczba& iloraz)
+    {
+        if (tryb_lehmera)
+        {
+            return lehmer.nastepny(iloraz);
+        }
+        if (pozycja < liczba_ilorazow)
+        {
+            iloraz = ilorazy[pozycja++];
+            return true;
+        }
+        if (IsZero(v))
+        {
+            return false;
+        }
+        if (NumBits(u) < prog)
+        {
+            tryb_lehmera = true;
+            lehmer.ustaw(u, v);
+            return lehmer.nastepny(iloraz);
+        }
+        liczba_ilorazow = 0;
+        pozycja = 0;
+        if (!(u < v))
+        {
+            redukuj(u, v, NumBits(u) / 2, M, 0);
+        }
+        if (liczba_ilorazow == 0)
+        {
+            // Pierwszy wyraz e/N dla e < N lub para zbyt mala na redukcje
+            M.jednostkowa();
+            krok(u, v, M);
+        }
+        iloraz = ilorazy[pozycja++];
+        return true;
+    }
+
+    bool koniec_partii() const { return tryb_lehmera ? lehmer.koniec_partii() : pozycja == liczba_ilorazow; }
+    const Liczba& licznik() const { return tryb_lehmera ? lehmer.licznik() : u; }
+    const Liczba& mianownik() const { return tryb_lehmera ? lehmer.mianownik() : v; }
+
+private:
+    Liczba u, v, iloraz_kroku, reszta;
+    long prog;
+    // Bufor wyrazow biezacej partii; elementy sa ponownie uzywane miedzy
+    // partiami, zeby nie alokowac pamieci na kazdy wyraz
+    std::vector<Liczba> ilorazy;
+    long liczba_ilorazow, pozycja;
+    bool tryb_lehmera;
+    RozwiniecieLehmera<Liczba> lehmer, baza;
+    MacierzRozwiniecia<Liczba> M;
+
+    // Liczby robocze jednego poziomu rekurencji redukuj(); deque nie przenosi
+    // istniejacych poziomow przy dodawaniu nowych
+    struct PoziomRedukcji
+    {
+        Liczba A, B;
+        MacierzRozwiniecia<Liczba> M1, M2, czesciowa, iloczyn;
+    };
+    std::deque<PoziomRedukcji> poziomy;
+
+    PoziomRedukcji& poziom_redukcji(long glebokosc)
+    {
+        if ((long)poziomy.size() <= glebokosc)
+        {
+            poziomy.resize(glebokosc + 1);
+        }
+        return poziomy[glebokosc];
+    }
+
+    // Jeden krok szkolny: (a, b) = (b, a mod b)
+    void krok(Liczba& a, Liczba& b, MacierzRozwiniecia<Liczba>& macierz)
+    {
+        DivRem(iloraz_kroku, reszta, a, b);
+        przesun_reszty(a, b, reszta);
+        macierz.dolacz(iloraz_kroku);
+        dopisz(iloraz_kroku);
+    }
+
+    void dopisz(const Liczba& q)
+    {
+        if (liczba_ilorazow == (long)ilorazy.size())
+        {
+            ilorazy.push_back(q);
+        }
+        else
+        {
+            ilorazy[liczba_ilorazow] = q;
+        }
+        liczba_ilorazow++;
+    }
+
+    // C = A B
+    static void pomnoz(MacierzRozwiniecia<Liczba>& C, const MacierzRozwiniecia<Liczba>& A,
+                       const MacierzRozwiniecia<Liczba>& B)
+    {
+        mul(C.P1, A.P1, B.P1);
+        MulAddTo(C.P1, A.P0, B.Q1);
+        mul(C.P0, A.P1, B.P0);
+        MulAddTo(C.P0, A.P0, B.Q0);
+        mul(C.Q1, A.Q1, B.P1);
+        MulAddTo(C.Q1, A.Q0, B.Q1);
+        mul(C.Q0, A.Q1, B.P0);
+        MulAddTo(C.Q0, A.Q0, B.Q0);
+        C.dlugosc = A.dlugosc + B.dlugosc;
+    }
+
+    // (A; B) = M^-1 (a; b) = (-1)^j [Q0 -P0; -Q1 P1] (a; b)
+    static void odwroc(Liczba& A, Liczba& B, const Liczba& a, const Liczba& b,
+                       const MacierzRozwiniecia<Liczba>& macierz)
+    {
+        mul(A, macierz.Q0, a);
+        MulSubFrom(A, macierz.P0, b);
+        mul(B, macierz.P1, b);
+        MulSubFrom(B, macierz.Q1, a);
+        if (macierz.dlugosc % 2 == 1)
+        {
+            negate(A, A);
+            negate(B, B);
+        }
+    }
+
+    // Zmniejsza pare a > b >= 0 o okolo k bitow dokladnymi krokami Euklidesa:
+    // dopisuje wyrazy do bufora, zastepuje (a, b) kolejnymi resztami i ustawia
+    // M tak, by (a; b) na wejsciu = M (a; b) na wyjsciu
+    void redukuj(Liczba& a, Liczba& b, long k, MacierzRozwiniecia<Liczba>& macierz, long glebokosc)
+    {
+        macierz.jednostkowa();
+        long n = NumBits(a);
+        if (IsZero(b) || k <= 0 || NumBits(b) <= n - k)
+        {
+            return;
+        }
+        long przesuniecie = n - 2 * k;
+        if (przesuniecie > 0)
+        {
+            // Redukcja 2k najstarszych bitow i zastosowanie macierzy do pelnej pary
+            PoziomRedukcji& poziom = poziom_redukcji(glebokosc);
+            Liczba& A = poziom.A;
+            Liczba& B = poziom.B;
+            RightShift(A, a, przesuniecie);
+            RightShift(B, b, przesuniecie);
+            if (!(B < A))
+            {
+                krok(a, b, macierz);
+                return;
+            }
+            long poczatek = liczba_ilorazow;
+            redukuj(A, B, k, macierz, glebokosc + 1);
+
+            odwroc(A, B, a, b, macierz);
+            // Cofanie wyrazow, ktorych nie potwierdza pelna para; koncowe
+            // [.., q, 1] przy zerowej reszcie to niekanoniczna postac [.., q + 1]
+            while (sign(B) < 0 || !(B < A) || (IsZero(B) && NumBits(ilorazy[liczba_ilorazow - 1]) == 1))
+            {
+                const Liczba& q = ilorazy[liczba_ilorazow - 1];
+                swap(A, B);
+                MulAddTo(A, q, B);
+                macierz.cofnij(q);
+                liczba_ilorazow--;
+            }
+            // Kopia zamiast swap: bufory zostaja na swoich poziomach, wiec
+            // kolejne pary tej dlugosci nie powiekszaja ich ponownie
+            a = A;
+            b = B;
+            if (liczba_ilorazow == poczatek)
+            {
+                krok(a, b, macierz);
+            }
+            return;
+        }
+
+        // n <= 2k
+        if (k <= BITY_BAZY)
+        {
+            // Wyrazy silnikiem Lehmera, az mianownik reduktu osiagnie k bitow;
+            // wyrazy skladane sa najpierw w macierz o wyrazach jednoslowowych
+            baza.ustaw(a, b);
+            PoziomRedukcji& poziom = poziom_redukcji(glebokosc);
+            MacierzRozwiniecia<Liczba>& czesciowa = poziom.czesciowa;
+            MacierzRozwiniecia<Liczba>& iloczyn = poziom.iloczyn;
+            czesciowa.jednostkowa();
+            long bity = 0;
+            while (bity + NumBits(czesciowa.P1) < k && baza.nastepny(iloraz_kroku))
+            {
+                czesciowa.dolacz(iloraz_kroku);
+                dopisz(iloraz_kroku);
+                if (NumBits(czesciowa.P1) > BITY_CZESCIOWEJ)
+                {
+                    pomnoz(iloczyn, macierz, czesciowa);
+                    macierz.zamien(iloczyn);
+                    bity = NumBits(macierz.P1);
+                    czesciowa.jednostkowa();
+                }
+            }
+            pomnoz(iloczyn, macierz, czesciowa);
+            macierz.zamien(iloczyn);
+            odwroc(poziom.A, poziom.B, a, b, macierz);
+            a = poziom.A;
+            b = poziom.B;
+            return;
+        }
+
+        // Dwie redukcje o polowe
+        long cel = n - k;
+        PoziomRedukcji& poziom = poziom_redukcji(glebokosc);
+        MacierzRozwiniecia<Liczba>& M1 = poziom.M1;
+        MacierzRozwiniecia<Liczba>& M2 = poziom.M2;
+        redukuj(a, b, k / 2, M1, glebokosc + 1);
+        if (M1.dlugosc == 0)
+        {
+            // Duzy wyraz: pierwsza polowa nie zmniejszyla pary
+            krok(a, b, M1);
+        }
+        long pozostalo = NumBits(a) - cel;
+        if (pozostalo > 0 && !IsZero(b))
+        {
+            redukuj(a, b, pozostalo, M2, glebokosc + 1);
+            pomnoz(macierz, M1, M2);
+        }
+        else
+        {
+            macierz.zamien(M1);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,272 @@
+#include <fstream>
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "corpus.h"
+
+
+static const char SYGNATURA[8] = { 'W', 'I', 'E', 'N', 'K', 'O', 'R', 'P' };
+static const size_t ROZMIAR_NAGLOWKA = 48;
+
+
+static unsigned long long czytaj(const unsigned char* p, int bajty)
+{
+    unsigned long long x = 0;
+    for (int i = bajty - 1; i >= 0; i--)
+    {
+        x = (x << 8) | p[i];
+    }
+    return x;
+}
+
+
+static void dopisz(std::vector<unsigned char>& bufor, unsigned long long x, int bajty)
+{
+    for (int i = 0; i < bajty; i++)
+    {
+        bufor.push_back((unsigned char)(x >> (8 * i)));
+    }
+}
+
+
+// Slowa liczby nieujemnej od najmlodszego
+static void dopisz_slowa(std::vector<unsigned char>& bufor, const ZZ& x, size_t slowa)
+{
+    size_t pozycja = bufor.size();
+    bufor.resize(pozycja + 8 * slowa);
+    BytesFromZZ(bufor.data() + pozycja, x, 8 * slowa);
+}
+
+
+static size_t liczba_slow(const ZZ& x)
+{
+    return (NumBytes(x) + 7) / 8;
+}
+
+
+bool jest_korpusem(const std::string& sciezka)
+{
+    std::ifstream plik(sciezka.c_str(), std::ios::binary);
+    char sygnatura[sizeof(SYGNATURA)];
+    return plik.read(sygnatura, sizeof(sygnatura)) && memcmp(sygnatura, SYGNATURA, sizeof(SYGNATURA)) == 0;
+}
+
+
+// Sprawdza, ze slowa zaczynajace sie na pozycji mieszcza sie w pliku
+static bool w_pliku(size_t pozycja, unsigned long long slowa, size_t rozmiar)
+{
+    return pozycja <= rozmiar && slowa <= (rozmiar - pozycja) / 8;
+}
+
+
+static bool odczytaj_klucze(const unsigned char* dane, size_t rozmiar, vector<KluczWsadu>& klucze)
+{
+    if (rozmiar < ROZMIAR_NAGLOWKA || memcmp(dane, SYGNATURA, sizeof(SYGNATURA)) != 0
+        || czytaj(dane + 8, 4) != WERSJA_KORPUSU)
+    {
+        return false;
+    }
+    unsigned long long flagi = czytaj(dane + 12, 4);
+    unsigned long long liczba = czytaj(dane + 16, 8);
+    unsigned long long indeks = czytaj(dane + 24, 8);
+    if (indeks > rozmiar || liczba > (rozmiar - indeks) / 16)
+    {
+        return false;
+    }
+
+    for (unsigned long long i = 0; i < liczba; i++)
+    {
+        const unsigned char* wpis = dane + indeks + 16 * i;
+        unsigned long long rekord = czytaj(wpis, 8);
+        unsigned long long rekord_d = czytaj(wpis + 8, 8);
+        if (rekord > rozmiar || rozmiar - rekord < 16)
+        {
+            return false;
+        }
+        const unsigned char* p = dane + rekord;
+        unsigned long long slowa_e = czytaj(p + 4, 4);
+        unsigned long long slowa_N = czytaj(p + 8, 4);
+        if (!w_pliku(rekord + 16, slowa_e + slowa_N, rozmiar))
+        {
+            return false;
+        }
+
+        KluczWsadu klucz;
+        klucz.bin_size = (long)czytaj(p, 4);
+        ZZFromBytes(klucz.e, p + 16, 8 * slowa_e);
+        ZZFromBytes(klucz.N, p + 16 + 8 * slowa_e, 8 * slowa_N);
+        if ((flagi & KORPUS_Z_D) && rekord_d != 0)
+        {
+            if (rekord_d > rozmiar || rozmiar - rekord_d < 8)
+            {
+                return false;
+            }
+            unsigned long long slowa_d = czytaj(dane + rekord_d, 4);
+            if (!w_pliku(rekord_d + 8, slowa_d, rozmiar))
+            {
+                return false;
+            }
+            ZZFromBytes(klucz.d, dane + rekord_d + 8, 8 * slowa_d);
+        }
+        klucze.push_back(klucz);
+    }
+    return true;
+}
+
+
+bool wczytaj_korpus(const std::string& sciezka, vector<KluczWsadu>& klucze)
+{
+    int plik = open(sciezka.c_str(), O_RDONLY);
+    struct stat opis;
+    if (plik < 0 || fstat(plik, &opis) != 0)
+    {
+        std::cerr << "Nie mozna odczytac pliku " << sciezka << std::endl;
+        if (plik >= 0)
+        {
+            close(plik);
+        }
+        return false;
+    }
+    size_t rozmiar = opis.st_size;
+    void* dane = rozmiar > 0 ? mmap(0, rozmiar, PROT_READ, MAP_PRIVATE, plik, 0) : MAP_FAILED;
+    close(plik);
+    if (dane == MAP_FAILED)
+    {
+        std::cerr << "Nie mozna odwzorowac pliku " << sciezka << std::endl;
+        return false;
+    }
+    madvise(dane, rozmiar, MADV_SEQUENTIAL);
+
+    bool poprawny = odczytaj_klucze((const unsigned char*)dane, rozmiar, klucze);
+    munmap(dane, rozmiar);
+    if (!poprawny)
+    {
+        std::cerr << "Uszkodzony korpus " << sciezka << std::endl;
+    }
+    return poprawny;
+}
+
+
+bool zapisz_korpus(const std::string& sciezka, const vector<KluczWsadu>& klucze)
+{
+    ZapisKorpusu zapis;
+    if (!zapis.otworz(sciezka))
+    {
+        return false;
+    }
+    for (size_t i = 0; i < klucze.size(); i++)
+    {
+        if (!zapis.dodaj(klucze[i]))
+        {
+            return false;
+        }
+    }
+    return zapis.zamknij();
+}
+
+
+ZapisKorpusu::ZapisKorpusu() : rozmiar(0), z_d(false)
+{
+}
+
+
+bool ZapisKorpusu::zapisz_bufor()
+{
+    if (!plik.write((const char*)bufor.data(), bufor.size()))
+    {
+        std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+        return false;
+    }
+    rozmiar += bufor.size();
+    bufor.clear();
+    return true;
+}
+
+
+bool ZapisKorpusu::otworz(const std::string& sciezka_pliku)
+{
+    sciezka = sciezka_pliku;
+    plik.open(sciezka.c_str(), std::ios::binary | std::ios::trunc);
+    if (!plik)
+    {
+        std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+        return false;
+    }
+    // Naglowek z zerami; liczbe kluczy, flagi i przesuniecia wpisuje zamknij()
+    bufor.assign(ROZMIAR_NAGLOWKA, 0);
+    return zapisz_bufor();
+}
+
+
+bool ZapisKorpusu::dodaj(const KluczWsadu& klucz)
+{
+    size_t slowa_e = liczba_slow(klucz.e), slowa_N = liczba_slow(klucz.N), slowa_d = liczba_slow(klucz.d);
+    rekordy.push_back(rozmiar);
+    dopisz(bufor, klucz.bin_size, 4);
+    dopisz(bufor, slowa_e, 4);
+    dopisz(bufor, slowa_N, 4);
+    dopisz(bufor, 0, 4);
+    dopisz_slowa(bufor, klucz.e, slowa_e);
+    dopisz_slowa(bufor, klucz.N, slowa_N);
+    z_d = z_d || slowa_d > 0;
+    rekordy_d.push_back(sekcja_d.size());
+    dopisz(sekcja_d, slowa_d, 4);
+    dopisz(sekcja_d, 0, 4);
+    dopisz_slowa(sekcja_d, klucz.d, slowa_d);
+    return zapisz_bufor();
+}
+
+
+bool ZapisKorpusu::zamknij()
+{
+    unsigned long long poczatek_d = z_d ? rozmiar : 0;
+    if (z_d)
+    {
+        bufor.swap(sekcja_d);
+        if (!zapisz_bufor())
+        {
+            return false;
+        }
+    }
+    unsigned long long indeks = rozmiar;
+    for (size_t i = 0; i < rekordy.size(); i++)
+    {
+        dopisz(bufor, rekordy[i], 8);
+        dopisz(bufor, z_d ? poczatek_d + rekordy_d[i] : 0, 8);
+    }
+    if (!zapisz_bufor())
+    {
+        return false;
+    }
+
+    bufor.assign(SYGNATURA, SYGNATURA + sizeof(SYGNATURA));
+    dopisz(bufor, WERSJA_KORPUSU, 4);
+    dopisz(bufor, z_d ? KORPUS_Z_D : 0, 4);
+    dopisz(bufor, rekordy.size(), 8);
+    dopisz(bufor, indeks, 8);
+    dopisz(bufor, poczatek_d, 8);
+    dopisz(bufor, 0, 8);
+    plik.seekp(0);
+    if (!plik.write((const char*)bufor.data(), bufor.size()) || !plik.flush())
+    {
+        std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+        return false;
+    }
+    plik.close();
+    return true;
+}
+
+
+int konwertuj_korpus(const std::string& tsv, const std::string& sciezka)
+{
+    vector<KluczWsadu> klucze;
+    if (!wczytaj_wsad(tsv, klucze) || !zapisz_korpus(sciezka, klucze))
+    {
+        return 1;
+    }
+    std::cout << "keys = " << klucze.size() << " written to " << sciezka << std::endl;
+    return 0;
+}
@@ -0,0 +1,72 @@
+#ifndef WIENER_CORPUS_H
+#define WIENER_CORPUS_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include "batch.h"
+
+// Binarny korpus kluczy. Wszystkie pola sa little-endian:
+//
+//   naglowek (48 bajtow)
+//     char[8]  "WIENKORP"
+//     uint32   wersja (WERSJA_KORPUSU)
+//     uint32   flagi (KORPUS_Z_D: jest sekcja wykladnikow d)
+//     uint64   liczba kluczy
+//     uint64   przesuniecie indeksu
+//     uint64   przesuniecie sekcji d (0 bez KORPUS_Z_D)
+//     uint64   zarezerwowane (0)
+//   rekordy kluczy, kazdy od granicy 8 bajtow
+//     uint32   bin_size, uint32 slowa e, uint32 slowa N, uint32 0
+//     slowa e, slowa N (uint64, od najmlodszego)
+//   sekcja d: dla kazdego klucza uint32 slowa d, uint32 0, slowa d
+//   indeks: dla kazdego klucza uint64 przesuniecie rekordu klucza
+//           i uint64 przesuniecie jego d (0 bez KORPUS_Z_D)
+//
+// Slowa little-endian od najmlodszego to zapis bajtowy liczby od
+// najmlodszego bajtu, wiec trafiaja do ZZFromBytes bez zadnej konwersji
+// tekstowej. p, q i phi(N) z test_values.txt nie sa zapisywane.
+
+const unsigned int WERSJA_KORPUSU = 1;
+const unsigned int KORPUS_Z_D = 1;
+
+// Czy plik zaczyna sie od sygnatury korpusu binarnego
+bool jest_korpusem(const std::string& sciezka);
+
+// Odwzorowuje korpus w pamiec (mmap) i dopisuje jego klucze
+bool wczytaj_korpus(const std::string& sciezka, vector<KluczWsadu>& klucze);
+
+// Zapisuje klucze jako korpus; sekcja d powstaje, gdy ktorys klucz ma d
+bool zapisz_korpus(const std::string& sciezka, const vector<KluczWsadu>& klucze);
+
+// Zapis korpusu po jednym kluczu: rekordy trafiaja do pliku od razu, w pamieci
+// zostaja tylko sekcja d i indeks, a naglowek uzupelnia zamknij()
+class ZapisKorpusu
+{
+public:
+    ZapisKorpusu();
+
+    bool otworz(const std::string& sciezka);
+    bool dodaj(const KluczWsadu& klucz);
+    bool zamknij();
+
+private:
+    std::string sciezka;
+    std::ofstream plik;
+    unsigned long long rozmiar;                    // bajty zapisane do pliku
+    std::vector<unsigned long long> rekordy;       // przesuniecia rekordow kluczy
+    std::vector<unsigned long long> rekordy_d;     // przesuniecia d w sekcja_d
+    std::vector<unsigned char> sekcja_d;
+    bool z_d;
+    std::vector<unsigned char> bufor;
+
+    bool zapisz_bufor();
+
+    ZapisKorpusu(const ZapisKorpusu&);
+    ZapisKorpusu& operator=(const ZapisKorpusu&);
+};
+
+// Zamienia plik w formacie test_values.txt na korpus binarny
+int konwertuj_korpus(const std::string& tsv, const std::string& sciezka);
+
+#endif
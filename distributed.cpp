@@ -0,0 +1,690 @@
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <set>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "distributed.h"
+#include "thread_pool.h"
+#include "line_io.h"
+
+// WORK i RESULT niosa dwie liczby dziesietne; limit wystarcza dla modulow
+// do okolo 6 mln bitow
+static const size_t MAKS_LINII = 4 << 20;
+
+
+// Praca koordynatora: klucz, sam atak podstawowy klucza (czesc -1) albo
+// jedna z czesci jego etapu rozszerzonego. Czesci klucza maja numery prac
+// tuz po jego ataku podstawowym.
+struct Praca
+{
+    long klucz;
+    long czesc, czesci;
+};
+
+// Wezel polaczony z koordynatorem
+struct Wezel
+{
+    int gniazdo;
+    std::string nazwa;        // adres wezla
+    long potrzeba;            // ile prac wezel jeszcze przyjmie
+    std::set<long> w_toku;    // prace wydane bez wyniku
+    long wykonane;
+    bool polaczony;
+    std::mutex blokada_zapisu;   // zapisy do gniazda z roznych watkow po kolei
+
+    Wezel(int gniazdo, const std::string& nazwa)
+        : gniazdo(gniazdo), nazwa(nazwa), potrzeba(0), wykonane(0), polaczony(true)
+    {
+    }
+};
+
+// Wszystkie pola poza klucze i prace chroni blokada
+struct StanKoordynatora
+{
+    const vector<KluczWsadu>* klucze;
+    vector<Praca> prace;
+    std::mutex blokada;
+    std::deque<long> kolejka;    // prace do wydania
+    long pozostale;              // prace wydane lub w kolejce bez wyniku
+    vector<WynikKlucza> wyniki;
+    vector<std::shared_ptr<Wezel> > wezly;
+    bool koniec;                 // wszystkie prace maja wynik, wezly dostaly BYE
+};
+
+// Komunikaty zebrane pod blokada i wysylane po jej zwolnieniu, zeby wolny
+// wezel nie zatrzymywal pozostalych
+typedef vector<std::pair<std::shared_ptr<Wezel>, std::string> > Wysylki;
+
+
+static void wyslij(const Wysylki& wysylki)
+{
+    for (size_t j = 0; j < wysylki.size(); j++)
+    {
+        Wezel& wezel = *wysylki[j].first;
+        std::lock_guard<std::mutex> blokada(wezel.blokada_zapisu);
+        zapisz_wszystko(wezel.gniazdo, wysylki[j].second);
+    }
+}
+
+
+// Wydaje prace wezlom, ktore na nie czekaja, po jednej na wezel w kazdej
+// rundzie, zeby czesci jednego klucza trafialy do roznych wezlow. Gdy
+// wszystkie prace maja wynik, wysyla BYE. Wolane pod blokada; komunikaty
+// trafiaja do wysylki.
+static void rozdaj(StanKoordynatora& stan, Wysylki& wysylki)
+{
+    vector<std::string> teksty(stan.wezly.size());
+    bool wydano = true;
+    while (wydano && !stan.kolejka.empty())
+    {
+        wydano = false;
+        for (size_t w = 0; w < stan.wezly.size() && !stan.kolejka.empty(); w++)
+        {
+            Wezel& wezel = *stan.wezly[w];
+            if (!wezel.polaczony || wezel.potrzeba <= 0)
+            {
+                continue;
+            }
+            long nr = stan.kolejka.front();
+            stan.kolejka.pop_front();
+            const Praca& praca = stan.prace[nr];
+            const KluczWsadu& klucz = (*stan.klucze)[praca.klucz];
+            std::ostringstream tekst;
+            tekst << "WORK " << nr << " " << praca.klucz << " " << praca.czesc << " " << praca.czesci << " "
+                  << klucz.e << " " << klucz.N << "\n";
+            teksty[w] += tekst.str();
+            wezel.potrzeba--;
+            wezel.w_toku.insert(nr);
+            wydano = true;
+        }
+    }
+    if (stan.pozostale == 0 && !stan.koniec)
+    {
+        stan.koniec = true;
+        for (size_t w = 0; w < teksty.size(); w++)
+        {
+            teksty[w] += "BYE\n";
+        }
+    }
+    for (size_t w = 0; w < teksty.size(); w++)
+    {
+        if (stan.wezly[w]->polaczony && !teksty[w].empty())
+        {
+            wysylki.push_back(std::make_pair(stan.wezly[w], teksty[w]));
+        }
+    }
+}
+
+
+// d klucza znalezione: jego niewydane prace sa zbedne, a wezly z pracami
+// klucza w toku dostaja STOP. Wolane pod blokada; komunikaty trafiaja do
+// wysylki.
+static void zatrzymaj_klucz(StanKoordynatora& stan, long klucz, Wysylki& wysylki)
+{
+    for (std::deque<long>::iterator it = stan.kolejka.begin(); it != stan.kolejka.end();)
+    {
+        if (stan.prace[*it].klucz == klucz)
+        {
+            it = stan.kolejka.erase(it);
+            stan.pozostale--;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    std::ostringstream tekst;
+    tekst << "STOP " << klucz << "\n";
+    for (size_t w = 0; w < stan.wezly.size(); w++)
+    {
+        Wezel& wezel = *stan.wezly[w];
+        for (std::set<long>::const_iterator it = wezel.w_toku.begin(); wezel.polaczony && it != wezel.w_toku.end(); ++it)
+        {
+            if (stan.prace[*it].klucz == klucz)
+            {
+                wysylki.push_back(std::make_pair(stan.wezly[w], tekst.str()));
+                break;
+            }
+        }
+    }
+}
+
+
+// RESULT nr found poprawny d czas_ns liczniki...
+static bool wczytaj_wynik(const std::string& linia, long& nr, WynikKlucza& wynik)
+{
+    std::istringstream pola(linia);
+    std::string slowo;
+    pola >> slowo >> nr >> wynik.znaleziono >> wynik.poprawny >> wynik.d >> wynik.czas_ns;
+    long* liczniki[LICZNIKI_WYNIKU];
+    liczniki_wyniku(wynik.statystyki, liczniki);
+    for (long j = 0; j < LICZNIKI_WYNIKU; j++)
+    {
+        pola >> *liczniki[j];
+    }
+    return !pola.fail() && slowo == "RESULT";
+}
+
+
+// Dolicza wynik pracy do wyniku klucza. Wolane pod blokada.
+static void scal_wynik(StanKoordynatora& stan, Wezel& wezel, long nr, const WynikKlucza& wynik_pracy,
+                       Wysylki& wysylki)
+{
+    long i = stan.prace[nr].klucz;
+    const KluczWsadu& klucz = (*stan.klucze)[i];
+    WynikKlucza& wynik_klucza = stan.wyniki[i];
+    wynik_klucza.czas_ns += wynik_pracy.czas_ns;
+    wynik_klucza.statystyki.dodaj(wynik_pracy.statystyki);
+    wezel.w_toku.erase(nr);
+    wezel.wykonane++;
+    stan.pozostale--;
+    if (wynik_pracy.znaleziono && !wynik_klucza.znaleziono)
+    {
+        wynik_klucza.znaleziono = true;
+        wynik_klucza.d = wynik_pracy.d;
+        wynik_klucza.poprawny = wynik_pracy.poprawny && (IsZero(klucz.d) || klucz.d == wynik_pracy.d);
+        zatrzymaj_klucz(stan, i, wysylki);
+    }
+    else if (stan.prace[nr].czesc < 0 && !wynik_pracy.znaleziono && !przekroczony_budzet(wynik_pracy))
+    {
+        // Atak podstawowy nie wystarczyl: czesci etapu rozszerzonego na poczatek kolejki
+        for (long c = stan.prace[nr].czesci; c >= 1; c--)
+        {
+            stan.kolejka.push_front(nr + c);
+        }
+        stan.pozostale += stan.prace[nr].czesci;
+    }
+}
+
+
+// Watek polaczenia z wezlem: GET i RESULT az do rozlaczenia; prace
+// rozlaczonego wezla bez wyniku wracaja na poczatek kolejki
+static void obsluz_wezel(StanKoordynatora* stan, std::shared_ptr<Wezel> wezel)
+{
+    CzytnikLinii czytnik(wezel->gniazdo, MAKS_LINII);
+    std::string linia;
+    bool za_dluga;
+    while (czytnik.nastepna(linia, za_dluga))
+    {
+        Wysylki wysylki;
+        {
+            std::lock_guard<std::mutex> blokada(stan->blokada);
+            long nr;
+            WynikKlucza wynik_pracy = WynikKlucza();
+            if (!za_dluga && linia.compare(0, 4, "GET ") == 0)
+            {
+                wezel->potrzeba += max(atol(linia.c_str() + 4), 0L);
+            }
+            else if (za_dluga || !wczytaj_wynik(linia, nr, wynik_pracy) || wezel->w_toku.count(nr) == 0)
+            {
+                std::cerr << "Niepoprawny komunikat wezla " << wezel->nazwa << std::endl;
+                break;
+            }
+            else
+            {
+                scal_wynik(*stan, *wezel, nr, wynik_pracy, wysylki);
+            }
+            if (stan->koniec)
+            {
+                wysylki.push_back(std::make_pair(wezel, std::string("BYE\n")));
+            }
+            else
+            {
+                rozdaj(*stan, wysylki);
+            }
+        }
+        wyslij(wysylki);
+    }
+
+    Wysylki wysylki;
+    {
+        std::lock_guard<std::mutex> blokada(stan->blokada);
+        wezel->polaczony = false;
+        for (std::set<long>::const_reverse_iterator it = wezel->w_toku.rbegin(); it != wezel->w_toku.rend(); ++it)
+        {
+            if (stan->wyniki[stan->prace[*it].klucz].znaleziono)
+            {
+                stan->pozostale--;
+            }
+            else
+            {
+                stan->kolejka.push_front(*it);
+            }
+        }
+        wezel->w_toku.clear();
+        rozdaj(*stan, wysylki);
+    }
+    wyslij(wysylki);
+}
+
+
+// Adres wezla jako host:port
+static std::string nazwa_adresu(const sockaddr* adres, socklen_t dlugosc)
+{
+    char host[NI_MAXHOST], port[NI_MAXSERV];
+    if (getnameinfo(adres, dlugosc, host, sizeof(host), port, sizeof(port), NI_NUMERICHOST | NI_NUMERICSERV) != 0)
+    {
+        return "?";
+    }
+    return std::string(host) + ":" + port;
+}
+
+
+int koordynuj(const std::string& sciezka, const UstawieniaRozproszone& ustawienia)
+{
+    const UstawieniaWsadu& wsad = ustawienia.wsad;
+    if (wsad.wspolne_czynniki || !wsad.pamiec.empty() || !wsad.punkt_kontrolny.empty())
+    {
+        std::cerr << "Opcje --shared-factors, --cache i --checkpoint nie dzialaja w trybie rozproszonym"
+                  << std::endl;
+        return 1;
+    }
+    // Zapis do rozlaczonego wezla ma zwrocic blad, a nie zakonczyc proces
+    signal(SIGPIPE, SIG_IGN);
+    vector<KluczWsadu> klucze;
+    if (!wczytaj_wsad(sciezka, klucze))
+    {
+        return 1;
+    }
+
+    StanKoordynatora stan;
+    stan.klucze = &klucze;
+    stan.wyniki.resize(klucze.size());
+    stan.koniec = false;
+    vector<long> kolejnosc(klucze.size());
+    for (long i = 0; i < (long)klucze.size(); i++)
+    {
+        kolejnosc[i] = i;
+    }
+    DluzszyModul porzadek = { &klucze };
+    std::sort(kolejnosc.begin(), kolejnosc.end(), porzadek);
+    long czesci = wsad.atak.rozszerzenie.bity > 0 && ustawienia.podzial > 1 ? ustawienia.podzial : 1;
+    for (size_t j = 0; j < kolejnosc.size(); j++)
+    {
+        Praca praca = { kolejnosc[j], czesci > 1 ? -1 : 0, czesci };
+        stan.kolejka.push_back(stan.prace.size());
+        stan.prace.push_back(praca);
+        for (long c = 0; czesci > 1 && c < czesci; c++)
+        {
+            praca.czesc = c;
+            stan.prace.push_back(praca);
+        }
+    }
+    stan.pozostale = stan.kolejka.size();
+    stan.koniec = stan.pozostale == 0;
+    std::string linia_opcji = "OPTIONS";
+    for (size_t j = 0; j < ustawienia.opcje.size(); j++)
+    {
+        linia_opcji += " " + ustawienia.opcje[j];
+    }
+    linia_opcji += "\n";
+
+    sockaddr_in adres;
+    memset(&adres, 0, sizeof(adres));
+    adres.sin_family = AF_INET;
+    adres.sin_addr.s_addr = htonl(INADDR_ANY);
+    adres.sin_port = htons((unsigned short)atol(ustawienia.adres.c_str()));
+    int gniazdo = socket(AF_INET, SOCK_STREAM, 0);
+    int tak = 1;
+    if (gniazdo < 0 || setsockopt(gniazdo, SOL_SOCKET, SO_REUSEADDR, &tak, sizeof(tak)) != 0
+        || bind(gniazdo, (const sockaddr*)&adres, sizeof(adres)) != 0 || listen(gniazdo, SOMAXCONN) != 0)
+    {
+        std::cerr << "Nie mozna otworzyc portu " << ustawienia.adres << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // Wezly moga dolaczac w kazdej chwili az do konca przebiegu; czas liczony
+    // jest od pierwszego wezla
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    vector<std::thread> watki;
+    bool blad = false;
+    for (;;)
+    {
+        {
+            std::lock_guard<std::mutex> blokada(stan.blokada);
+            if (stan.koniec)
+            {
+                break;
+            }
+        }
+        pollfd oczekiwanie = { gniazdo, POLLIN, 0 };
+        if (poll(&oczekiwanie, 1, 200) <= 0)
+        {
+            continue;
+        }
+        sockaddr_storage adres_wezla;
+        socklen_t dlugosc = sizeof(adres_wezla);
+        int klient = accept(gniazdo, (sockaddr*)&adres_wezla, &dlugosc);
+        if (klient < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            std::cerr << "Blad accept: " << strerror(errno) << std::endl;
+            blad = true;
+            break;
+        }
+        std::shared_ptr<Wezel> wezel(new Wezel(klient, nazwa_adresu((const sockaddr*)&adres_wezla, dlugosc)));
+        // Opcje przed dodaniem wezla, zeby wyprzedzily inne komunikaty i nie byly pisane pod blokada
+        zapisz_wszystko(klient, linia_opcji);
+        std::lock_guard<std::mutex> blokada(stan.blokada);
+        if (stan.wezly.empty())
+        {
+            begin = std::chrono::steady_clock::now();
+        }
+        stan.wezly.push_back(wezel);
+        watki.push_back(std::thread(obsluz_wezel, &stan, wezel));
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    long long czas_calkowity_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    close(gniazdo);
+
+    // Po BYE wezly same zamykaja polaczenia; przy bledzie zamyka je koordynator
+    for (size_t w = 0; blad && w < stan.wezly.size(); w++)
+    {
+        shutdown(stan.wezly[w]->gniazdo, SHUT_RDWR);
+    }
+    for (size_t t = 0; t < watki.size(); t++)
+    {
+        watki[t].join();
+    }
+    for (size_t w = 0; w < stan.wezly.size(); w++)
+    {
+        close(stan.wezly[w]->gniazdo);
+    }
+    if (blad)
+    {
+        return 1;
+    }
+
+    long bledne = wypisz_wyniki(klucze, stan.wyniki, vector<ZZ>(), wsad);
+    long wykonane = 0;
+    for (size_t w = 0; w < stan.wezly.size(); w++)
+    {
+        std::cout << "node = " << stan.wezly[w]->nazwa << " works = " << stan.wezly[w]->wykonane << std::endl;
+        wykonane += stan.wezly[w]->wykonane;
+    }
+    std::cout << "nodes = " << stan.wezly.size() << " keys = " << klucze.size() << " works = " << wykonane
+              << " Wall time = " << czas_calkowity_ns / 1000.0 << "[µs]"
+              << " throughput = " << (czas_calkowity_ns > 0 ? klucze.size() * 1e9 / czas_calkowity_ns : 0.0) << "[keys/s]"
+              << std::endl;
+    return bledne == 0 ? 0 : 1;
+}
+
+
+// Praca wezla: jedna czesc klucza
+struct PracaWezla
+{
+    long nr;
+    long czesc, czesci;
+    long numer_klucza;
+    KluczWsadu klucz;
+};
+
+// Stan wezla wspolny dla watku czytajacego i watkow ataku
+struct StanWezla
+{
+    int gniazdo;
+    std::mutex blokada_zapisu;
+    std::mutex blokada;                 // zatrzymane, klucze_watkow i rozlaczony
+    std::set<long> zatrzymane;          // klucze po STOP
+    bool rozlaczony;                    // bez koordynatora zadna praca nie jest juz atakowana
+    vector<long> klucze_watkow;         // klucz atakowany przez watek, -1 = brak
+    vector<std::atomic<bool> > przerwij;
+
+    StanWezla(int gniazdo, long watki) : gniazdo(gniazdo), rozlaczony(false), klucze_watkow(watki, -1), przerwij(watki) {}
+};
+
+
+// Watek ataku wezla: kolejne prace z kolejki; praca klucza po STOP nie jest
+// atakowana, ale tez dostaje wynik, zeby koordynator zamknal ja u siebie
+static void atakuj_prace(StanWezla* stan, KolejkaOgraniczona<PracaWezla>* prace, const UstawieniaAtaku* ustawienia,
+                         long nr_watku)
+{
+    KontekstWsadu kontekst;
+    PracaWezla praca;
+    while (prace->pobierz(praca))
+    {
+        bool zatrzymana;
+        {
+            std::lock_guard<std::mutex> blokada(stan->blokada);
+            zatrzymana = stan->rozlaczony || stan->zatrzymane.count(praca.numer_klucza) > 0;
+            stan->klucze_watkow[nr_watku] = praca.numer_klucza;
+            stan->przerwij[nr_watku].store(false);
+        }
+        WynikKlucza wynik = WynikKlucza();
+        if (!zatrzymana)
+        {
+            UstawieniaAtaku ustawienia_pracy = *ustawienia;
+            if (praca.czesc < 0)
+            {
+                ustawienia_pracy.rozszerzenie.bity = 0;
+            }
+            else
+            {
+                ustawienia_pracy.rozszerzenie.czesc = praca.czesc;
+                ustawienia_pracy.rozszerzenie.czesci = praca.czesci;
+            }
+            ustawienia_pracy.rozszerzenie.przerwij = &stan->przerwij[nr_watku];
+            atakuj_klucz(praca.klucz, ustawienia_pracy, wynik, kontekst);
+        }
+        {
+            std::lock_guard<std::mutex> blokada(stan->blokada);
+            stan->klucze_watkow[nr_watku] = -1;
+        }
+
+        std::ostringstream tekst;
+        tekst << "RESULT " << praca.nr << " " << wynik.znaleziono << " " << wynik.poprawny << " ";
+        if (wynik.znaleziono)
+        {
+            tekst << wynik.d;
+        }
+        else
+        {
+            tekst << 0;
+        }
+        tekst << " " << wynik.czas_ns;
+        long* liczniki[LICZNIKI_WYNIKU];
+        liczniki_wyniku(wynik.statystyki, liczniki);
+        for (long j = 0; j < LICZNIKI_WYNIKU; j++)
+        {
+            tekst << " " << *liczniki[j];
+        }
+        tekst << "\nGET 1\n";
+        std::lock_guard<std::mutex> blokada(stan->blokada_zapisu);
+        zapisz_wszystko(stan->gniazdo, tekst.str());
+    }
+}
+
+
+// WORK nr klucz czesc czesci e N
+static bool wczytaj_prace(const std::string& linia, PracaWezla& praca)
+{
+    std::istringstream pola(linia);
+    std::string slowo;
+    pola >> slowo >> praca.nr >> praca.numer_klucza >> praca.czesc >> praca.czesci >> praca.klucz.e >> praca.klucz.N;
+    praca.klucz.bin_size = NumBits(praca.klucz.N);
+    return !pola.fail() && slowo == "WORK" && praca.czesci >= 1 && praca.czesc >= -1 && praca.czesc < praca.czesci
+           && !IsZero(praca.klucz.e) && praca.klucz.N > 1;
+}
+
+
+// Opcje jak z wiersza polecen; zwraca false dla nieznanej opcji
+static bool wczytaj_opcje(const vector<std::string>& opcje, UstawieniaWsadu& wsad)
+{
+    vector<std::string> kopie(opcje);
+    vector<char*> argv;
+    for (size_t j = 0; j < kopie.size(); j++)
+    {
+        argv.push_back(&kopie[j][0]);
+    }
+    for (int i = 0; i < (int)argv.size(); i++)
+    {
+        if (!wczytaj_opcje_wsadu(argv.size(), argv.data(), i, wsad))
+        {
+            std::cerr << "Nieznana opcja lub wartosc " << argv[i] << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static int polacz(const std::string& adres)
+{
+    size_t dwukropek = adres.rfind(':');
+    if (dwukropek == std::string::npos)
+    {
+        std::cerr << "Oczekiwano adresu host:port, a nie " << adres << std::endl;
+        return -1;
+    }
+    addrinfo wskazowki, *adresy;
+    memset(&wskazowki, 0, sizeof(wskazowki));
+    wskazowki.ai_family = AF_UNSPEC;
+    wskazowki.ai_socktype = SOCK_STREAM;
+    int status = getaddrinfo(adres.substr(0, dwukropek).c_str(), adres.substr(dwukropek + 1).c_str(), &wskazowki,
+                             &adresy);
+    if (status != 0)
+    {
+        std::cerr << "Nie mozna znalezc " << adres << ": " << gai_strerror(status) << std::endl;
+        return -1;
+    }
+    int gniazdo = -1;
+    for (addrinfo* a = adresy; a && gniazdo < 0; a = a->ai_next)
+    {
+        gniazdo = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (gniazdo >= 0 && connect(gniazdo, a->ai_addr, a->ai_addrlen) != 0)
+        {
+            close(gniazdo);
+            gniazdo = -1;
+        }
+    }
+    freeaddrinfo(adresy);
+    if (gniazdo < 0)
+    {
+        std::cerr << "Nie mozna polaczyc z koordynatorem " << adres << ": " << strerror(errno) << std::endl;
+    }
+    return gniazdo;
+}
+
+
+int pracuj(const UstawieniaRozproszone& ustawienia)
+{
+    signal(SIGPIPE, SIG_IGN);
+    int gniazdo = polacz(ustawienia.adres);
+    if (gniazdo < 0)
+    {
+        return 1;
+    }
+
+    // Opcje ataku przychodza od koordynatora, lokalne (--threads) je uzupelniaja
+    CzytnikLinii czytnik(gniazdo, MAKS_LINII);
+    std::string linia;
+    bool za_dluga;
+    if (!czytnik.nastepna(linia, za_dluga) || za_dluga || linia.compare(0, 7, "OPTIONS") != 0)
+    {
+        std::cerr << "Koordynator " << ustawienia.adres << " nie przyslal opcji" << std::endl;
+        close(gniazdo);
+        return 1;
+    }
+    std::istringstream pola(linia.substr(7));
+    vector<std::string> opcje;
+    std::string slowo;
+    while (pola >> slowo)
+    {
+        opcje.push_back(slowo);
+    }
+    UstawieniaWsadu wsad;
+    wsad.watki = 0;
+    if (!wczytaj_opcje(opcje, wsad) || !wczytaj_opcje(ustawienia.opcje, wsad))
+    {
+        close(gniazdo);
+        return 1;
+    }
+
+    long watki = liczba_watkow_roboczych(wsad.watki);
+    StanWezla stan(gniazdo, watki);
+    KolejkaOgraniczona<PracaWezla> prace(watki);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    vector<std::thread> atakujace;
+    for (long t = 0; t < watki; t++)
+    {
+        atakujace.push_back(std::thread(atakuj_prace, &stan, &prace, &wsad.atak, t));
+    }
+    {
+        std::ostringstream tekst;
+        tekst << "GET " << watki << "\n";
+        std::lock_guard<std::mutex> blokada(stan.blokada_zapisu);
+        zapisz_wszystko(gniazdo, tekst.str());
+    }
+
+    // Koordynator wysyla najwyzej tyle prac, ile wezel zamowil, wiec wstaw nie czeka
+    bool zakonczone = false;
+    long wykonane = 0;
+    while (!zakonczone && czytnik.nastepna(linia, za_dluga))
+    {
+        PracaWezla praca;
+        if (!za_dluga && linia == "BYE")
+        {
+            zakonczone = true;
+        }
+        else if (!za_dluga && linia.compare(0, 5, "STOP ") == 0)
+        {
+            long klucz = atol(linia.c_str() + 5);
+            std::lock_guard<std::mutex> blokada(stan.blokada);
+            stan.zatrzymane.insert(klucz);
+            for (long t = 0; t < watki; t++)
+            {
+                if (stan.klucze_watkow[t] == klucz)
+                {
+                    stan.przerwij[t].store(true);
+                }
+            }
+        }
+        else if (!za_dluga && wczytaj_prace(linia, praca))
+        {
+            prace.wstaw(praca);
+            wykonane++;
+        }
+        else
+        {
+            std::cerr << "Niepoprawny komunikat koordynatora" << std::endl;
+            break;
+        }
+    }
+    if (!zakonczone)
+    {
+        std::cerr << "Utracono polaczenie z koordynatorem " << ustawienia.adres << std::endl;
+        std::lock_guard<std::mutex> blokada(stan.blokada);
+        stan.rozlaczony = true;
+        for (long t = 0; t < watki; t++)
+        {
+            stan.przerwij[t].store(true);
+        }
+    }
+    prace.zamknij();
+    for (size_t t = 0; t < atakujace.size(); t++)
+    {
+        atakujace[t].join();
+    }
+    close(gniazdo);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    long long czas_calkowity_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    std::cout << "threads = " << watki << " works = " << wykonane
+              << " Wall time = " << czas_calkowity_ns / 1000.0 << "[µs]" << std::endl;
+    return zakonczone ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#ifndef WIENER_DISTRIBUTED_H
+#define WIENER_DISTRIBUTED_H
+
+#include <string>
+#include <vector>
+#include "batch.h"
+
+// Tryb rozproszony: koordynator wczytuje plik kluczy (takze korpus binarny
+// odwzorowany w pamiec) i rozdziela prace miedzy wezly przez TCP; kazdy wezel
+// atakuje swoje klucze w wielu watkach tym samym atak() co --batch. Prace
+// wydawane sa na zadanie wezla od najdluzszego modulu (DluzszyModul), wiec
+// szybszy wezel dostaje po prostu wiecej kluczy. Z podzialem > 1 i etapem
+// rozszerzonym klucz zaczyna sie od jednej pracy z samym atakiem
+// podstawowym; dopiero gdy ten nie znajdzie d, kolejka dostaje podzial prac
+// etapu rozszerzonego: czesc c sprawdza jego zadania o numerze c mod podzial
+// (RozszerzenieAtaku::czesc), bez powtarzania ataku podstawowego. Gdy
+// ktoras czesc znajdzie d, koordynator wysyla STOP do wszystkich wezlow,
+// a te przerywaja pozostale czesci klucza. Prace rozlaczonego wezla wracaja
+// do kolejki. Protokol jest tekstowy, linia na komunikat:
+//
+//   koordynator -> wezel
+//     OPTIONS opcje...                      opcje ataku z wiersza polecen koordynatora
+//     WORK nr klucz czesc czesci e N        praca do wykonania; czesc -1 = sam atak podstawowy
+//     STOP klucz                            d klucza znalezione, reszta czesci zbedna
+//     BYE                                   wszystkie prace maja wynik
+//   wezel -> koordynator
+//     GET n                                 wezel przyjmie jeszcze n prac
+//     RESULT nr found poprawny d czas_ns liczniki...
+//                                           wynik pracy; LICZNIKI_WYNIKU licznikow
+//
+// Wynik klucza scalany jest z jego prac: czas i liczniki sa sumami po
+// pracach, d pochodzi z pracy, ktora je znalazla. Koordynator wysyla komunikaty po zwolnieniu blokady stanu, wiec
+// wezel, ktory wolno odbiera, nie wstrzymuje obslugi pozostalych.
+struct UstawieniaRozproszone
+{
+    UstawieniaWsadu wsad;             // ustawienia ataku koordynatora lub wezla
+    std::vector<std::string> opcje;   // koordynator: opcje wysylane wezlom; wezel: opcje lokalne
+    std::string adres;                // koordynator: port; wezel: host:port
+    long podzial;                     // liczba czesci etapu rozszerzonego klucza
+
+    UstawieniaRozproszone() : podzial(1) {}
+};
+
+// Koordynator: rozdziela klucze z pliku, czeka na wyniki wszystkich kluczy
+// i wypisuje je jak uruchom_wsad()
+int koordynuj(const std::string& sciezka, const UstawieniaRozproszone& ustawienia);
+
+// Wezel: laczy sie z koordynatorem i atakuje przydzielone prace do BYE
+int pracuj(const UstawieniaRozproszone& ustawienia);
+
+#endif
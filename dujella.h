@@ -0,0 +1,235 @@
+#ifndef WIENER_DUJELLA_H
+#define WIENER_DUJELLA_H
+
+#include <vector>
+#include "attack.h"
+#include "extension.h"
+
+// Wariant Dujelli: dla d = r Q_{i+1} +- s Q_i z e*d = 1 (mod phi(N)) zachodzi
+// 2^(e*d) = 2 (mod N), czyli a^r = 2 b^(-+s) dla a = 2^(e Q_{i+1}),
+// b = 2^(e Q_i). Kroki male a^r trafiaja do tablicy mieszajacej, kroki duze
+// 2 b^(-+s) sa w niej wyszukiwane, wiec 2^(2t) kandydatow sprawdza sie w czasie
+// i pamieci okolo 2^t. Zgodnosc w tablicy jest jedynie kandydatem, ktory
+// sprawdza sprawdz_redukt.
+
+
+// Tablica krokow malych z adresowaniem otwartym (sondowanie liniowe). Wpis to
+// 64-bitowy odcisk reszty (najnizsze slowo a^r mod N) i wykladnik r.
+class TablicaKrokow
+{
+public:
+    // Rozmiar wpisu wraz z zapasem na wypelnienie tablicy do polowy
+    static const long BAJTY_NA_KROK = 2 * 16;
+
+    explicit TablicaKrokow(long liczba_krokow)
+    {
+        long rozmiar = 2;
+        while (rozmiar < 2 * liczba_krokow)
+        {
+            rozmiar *= 2;
+        }
+        sloty.resize(rozmiar);
+        maska = rozmiar - 1;
+        wyczysc();
+    }
+
+    void wyczysc()
+    {
+        for (size_t i = 0; i < sloty.size(); i++)
+        {
+            sloty[i].r = PUSTY;
+        }
+    }
+
+    void dodaj(unsigned long odcisk, unsigned int r)
+    {
+        unsigned long i = pozycja(odcisk);
+        while (sloty[i].r != PUSTY)
+        {
+            i = (i + 1) & maska;
+        }
+        sloty[i].odcisk = odcisk;
+        sloty[i].r = r;
+    }
+
+    // Wywoluje znaleziony(r) dla kazdego wpisu o danym odcisku; konczy, gdy
+    // znaleziony zwroci true
+    template <class Znaleziony>
+    bool szukaj(unsigned long odcisk, Znaleziony znaleziony) const
+    {
+        for (unsigned long i = pozycja(odcisk); sloty[i].r != PUSTY; i = (i + 1) & maska)
+        {
+            if (sloty[i].odcisk == odcisk && znaleziony(sloty[i].r))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static const unsigned int PUSTY = ~0U;
+
+    struct Wpis
+    {
+        unsigned long odcisk;
+        unsigned int r;
+    };
+
+    // Reszty mod N sa rownomiernie rozlozone; mnozenie rozprasza kolejne odciski
+    unsigned long pozycja(unsigned long odcisk) const
+    {
+        return (odcisk * 0x9E3779B97F4A7C15UL >> 20) & maska;
+    }
+
+    std::vector<Wpis> sloty;
+    unsigned long maska;
+};
+
+
+template <class Liczba>
+inline unsigned long odcisk_reszty(const Liczba& x)
+{
+    return (unsigned long)trunc_long(x, 64);
+}
+
+
+// Zwraca true i ustawia q oraz d, gdy ktorys kandydat daje rozklad N.
+// Gdy tablica 2^bity krokow malych nie miesci sie w ustawienia.rozszerzenie.pamiec,
+// r przegladane jest w kilku porcjach, a kroki duze powtarzane dla kazdej z nich.
+template <class Liczba>
+bool atak_dujelli(const Liczba& e, const Liczba& N, Liczba& q, Liczba& d,
+                  const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    const long bity = ustawienia.rozszerzenie.bity;
+    const long R = 1L << bity;
+
+    Liczba D, D_max;
+    vector<Liczba> P, Q;
+    vector<long> pary;
+    pary_reduktow(e, N, bity, D, D_max, P, Q, pary);
+
+    long porcja = ustawienia.rozszerzenie.pamiec / TablicaKrokow::BAJTY_NA_KROK;
+    if (porcja < 1)
+    {
+        porcja = 1;
+    }
+    if (porcja > R)
+    {
+        porcja = R;
+    }
+    TablicaKrokow tablica(porcja);
+
+    Liczba dwa, a, b, b_odwr, wykladnik, x, y;
+    Liczba k_kandydat, d_kandydat, t;
+    ZmienneRobocze<Liczba> z;
+    StatystykiAtaku statystyki_etapu;
+    dwa = 2;
+
+    // Zadanie (j, r0) ma numer j * liczba porcji + r0 / porcja. Z czesci > 1
+    // sprawdzane sa tylko zadania czesci, a po wznowieniu zadania przed
+    // postep->poczatek sa pomijane.
+    long porcje = (R + porcja - 1) / porcja;
+    const RozszerzenieAtaku& rozszerzenie = ustawienia.rozszerzenie;
+    PostepRozszerzenia* postep = rozszerzenie.postep;
+    const std::atomic<bool>* przerwij = rozszerzenie.przerwij;
+    TerminAtaku* termin = ustawienia.termin;
+    auto przerwane = [&]() {
+        return (przerwij && przerwij->load(std::memory_order_relaxed)) || po_terminie(termin);
+    };
+    long poczatek = postep ? postep->poczatek : 0;
+    for (long j = poczatek / porcje; j < (long)pary.size() && !przerwane(); j++)
+    {
+        long i = pary[j];
+        mul(wykladnik, e, Q[i + 1]);
+        PowerMod(a, dwa, wykladnik, N);
+        mul(wykladnik, e, Q[i]);
+        PowerMod(b, dwa, wykladnik, N);
+        // Przy gcd(b, N) > 1 (np. parzysty N z pliku) b nie ma odwrotnosci,
+        // a InvMod zakonczylby proces; taka para jest pomijana
+        if (InvModStatus(b_odwr, b, N) != 0)
+        {
+            continue;
+        }
+
+        long r_start = j == poczatek / porcje ? poczatek % porcje * porcja : 0;
+        long r_x = -1;  // x = a^r_x
+        for (long r0 = r_start; r0 < R && !przerwane(); r0 += porcja)
+        {
+            long zadanie = j * porcje + r0 / porcja;
+            if (zadanie % rozszerzenie.czesci != rozszerzenie.czesc)
+            {
+                continue;
+            }
+            if (postep)
+            {
+                postep->wykonane.store(zadanie);
+            }
+            if (r_x != r0)
+            {
+                wykladnik = r0;
+                PowerMod(x, a, wykladnik, N);
+            }
+            // Kroki male: a^r dla r z [r0, r0 + porcja)
+            tablica.wyczysc();
+            long koniec = r0 + porcja < R ? r0 + porcja : R;
+            for (long r = r0; r < koniec; r++)
+            {
+                if (termin && (r + 1) % KROK_BUDZETU == 0
+                    && termin->dolicz(KROK_BUDZETU, true, i, NumBits(Q[i + 1]) + bity))
+                {
+                    break;
+                }
+                tablica.dodaj(odcisk_reszty(x), (unsigned int)r);
+                MulMod(x, x, a, N);
+            }
+            r_x = koniec;
+
+            // Kroki duze: 2 b^(-s) dla d = r Q_{i+1} + s Q_i, 2 b^s dla d = r Q_{i+1} - s Q_i
+            for (int znak = 1; znak >= -1; znak -= 2)
+            {
+                const Liczba& krok = znak > 0 ? b_odwr : b;
+                y = dwa;
+                for (long s = 0; s < R && !przerwane(); s++)
+                {
+                    if (termin && (s + 1) % KROK_BUDZETU == 0
+                        && termin->dolicz(KROK_BUDZETU, true, i, NumBits(Q[i + 1]) + bity))
+                    {
+                        break;
+                    }
+                    bool trafienie = tablica.szukaj(odcisk_reszty(y), [&](unsigned int r) {
+                        if (nwd(r, s) != 1)
+                        {
+                            return false;
+                        }
+                        mul(k_kandydat, P[i + 1], (long)r);
+                        mul(t, P[i], znak * s);
+                        add(k_kandydat, k_kandydat, t);
+                        mul(d_kandydat, Q[i + 1], (long)r);
+                        mul(t, Q[i], znak * s);
+                        add(d_kandydat, d_kandydat, t);
+                        if (sign(k_kandydat) <= 0 || !(D < d_kandydat))
+                        {
+                            return false;
+                        }
+                        statystyki_etapu.kandydaci_rozszerzenia++;
+                        return sprawdz_redukt(e, N, k_kandydat, d_kandydat, q, z, ustawienia.filtry, statystyki_etapu);
+                    });
+                    if (trafienie)
+                    {
+                        d = d_kandydat;
+                        statystyki_etapu.redukty = 0;
+                        statystyki.dodaj(statystyki_etapu);
+                        return true;
+                    }
+                    MulMod(y, y, krok, N);
+                }
+            }
+        }
+    }
+    statystyki_etapu.redukty = 0;
+    statystyki.dodaj(statystyki_etapu);
+    return false;
+}
+
+#endif
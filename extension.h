@@ -0,0 +1,206 @@
+#ifndef WIENER_EXTENSION_H
+#define WIENER_EXTENSION_H
+
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include "attack.h"
+#include "thread_pool.h"
+
+// Rozszerzenie Verheula i van Tilborga: gdy d jest o kilka bitow wieksze od
+// N^(1/4), k/d nie jest reduktem, ale k = r P_{i+1} +- s P_i,
+// d = r Q_{i+1} +- s Q_i dla malych r, s i reduktow z okolic granicy Wienera.
+// Przestrzen (i, r, s) dzielona jest miedzy watki zadaniami (i, r); wszystkie
+// watki koncza prace, gdy ktorys znajdzie d. Kandydaci sprawdzani sa tak samo
+// jak redukty w ataku podstawowym (sprawdz_redukt).
+
+
+inline long nwd(long a, long b)
+{
+    while (b != 0)
+    {
+        long t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+
+// Redukty e/N do pierwszego z Q > D_max oraz indeksy i par (i, i + 1) z
+// Q_{i+1} > D i Q_i <= D_max, gdzie D = floor(N^(1/4) / 3), D_max = D * 2^bity.
+// Kandydaci musza miec d > D; mniejsze d sa reduktami i sprawdzil je juz atak
+// podstawowy.
+template <class Liczba>
+void pary_reduktow(const Liczba& e, const Liczba& N, long bity, Liczba& D, Liczba& D_max,
+                   vector<Liczba>& P, vector<Liczba>& Q, vector<long>& pary)
+{
+    SqrRoot(D, N);
+    SqrRoot(D, D);
+    div(D, D, 3);
+    LeftShift(D_max, D, bity);
+
+    GeneratorReduktow<Liczba, RozwiniecieLehmera<Liczba> > generator(e, N);
+    while (generator.nastepny())
+    {
+        P.push_back(generator.k());
+        Q.push_back(generator.d());
+        if (D_max < generator.d())
+        {
+            break;
+        }
+    }
+    for (long i = 0; i + 1 < (long)Q.size(); i++)
+    {
+        if (D < Q[i + 1] && !(D_max < Q[i]))
+        {
+            pary.push_back(i);
+        }
+    }
+}
+
+
+// Stan roboczy jednego watku
+template <class Liczba>
+struct RoboczeRozszerzenia
+{
+    ZmienneRobocze<Liczba> z;
+    Liczba k, d, q;
+    StatystykiAtaku statystyki;
+    long kroki;   // kroki s od ostatniego zgloszenia do budzetu (TerminAtaku)
+
+    RoboczeRozszerzenia() : kroki(0) {}
+};
+
+
+// Zwraca true i ustawia q oraz d, gdy ktorys kandydat daje rozklad N
+template <class Liczba>
+bool atak_verheula_van_tilborga(const Liczba& e, const Liczba& N, Liczba& q, Liczba& d,
+                                const UstawieniaAtaku& ustawienia, StatystykiAtaku& statystyki)
+{
+    const long bity = ustawienia.rozszerzenie.bity;
+    const long R = 1L << bity;
+
+    Liczba D, D_max;
+    vector<Liczba> P, Q;
+    vector<long> pary;
+    pary_reduktow(e, N, bity, D, D_max, P, Q, pary);
+
+    // Zadanie (i, r) ma numer (r - 1) * liczba par + numer pary, wiec
+    // najpierw sprawdzane sa najmniejsze r. Z czesci > 1 sprawdzane sa tylko
+    // zadania czesci (co czesci-te), a po wznowieniu zadania przed
+    // postep->poczatek sa pomijane.
+    long liczba_par = pary.size();
+    long liczba_zadan = liczba_par * (R - 1);
+    const RozszerzenieAtaku& rozszerzenie = ustawienia.rozszerzenie;
+    PostepRozszerzenia* postep = rozszerzenie.postep;
+    long poczatek = postep && postep->poczatek < liczba_zadan ? postep->poczatek : 0;
+    long pierwsze = poczatek + ((rozszerzenie.czesc - poczatek) % rozszerzenie.czesci + rozszerzenie.czesci)
+                    % rozszerzenie.czesci;
+    vector<long> kolejnosc;
+    kolejnosc.reserve(liczba_zadan > pierwsze ? (liczba_zadan - pierwsze) / rozszerzenie.czesci + 1 : 0);
+    for (long zadanie = pierwsze; zadanie < liczba_zadan; zadanie += rozszerzenie.czesci)
+    {
+        kolejnosc.push_back(zadanie);
+    }
+    // Zadania koncza sie w dowolnej kolejnosci; postep to pierwsze zadanie
+    // po najdluzszym sprawdzonym poczatku kolejnosci
+    vector<char> sprawdzone(postep ? kolejnosc.size() : 0);
+    std::mutex blokada_postepu;
+    long wykonane = 0;
+    if (postep)
+    {
+        postep->wykonane.store(kolejnosc.empty() ? liczba_zadan : pierwsze);
+    }
+
+    long watki = liczba_watkow_roboczych(ustawienia.rozszerzenie.watki);
+    vector<RoboczeRozszerzenia<Liczba> > robocze(watki);
+    std::atomic<bool> znaleziono(false);
+    std::atomic<bool> koniec(false);    // znaleziono d lub wyczerpano budzet, reszta zadan pomijana
+    long zwyciezca = -1;
+
+    const std::atomic<bool>* przerwij = rozszerzenie.przerwij ? rozszerzenie.przerwij : &znaleziono;
+    TerminAtaku* termin = ustawienia.termin;
+    wykonaj_rownolegle(kolejnosc, watki, [&](long zadanie, long nr_watku) {
+        if (znaleziono.load(std::memory_order_relaxed) || przerwij->load(std::memory_order_relaxed)
+            || po_terminie(termin))
+        {
+            return;
+        }
+        RoboczeRozszerzenia<Liczba>& w = robocze[nr_watku];
+        long i = pary[zadanie % liczba_par];
+        long r = zadanie / liczba_par + 1;
+
+        for (int znak = 1; znak >= -1; znak -= 2)
+        {
+            mul(w.k, P[i + 1], r);
+            mul(w.d, Q[i + 1], r);
+            for (long s = 1; s < R && !znaleziono.load(std::memory_order_relaxed)
+                             && !przerwij->load(std::memory_order_relaxed); s++)
+            {
+                // Zadanie przerwane po terminie nie trafia do postepu
+                if (termin && ++w.kroki % KROK_BUDZETU == 0 && termin->dolicz(KROK_BUDZETU, true, i, NumBits(w.d)))
+                {
+                    koniec.store(true);
+                    return;
+                }
+                if (znak > 0)
+                {
+                    add(w.k, w.k, P[i]);
+                    add(w.d, w.d, Q[i]);
+                }
+                else
+                {
+                    sub(w.k, w.k, P[i]);
+                    sub(w.d, w.d, Q[i]);
+                    if (sign(w.k) <= 0 || !(D < w.d))
+                    {
+                        break;
+                    }
+                }
+                // Dla nwd(r, s) = g > 1 k i d dziela sie przez g, a e*d - k*phi = 1
+                if (nwd(r, s) != 1 || (znak > 0 && !(D < w.d)))
+                {
+                    continue;
+                }
+                w.statystyki.kandydaci_rozszerzenia++;
+                if (sprawdz_redukt(e, N, w.k, w.d, w.q, w.z, ustawienia.filtry, w.statystyki))
+                {
+                    bool oczekiwane = false;
+                    if (znaleziono.compare_exchange_strong(oczekiwane, true))
+                    {
+                        zwyciezca = nr_watku;
+                    }
+                    koniec.store(true);
+                    return;
+                }
+            }
+        }
+        if (postep)
+        {
+            std::lock_guard<std::mutex> blokada(blokada_postepu);
+            sprawdzone[(zadanie - pierwsze) / rozszerzenie.czesci] = 1;
+            while (wykonane < (long)kolejnosc.size() && sprawdzone[wykonane])
+            {
+                wykonane++;
+            }
+            postep->wykonane.store(wykonane < (long)kolejnosc.size() ? kolejnosc[wykonane] : liczba_zadan);
+        }
+    }, &koniec);
+
+    for (long t = 0; t < watki; t++)
+    {
+        // Redukty sprawdzone w tym etapie liczone sa jako kandydaci
+        robocze[t].statystyki.redukty = 0;
+        statystyki.dodaj(robocze[t].statystyki);
+    }
+    if (zwyciezca < 0)
+    {
+        return false;
+    }
+    q = robocze[zwyciezca].q;
+    d = robocze[zwyciezca].d;
+    return true;
+}
+
+#endif
@@ -0,0 +1,867 @@
+#ifndef WIENER_FIXED_BACKEND_H
+#define WIENER_FIXED_BACKEND_H
+
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <NTL/ZZ.h>
+
+// Liczba calkowita stalej szerokosci: do SLOWA 64-bitowych slow w tablicy
+// w obiekcie, znak i wartosc bezwzgledna osobno. Nie alokuje pamieci, wiec
+// zmienne ataku na stosie i w kontekscie nie maja zadnych kosztow sterty.
+// Interfejs procedur jak w NTL (DivRem, MulAddTo, divide, SqrRoot, ...), tak
+// jak LiczbaGMP. Wynik musi zmiescic sie w SLOWA slowach; atak dobiera
+// szerokosc do dlugosci modulu (attack.cpp), z zapasem na iloczyny e*d i s^2.
+
+typedef unsigned long long Slowo;
+typedef unsigned __int128 SlowoPodwojne;
+
+
+// Operacje na wartosciach bezwzglednych: tablice slow od najmlodszego,
+// dlugosc bez zer wiodacych
+
+inline long slowa_normalizuj(const Slowo* a, long n)
+{
+    while (n > 0 && a[n - 1] == 0)
+    {
+        n--;
+    }
+    return n;
+}
+
+inline int slowa_porownaj(const Slowo* a, long na, const Slowo* b, long nb)
+{
+    if (na != nb)
+    {
+        return na < nb ? -1 : 1;
+    }
+    for (long i = na - 1; i >= 0; i--)
+    {
+        if (a[i] != b[i])
+        {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// (wysokie * 2^64 + niskie) / d dla wysokie < d, jedna instrukcja divq na x86-64
+inline Slowo dziel_podwojne(Slowo wysokie, Slowo niskie, Slowo d, Slowo& reszta)
+{
+#if defined(__x86_64__)
+    Slowo iloraz;
+    __asm__("divq %4" : "=a"(iloraz), "=d"(reszta) : "a"(niskie), "d"(wysokie), "rm"(d));
+    return iloraz;
+#else
+    SlowoPodwojne t = (SlowoPodwojne)wysokie << 64 | niskie;
+    reszta = (Slowo)(t % d);
+    return (Slowo)(t / d);
+#endif
+}
+
+// Odwrotnosc znormalizowanego d (najstarszy bit ustawiony):
+// floor((2^128 - 1) / d) - 2^64
+inline Slowo odwrotnosc(Slowo d)
+{
+    Slowo reszta;
+    return dziel_podwojne(~d, ~(Slowo)0, d, reszta);
+}
+
+// (wysokie * 2^64 + niskie) / d dla wysokie < d i d znormalizowanego, dwoma
+// mnozeniami przez odwrotnosc zamiast divq (Moller, Granlund 2011, alg. 4)
+inline Slowo dziel_odwrotnoscia(Slowo wysokie, Slowo niskie, Slowo d, Slowo odwrotnosc_d, Slowo& reszta)
+{
+    SlowoPodwojne q = (SlowoPodwojne)odwrotnosc_d * wysokie + ((SlowoPodwojne)wysokie << 64 | niskie);
+    Slowo q1 = (Slowo)(q >> 64) + 1;
+    Slowo q0 = (Slowo)q;
+    Slowo r = niskie - q1 * d;
+    if (r > q0)
+    {
+        q1--;
+        r += d;
+    }
+    if (r >= d)
+    {
+        q1++;
+        r -= d;
+    }
+    reszta = r;
+    return q1;
+}
+
+// x = a + b i x = a - b na n > 0 slowach, zwracaja przeniesienie (pozyczke).
+// Na x86-64 petla adc/sbb: lea i dec nie zmieniaja flagi przeniesienia.
+inline Slowo dodaj_n(Slowo* x, const Slowo* a, const Slowo* b, long n)
+{
+#if defined(__x86_64__)
+    Slowo t, przeniesienie;
+    __asm__ volatile("clc\n"
+                     "1:\n\t"
+                     "movq (%[a]), %[t]\n\t"
+                     "adcq (%[b]), %[t]\n\t"
+                     "movq %[t], (%[x])\n\t"
+                     "leaq 8(%[a]), %[a]\n\t"
+                     "leaq 8(%[b]), %[b]\n\t"
+                     "leaq 8(%[x]), %[x]\n\t"
+                     "decq %[n]\n\t"
+                     "jnz 1b\n\t"
+                     "sbbq %[c], %[c]\n\t"
+                     "negq %[c]"
+                     : [a] "+r"(a), [b] "+r"(b), [x] "+r"(x), [n] "+r"(n), [t] "=&r"(t), [c] "=r"(przeniesienie)
+                     :
+                     : "memory", "cc");
+    return przeniesienie;
+#else
+    Slowo przeniesienie = 0;
+    for (long i = 0; i < n; i++)
+    {
+        SlowoPodwojne s = (SlowoPodwojne)a[i] + b[i] + przeniesienie;
+        x[i] = (Slowo)s;
+        przeniesienie = (Slowo)(s >> 64);
+    }
+    return przeniesienie;
+#endif
+}
+
+inline Slowo odejmij_n(Slowo* x, const Slowo* a, const Slowo* b, long n)
+{
+#if defined(__x86_64__)
+    Slowo t, pozyczka;
+    __asm__ volatile("clc\n"
+                     "1:\n\t"
+                     "movq (%[a]), %[t]\n\t"
+                     "sbbq (%[b]), %[t]\n\t"
+                     "movq %[t], (%[x])\n\t"
+                     "leaq 8(%[a]), %[a]\n\t"
+                     "leaq 8(%[b]), %[b]\n\t"
+                     "leaq 8(%[x]), %[x]\n\t"
+                     "decq %[n]\n\t"
+                     "jnz 1b\n\t"
+                     "sbbq %[c], %[c]\n\t"
+                     "negq %[c]"
+                     : [a] "+r"(a), [b] "+r"(b), [x] "+r"(x), [n] "+r"(n), [t] "=&r"(t), [c] "=r"(pozyczka)
+                     :
+                     : "memory", "cc");
+    return pozyczka;
+#else
+    Slowo pozyczka = 0;
+    for (long i = 0; i < n; i++)
+    {
+        SlowoPodwojne r = (SlowoPodwojne)a[i] - b[i] - pozyczka;
+        x[i] = (Slowo)r;
+        pozyczka = (Slowo)(r >> 64) & 1;
+    }
+    return pozyczka;
+#endif
+}
+
+// x = a + b dla na >= nb; x moze byc a lub b
+inline long slowa_dodaj(Slowo* x, const Slowo* a, long na, const Slowo* b, long nb)
+{
+    Slowo przeniesienie = nb > 0 ? dodaj_n(x, a, b, nb) : 0;
+    long i = nb;
+    for (; i < na; i++)
+    {
+        x[i] = a[i] + przeniesienie;
+        przeniesienie = x[i] < przeniesienie;
+    }
+    if (przeniesienie)
+    {
+        x[i++] = 1;
+    }
+    return i;
+}
+
+// x = a - b dla |a| >= |b|; x moze byc a lub b
+inline long slowa_odejmij(Slowo* x, const Slowo* a, long na, const Slowo* b, long nb)
+{
+    Slowo pozyczka = nb > 0 ? odejmij_n(x, a, b, nb) : 0;
+    for (long i = nb; i < na; i++)
+    {
+        Slowo slowo = a[i];
+        x[i] = slowo - pozyczka;
+        pozyczka = slowo < pozyczka;
+    }
+    return slowa_normalizuj(x, na);
+}
+
+// x[0..n) -= a[0..n) * s, zwraca slowo do odjecia od x[n]
+inline Slowo odejmij_iloczyn(Slowo* x, const Slowo* a, long n, Slowo s)
+{
+    Slowo przeniesienie = 0;
+    for (long i = 0; i < n; i++)
+    {
+        SlowoPodwojne p = (SlowoPodwojne)a[i] * s + przeniesienie;
+        Slowo niskie = (Slowo)p, slowo = x[i];
+        x[i] = slowo - niskie;
+        przeniesienie = (Slowo)(p >> 64) + (slowo < niskie);
+    }
+    return przeniesienie;
+}
+
+// x = x + a * s (x ma nx slow); x moze byc a
+inline long slowa_dodaj_iloczyn(Slowo* x, long nx, const Slowo* a, long na, Slowo s)
+{
+    Slowo przeniesienie = 0;
+    for (long i = 0; i < na; i++)
+    {
+        SlowoPodwojne t = (SlowoPodwojne)a[i] * s + (i < nx ? x[i] : 0) + przeniesienie;
+        x[i] = (Slowo)t;
+        przeniesienie = (Slowo)(t >> 64);
+    }
+    long n = na > nx ? na : nx;
+    for (long i = na; przeniesienie && i < nx; i++)
+    {
+        SlowoPodwojne t = (SlowoPodwojne)x[i] + przeniesienie;
+        x[i] = (Slowo)t;
+        przeniesienie = (Slowo)(t >> 64);
+    }
+    if (przeniesienie)
+    {
+        x[n++] = przeniesienie;
+    }
+    return slowa_normalizuj(x, n);
+}
+
+// x = a * b szkolnie; x nie moze byc a ani b
+inline long slowa_mnoz(Slowo* x, const Slowo* a, long na, const Slowo* b, long nb)
+{
+    if (na == 0 || nb == 0)
+    {
+        return 0;
+    }
+    for (long i = 0; i < na; i++)
+    {
+        x[i] = 0;
+    }
+    for (long j = 0; j < nb; j++)
+    {
+        Slowo przeniesienie = 0;
+        for (long i = 0; i < na; i++)
+        {
+            SlowoPodwojne t = (SlowoPodwojne)a[i] * b[j] + x[i + j] + przeniesienie;
+            x[i + j] = (Slowo)t;
+            przeniesienie = (Slowo)(t >> 64);
+        }
+        x[j + na] = przeniesienie;
+    }
+    return slowa_normalizuj(x, na + nb);
+}
+
+// x = a * 2^n; x moze byc a
+inline long slowa_w_lewo(Slowo* x, const Slowo* a, long na, long n)
+{
+    if (na == 0)
+    {
+        return 0;
+    }
+    long s = n / 64, b = n % 64;
+    long nx = na + s;
+    if (b == 0)
+    {
+        for (long i = na - 1; i >= 0; i--)
+        {
+            x[i + s] = a[i];
+        }
+    }
+    else
+    {
+        x[na + s] = a[na - 1] >> (64 - b);
+        for (long i = na - 1; i > 0; i--)
+        {
+            x[i + s] = a[i] << b | a[i - 1] >> (64 - b);
+        }
+        x[s] = a[0] << b;
+        nx++;
+    }
+    for (long i = 0; i < s; i++)
+    {
+        x[i] = 0;
+    }
+    return slowa_normalizuj(x, nx);
+}
+
+// x = floor(a / 2^n); x moze byc a
+inline long slowa_w_prawo(Slowo* x, const Slowo* a, long na, long n)
+{
+    long s = n / 64, b = n % 64;
+    if (s >= na)
+    {
+        return 0;
+    }
+    long nx = na - s;
+    if (b == 0)
+    {
+        for (long i = 0; i < nx; i++)
+        {
+            x[i] = a[i + s];
+        }
+    }
+    else
+    {
+        for (long i = 0; i < nx - 1; i++)
+        {
+            x[i] = a[i + s] >> b | a[i + s + 1] << (64 - b);
+        }
+        x[nx - 1] = a[na - 1] >> b;
+    }
+    return slowa_normalizuj(x, nx);
+}
+
+// q = a / s, zwraca a mod s; q moze byc a
+inline Slowo slowa_dziel_slowo(Slowo* q, long& nq, const Slowo* a, long na, Slowo s)
+{
+    Slowo reszta = 0;
+    for (long i = na - 1; i >= 0; i--)
+    {
+        q[i] = dziel_podwojne(reszta, a[i], s, reszta);
+    }
+    nq = slowa_normalizuj(q, na);
+    return reszta;
+}
+
+
+template <long SLOWA>
+class LiczbaStala
+{
+public:
+    Slowo w[SLOWA];
+    long n;         // liczba uzywanych slow, w[n - 1] != 0
+    bool ujemna;
+
+    LiczbaStala() : n(0), ujemna(false) {}
+    LiczbaStala(const LiczbaStala& a) { kopiuj(a); }
+
+    LiczbaStala& operator=(const LiczbaStala& a)
+    {
+        if (this != &a)
+        {
+            kopiuj(a);
+        }
+        return *this;
+    }
+
+    LiczbaStala& operator=(long a)
+    {
+        ujemna = a < 0;
+        w[0] = ujemna ? -(Slowo)a : (Slowo)a;
+        n = w[0] != 0;
+        return *this;
+    }
+
+    // Dlugosc po zapisaniu slow wyniku; zero nie ma znaku
+    void ustaw(long dlugosc, bool znak)
+    {
+        n = dlugosc;
+        ujemna = znak && n > 0;
+    }
+
+private:
+    void kopiuj(const LiczbaStala& a)
+    {
+        n = a.n;
+        ujemna = a.ujemna;
+        std::memcpy(w, a.w, n * sizeof(Slowo));
+    }
+};
+
+
+// Dzielenie wartosci bezwzglednych z reszta (Knuth, TAOCP 4.3.1, algorytm D);
+// q i r nie moga byc a ani b
+template <long SLOWA>
+void slowa_dziel(LiczbaStala<SLOWA>& q, LiczbaStala<SLOWA>& r, const LiczbaStala<SLOWA>& a,
+                 const LiczbaStala<SLOWA>& b)
+{
+    long na = a.n, nb = b.n;
+    if (na < nb)
+    {
+        q.ustaw(0, false);
+        r = a;
+        r.ujemna = false;
+        return;
+    }
+    if (nb == 1)
+    {
+        long nq;
+        r.w[0] = slowa_dziel_slowo(q.w, nq, a.w, na, b.w[0]);
+        q.ustaw(nq, false);
+        r.ustaw(r.w[0] != 0, false);
+        return;
+    }
+    if (na == nb)
+    {
+        // Wyrazy rozwiniecia to zwykle 1, 2 lub 3: kilka odejmowan zamiast
+        // normalizacji algorytmu D
+        if (slowa_porownaj(a.w, na, b.w, nb) < 0)
+        {
+            q.ustaw(0, false);
+            r = a;
+            r.ujemna = false;
+            return;
+        }
+        long nr = slowa_odejmij(r.w, a.w, na, b.w, nb);
+        Slowo iloraz = 1;
+        while (iloraz < 4 && slowa_porownaj(r.w, nr, b.w, nb) >= 0)
+        {
+            nr = slowa_odejmij(r.w, r.w, nr, b.w, nb);
+            iloraz++;
+        }
+        if (slowa_porownaj(r.w, nr, b.w, nb) < 0)
+        {
+            q.w[0] = iloraz;
+            q.ustaw(1, false);
+            r.ustaw(nr, false);
+            return;
+        }
+    }
+
+    // Normalizacja: najstarszy bit dzielnika ustawiony
+    Slowo u[SLOWA + 1], v[SLOWA];
+    int s = __builtin_clzll(b.w[nb - 1]);
+    slowa_w_lewo(v, b.w, nb, s);
+    u[na] = 0;
+    slowa_w_lewo(u, a.w, na, s);
+    Slowo v1 = v[nb - 1], v2 = v[nb - 2];
+    Slowo odwrotnosc_v1 = odwrotnosc(v1);
+
+    for (long j = na - nb; j >= 0; j--)
+    {
+        // Przyblizenie ilorazu z dwoch najstarszych slow, poprawiane trzecim
+        Slowo qhat, rhat;
+        bool rhat_przepelniony = false;
+        if (u[j + nb] >= v1)
+        {
+            qhat = ~(Slowo)0;
+            SlowoPodwojne t = (SlowoPodwojne)u[j + nb - 1] + v1;
+            rhat = (Slowo)t;
+            rhat_przepelniony = (t >> 64) != 0;
+        }
+        else
+        {
+            qhat = dziel_odwrotnoscia(u[j + nb], u[j + nb - 1], v1, odwrotnosc_v1, rhat);
+        }
+        while (!rhat_przepelniony && (SlowoPodwojne)qhat * v2 > ((SlowoPodwojne)rhat << 64 | u[j + nb - 2]))
+        {
+            qhat--;
+            SlowoPodwojne t = (SlowoPodwojne)rhat + v1;
+            rhat = (Slowo)t;
+            rhat_przepelniony = (t >> 64) != 0;
+        }
+
+        // u[j .. j + nb] -= qhat * v
+        Slowo przeniesienie = odejmij_iloczyn(u + j, v, nb, qhat);
+        Slowo gora = u[j + nb];
+        u[j + nb] = gora - przeniesienie;
+        if (gora < przeniesienie)
+        {
+            // qhat o jeden za duze: dodanie v z powrotem
+            qhat--;
+            u[j + nb] += dodaj_n(u + j, u + j, v, nb);
+        }
+        q.w[j] = qhat;
+    }
+    q.ustaw(slowa_normalizuj(q.w, na - nb + 1), false);
+    r.ustaw(slowa_w_prawo(r.w, u, slowa_normalizuj(u, nb), s), false);
+}
+
+
+// Zamiana przez bufor: rozwiniecia zamieniaja liczby po kazdym wyrazie, a
+// kopiowanie blokami jest tu znacznie szybsze niz petla po slowach
+template <long S> inline void swap(LiczbaStala<S>& a, LiczbaStala<S>& b)
+{
+    Slowo t[S];
+    std::memcpy(t, a.w, a.n * sizeof(Slowo));
+    std::memcpy(a.w, b.w, b.n * sizeof(Slowo));
+    std::memcpy(b.w, t, a.n * sizeof(Slowo));
+    std::swap(a.n, b.n);
+    std::swap(a.ujemna, b.ujemna);
+}
+
+// Przesuniecie reszt Euklidesa (continued_fraction.h): dwie kopie zamiast
+// dwoch zamian, r i tak zostanie nadpisane
+template <long S> inline void przesun_reszty(LiczbaStala<S>& u, LiczbaStala<S>& v, LiczbaStala<S>& r)
+{
+    u = v;
+    v = r;
+}
+
+template <long S> inline void MulAddTo(LiczbaStala<S>& x, const LiczbaStala<S>& a, const LiczbaStala<S>& b);
+
+// (P, P_1) = (q P + P_1, P) w jednym przejsciu po slowach dla wyrazu w slowie
+template <long S> inline void dolacz_wyraz(LiczbaStala<S>& P, LiczbaStala<S>& P_1, const LiczbaStala<S>& q)
+{
+    if (q.n != 1 || q.ujemna || P.ujemna || P_1.ujemna || P_1.n > P.n)
+    {
+        swap(P, P_1);
+        MulAddTo(P, q, P_1);
+        return;
+    }
+    Slowo a = q.w[0], przeniesienie = 0;
+    long i = 0;
+    for (; i < P_1.n; i++)
+    {
+        Slowo p = P.w[i];
+        SlowoPodwojne t = (SlowoPodwojne)a * p + P_1.w[i] + przeniesienie;
+        P_1.w[i] = p;
+        P.w[i] = (Slowo)t;
+        przeniesienie = (Slowo)(t >> 64);
+    }
+    for (; i < P.n; i++)
+    {
+        Slowo p = P.w[i];
+        SlowoPodwojne t = (SlowoPodwojne)a * p + przeniesienie;
+        P_1.w[i] = p;
+        P.w[i] = (Slowo)t;
+        przeniesienie = (Slowo)(t >> 64);
+    }
+    if (przeniesienie)
+    {
+        P.w[i++] = przeniesienie;
+    }
+    P_1.n = P.n;
+    P.n = i;
+}
+
+template <long S> inline long IsZero(const LiczbaStala<S>& a) { return a.n == 0; }
+template <long S> inline long IsOdd(const LiczbaStala<S>& a) { return a.n > 0 && (a.w[0] & 1); }
+template <long S> inline long sign(const LiczbaStala<S>& a) { return a.n == 0 ? 0 : a.ujemna ? -1 : 1; }
+template <long S> inline long NumBits(const LiczbaStala<S>& a)
+{
+    return a.n == 0 ? 0 : 64 * a.n - __builtin_clzll(a.w[a.n - 1]);
+}
+
+template <long S> inline int porownaj(const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    if (a.ujemna != b.ujemna)
+    {
+        return a.ujemna ? -1 : 1;
+    }
+    int c = slowa_porownaj(a.w, a.n, b.w, b.n);
+    return a.ujemna ? -c : c;
+}
+template <long S> inline bool operator==(const LiczbaStala<S>& a, const LiczbaStala<S>& b) { return porownaj(a, b) == 0; }
+template <long S> inline bool operator!=(const LiczbaStala<S>& a, const LiczbaStala<S>& b) { return porownaj(a, b) != 0; }
+template <long S> inline bool operator<(const LiczbaStala<S>& a, const LiczbaStala<S>& b) { return porownaj(a, b) < 0; }
+
+// x = a + (-1)^b_ujemna |b|; x moze byc a, b moze byc slowami x
+template <long S>
+inline void dodaj_ze_znakiem(LiczbaStala<S>& x, const LiczbaStala<S>& a, const Slowo* b, long nb, bool b_ujemna)
+{
+    bool a_ujemna = a.ujemna;
+    if (a_ujemna == b_ujemna)
+    {
+        x.ustaw(a.n >= nb ? slowa_dodaj(x.w, a.w, a.n, b, nb) : slowa_dodaj(x.w, b, nb, a.w, a.n), a_ujemna);
+    }
+    else if (slowa_porownaj(a.w, a.n, b, nb) >= 0)
+    {
+        x.ustaw(slowa_odejmij(x.w, a.w, a.n, b, nb), a_ujemna);
+    }
+    else
+    {
+        x.ustaw(slowa_odejmij(x.w, b, nb, a.w, a.n), b_ujemna);
+    }
+}
+
+template <long S> inline void add(LiczbaStala<S>& x, const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    dodaj_ze_znakiem(x, a, b.w, b.n, b.ujemna);
+}
+template <long S> inline void add(LiczbaStala<S>& x, const LiczbaStala<S>& a, long b)
+{
+    Slowo m = b < 0 ? -(Slowo)b : (Slowo)b;
+    dodaj_ze_znakiem(x, a, &m, m != 0, b < 0);
+}
+template <long S> inline void sub(LiczbaStala<S>& x, const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    dodaj_ze_znakiem(x, a, b.w, b.n, !b.ujemna);
+}
+template <long S> inline void sub(LiczbaStala<S>& x, const LiczbaStala<S>& a, long b)
+{
+    Slowo m = b < 0 ? -(Slowo)b : (Slowo)b;
+    dodaj_ze_znakiem(x, a, &m, m != 0, b > 0);
+}
+template <long S> inline void negate(LiczbaStala<S>& x, const LiczbaStala<S>& a)
+{
+    x = a;
+    x.ustaw(x.n, !a.ujemna);
+}
+
+template <long S> inline void mul(LiczbaStala<S>& x, const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    bool znak = a.ujemna != b.ujemna;
+    if (&x == &a || &x == &b)
+    {
+        LiczbaStala<S> t;
+        t.ustaw(slowa_mnoz(t.w, a.w, a.n, b.w, b.n), znak);
+        x = t;
+        return;
+    }
+    x.ustaw(slowa_mnoz(x.w, a.w, a.n, b.w, b.n), znak);
+}
+template <long S> inline void mul(LiczbaStala<S>& x, const LiczbaStala<S>& a, long b)
+{
+    bool znak = a.ujemna != (b < 0);
+    x.ustaw(slowa_dodaj_iloczyn(x.w, 0, a.w, a.n, b < 0 ? -(Slowo)b : (Slowo)b), znak);
+}
+template <long S> inline void sqr(LiczbaStala<S>& x, const LiczbaStala<S>& a) { mul(x, a, a); }
+
+// x += a b; wyrazy rozwiniecia mieszcza sie zwykle w jednym slowie i wtedy
+// iloczyn dodawany jest w miejscu
+template <long S> inline void MulAddTo(LiczbaStala<S>& x, const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    if (!x.ujemna && !a.ujemna && !b.ujemna && &x != &a && &x != &b && (a.n <= 1 || b.n <= 1))
+    {
+        if (a.n > 0 && b.n > 0)
+        {
+            x.n = a.n == 1 ? slowa_dodaj_iloczyn(x.w, x.n, b.w, b.n, a.w[0])
+                           : slowa_dodaj_iloczyn(x.w, x.n, a.w, a.n, b.w[0]);
+        }
+        return;
+    }
+    LiczbaStala<S> t;
+    mul(t, a, b);
+    add(x, x, t);
+}
+template <long S> inline void MulAddTo(LiczbaStala<S>& x, const LiczbaStala<S>& a, long b)
+{
+    if (!x.ujemna && !a.ujemna && b >= 0 && &x != &a)
+    {
+        x.n = slowa_dodaj_iloczyn(x.w, x.n, a.w, a.n, (Slowo)b);
+        return;
+    }
+    LiczbaStala<S> t;
+    mul(t, a, b);
+    add(x, x, t);
+}
+template <long S> inline void MulSubFrom(LiczbaStala<S>& x, const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    LiczbaStala<S> t;
+    mul(t, a, b);
+    sub(x, x, t);
+}
+
+template <long S> inline void LeftShift(LiczbaStala<S>& x, const LiczbaStala<S>& a, long n)
+{
+    bool znak = a.ujemna;
+    x.ustaw(slowa_w_lewo(x.w, a.w, a.n, n), znak);
+}
+// Dla liczb nieujemnych floor(a / 2^n)
+template <long S> inline void RightShift(LiczbaStala<S>& x, const LiczbaStala<S>& a, long n)
+{
+    bool znak = a.ujemna;
+    x.ustaw(slowa_w_prawo(x.w, a.w, a.n, n), znak);
+}
+
+// Dzielenie z reszta dla liczb nieujemnych
+template <long S>
+inline void DivRem(LiczbaStala<S>& q, LiczbaStala<S>& r, const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    if (&q == &a || &q == &b || &r == &a || &r == &b)
+    {
+        LiczbaStala<S> tq, tr;
+        slowa_dziel(tq, tr, a, b);
+        q = tq;
+        r = tr;
+        return;
+    }
+    slowa_dziel(q, r, a, b);
+}
+
+// Czy |b| dzieli |a|; jesli tak, q = |a| / |b|. Dzielenie dokladne Hensela:
+// kolejne najmlodsze slowa a zerowane sa wielokrotnoscia b (iloraz slowa to
+// a_i b^-1 mod 2^64), bez normalizacji i poprawiania ilorazow algorytmu D.
+// q nie moze byc a ani b.
+template <long S>
+bool slowa_dziel_dokladnie(LiczbaStala<S>& q, const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    if (a.n == 0)
+    {
+        q = 0;
+        return true;
+    }
+    if (a.n < b.n)
+    {
+        return false;
+    }
+    // Wspolna potega dwojki; b po niej nieparzyste
+    long zera_b = 0, zera_a = 0;
+    while (b.w[zera_b / 64] == 0)
+    {
+        zera_b += 64;
+    }
+    zera_b += __builtin_ctzll(b.w[zera_b / 64]);
+    while (a.w[zera_a / 64] == 0)
+    {
+        zera_a += 64;
+    }
+    zera_a += __builtin_ctzll(a.w[zera_a / 64]);
+    if (zera_a < zera_b)
+    {
+        return false;
+    }
+    Slowo u[S], v[S];
+    long nu = slowa_w_prawo(u, a.w, a.n, zera_b);
+    long nv = slowa_w_prawo(v, b.w, b.n, zera_b);
+    if (nu < nv)
+    {
+        return false;
+    }
+
+    // v^-1 mod 2^64 metoda Newtona: v v = 1 mod 8, kazdy krok podwaja liczbe bitow
+    Slowo odwrotnosc_v = v[0];
+    for (int i = 0; i < 5; i++)
+    {
+        odwrotnosc_v *= 2 - v[0] * odwrotnosc_v;
+    }
+
+    long nq = nu - nv + 1;
+    for (long i = 0; i < nq; i++)
+    {
+        Slowo qi = u[i] * odwrotnosc_v;
+        Slowo pozyczka = odejmij_iloczyn(u + i, v, nv, qi);
+        for (long k = i + nv; pozyczka && k < nu; k++)
+        {
+            Slowo slowo = u[k];
+            u[k] = slowo - pozyczka;
+            pozyczka = slowo < pozyczka;
+        }
+        // Czesciowy iloraz razy b nie przekracza a, gdy b dzieli a
+        if (pozyczka)
+        {
+            return false;
+        }
+        q.w[i] = qi;
+    }
+    for (long k = nq; k < nu; k++)
+    {
+        if (u[k] != 0)
+        {
+            return false;
+        }
+    }
+    q.ustaw(slowa_normalizuj(q.w, nq), false);
+    return true;
+}
+
+template <long S> inline long divide(const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    LiczbaStala<S> q;
+    return slowa_dziel_dokladnie(q, a, b);
+}
+template <long S> inline long divide(LiczbaStala<S>& q, const LiczbaStala<S>& a, const LiczbaStala<S>& b)
+{
+    LiczbaStala<S> t;
+    if (!slowa_dziel_dokladnie(t, a, b))
+    {
+        return 0;
+    }
+    t.ustaw(t.n, a.ujemna != b.ujemna);
+    q = t;
+    return 1;
+}
+
+template <long S> inline void div(LiczbaStala<S>& q, const LiczbaStala<S>& a, long b)
+{
+    long nq;
+    bool znak = a.ujemna;
+    slowa_dziel_slowo(q.w, nq, a.w, a.n, (Slowo)b);
+    q.ustaw(nq, znak);
+}
+template <long S> inline long rem(const LiczbaStala<S>& a, long b)
+{
+    Slowo reszta = 0;
+    for (long i = a.n - 1; i >= 0; i--)
+    {
+        dziel_podwojne(reszta, a.w[i], (Slowo)b, reszta);
+    }
+    return (long)reszta;
+}
+template <long S> inline long trunc_long(const LiczbaStala<S>& a, long k)
+{
+    Slowo slowo = a.n > 0 ? a.w[0] : 0;
+    return k < 64 ? (long)(slowo & ((1ULL << k) - 1)) : (long)slowo;
+}
+
+// floor(sqrt(a)) metoda Newtona. Start z pierwiastka w double z najstarszych
+// bitow a (z nadmiarem), wiec do zbieznosci wystarcza kilka iteracji. Jak
+// w NTL x moze byc tym samym obiektem co a.
+template <long S> inline void SqrRoot(LiczbaStala<S>& x, const LiczbaStala<S>& a_wej)
+{
+    if (a_wej.n == 0)
+    {
+        x = 0;
+        return;
+    }
+    // Petla nadpisuje x, wiec a jest kopiowane
+    const LiczbaStala<S> a = a_wej;
+    long bity = NumBits(a);
+    long przesuniecie = bity > 104 ? (bity - 104 + 1) & ~1L : 0;
+    LiczbaStala<S> y, iloraz, reszta;
+    RightShift(y, a, przesuniecie);
+    double gora = (double)y.w[0] + (y.n > 1 ? std::ldexp((double)y.w[1], 64) : 0.0);
+    Slowo przyblizenie = (Slowo)std::sqrt(gora) + 2;
+    y.w[0] = przyblizenie;
+    y.ustaw(1, false);
+    LeftShift(y, y, przesuniecie / 2);
+    do
+    {
+        x = y;
+        slowa_dziel(iloraz, reszta, a, x);
+        add(y, x, iloraz);
+        RightShift(y, y, 1);
+    } while (y < x);
+}
+
+template <long S> inline long pierwiastek_dokladny(LiczbaStala<S>& x, const LiczbaStala<S>& a, LiczbaStala<S>& tmp)
+{
+    SqrRoot(x, a);
+    sqr(tmp, x);
+    return tmp == a;
+}
+
+// Pamiec jest w obiekcie, wiec nie ma czego rezerwowac
+template <long S> inline void zarezerwuj(LiczbaStala<S>&, long) {}
+
+// Konwersje z i do NTL::ZZ przez bajty little-endian na stosie; a musi
+// miescic sie w SLOWA slowach
+template <long S> inline void conv(LiczbaStala<S>& x, const NTL::ZZ& a)
+{
+    unsigned char bajty[8 * S];
+    long n = (NTL::NumBytes(a) + 7) / 8;
+    NTL::BytesFromZZ(bajty, a, 8 * n);
+    for (long i = 0; i < n; i++)
+    {
+        Slowo slowo = 0;
+        for (int b = 7; b >= 0; b--)
+        {
+            slowo = slowo << 8 | bajty[8 * i + b];
+        }
+        x.w[i] = slowo;
+    }
+    x.ustaw(slowa_normalizuj(x.w, n), NTL::sign(a) < 0);
+}
+template <long S> inline void conv(NTL::ZZ& x, const LiczbaStala<S>& a)
+{
+    unsigned char bajty[8 * S];
+    for (long i = 0; i < a.n; i++)
+    {
+        for (int b = 0; b < 8; b++)
+        {
+            bajty[8 * i + b] = (unsigned char)(a.w[i] >> (8 * b));
+        }
+    }
+    NTL::ZZFromBytes(x, bajty, 8 * a.n);
+    if (a.ujemna)
+    {
+        NTL::negate(x, x);
+    }
+}
+
+template <long S> inline std::ostream& operator<<(std::ostream& s, const LiczbaStala<S>& a)
+{
+    NTL::ZZ x;
+    conv(x, a);
+    return s << x;
+}
+
+#endif
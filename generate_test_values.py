@@ -17,4 +17,4 @@ while (bin_size <= end_size):
             d = randint(2, wiener)
         e = inverse_mod(d, phiN)
         print("{}\t{}\t{}\t{}\t{}\t{}\t{}".format(bin_size, p, q, N, phiN, e, d))
-        bin_size *= 2
+    bin_size *= 2
@@ -0,0 +1,186 @@
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "generator.h"
+#include "corpus.h"
+#include "thread_pool.h"
+
+// Kluczy losowanych naraz na watek, zanim porcja trafi do pliku
+static const long PORCJA_NA_WATEK = 256;
+// Losowan d na pare p, q, zanim p i q sa losowane od nowa
+static const long PROBY_D = 64;
+
+
+// Losuje d odwracalne modulo phi(N) w co najwyzej PROBY_D probach; przy
+// malych modulach moze nie byc takiego d w przedziale, wtedy zwraca false
+static bool losuj_d(long bin_size, double ulamek_d, KluczGeneratora& wynik)
+{
+    KluczWsadu& klucz = wynik.klucz;
+    long bity_d = 0;
+    ZZ granica;
+    if (ulamek_d > 0)
+    {
+        bity_d = std::max(2L, std::min((long)std::floor(ulamek_d * bin_size + 0.5), NumBits(wynik.phiN) - 1));
+    }
+    else
+    {
+        SqrRoot(granica, klucz.N);
+        SqrRoot(granica, granica);
+        div(granica, granica, 3);
+    }
+    for (long proba = 0; proba < PROBY_D; proba++)
+    {
+        if (ulamek_d > 0)
+        {
+            RandomLen(klucz.d, bity_d);
+        }
+        else
+        {
+            // d z przedzialu [2, granica]
+            RandomBnd(klucz.d, granica - 1);
+            add(klucz.d, klucz.d, 2);
+        }
+        if (GCD(klucz.d, wynik.phiN) == 1)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+void generuj_klucz(long bin_size, double ulamek_d, bool kontrolny, KluczGeneratora& wynik)
+{
+    KluczWsadu& klucz = wynik.klucz;
+    klucz.bin_size = bin_size;
+    for (;;)
+    {
+        RandomPrime(wynik.p, bin_size / 2);
+        do
+        {
+            RandomPrime(wynik.q, bin_size / 2);
+        } while (wynik.p == wynik.q);
+        mul(klucz.N, wynik.p, wynik.q);
+        mul(wynik.phiN, wynik.p - 1, wynik.q - 1);
+        if (!kontrolny)
+        {
+            // Bez odwracalnego d losowane sa nowe p i q
+            if (losuj_d(bin_size, ulamek_d, wynik))
+            {
+                break;
+            }
+            continue;
+        }
+        // e = 65537 musi byc odwracalne modulo phi(N)
+        klucz.e = 65537;
+        if (InvModStatus(klucz.d, klucz.e, wynik.phiN) == 0)
+        {
+            return;
+        }
+    }
+    InvMod(klucz.e, klucz.d, wynik.phiN);
+}
+
+
+// Ziarno klucza: splitmix64 z (ziarno, bin_size, numer)
+static unsigned long long ziarno_klucza(unsigned long long ziarno, long bin_size, long numer)
+{
+    unsigned long long x = ziarno;
+    unsigned long long skladniki[2] = { (unsigned long long)bin_size, (unsigned long long)numer };
+    for (int i = 0; i < 2; i++)
+    {
+        x += 0x9e3779b97f4a7c15ULL + skladniki[i];
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+    }
+    return x;
+}
+
+
+int generuj_korpus(const std::string& sciezka, const UstawieniaGeneratora& ustawienia)
+{
+    std::ofstream tsv;
+    ZapisKorpusu korpus;
+    if (ustawienia.korpus)
+    {
+        if (!korpus.otworz(sciezka))
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        tsv.open(sciezka.c_str());
+        if (!tsv || !(tsv << "bin_size\tp\tq\tN\tphiN\te\td\n"))
+        {
+            std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+            return 1;
+        }
+    }
+
+    long na_rozmiar = ustawienia.podatne + ustawienia.kontrolne;
+    long wszystkie = na_rozmiar * ustawienia.rozmiary.size();
+    long watki = liczba_watkow_roboczych(ustawienia.watki);
+    long porcja = PORCJA_NA_WATEK * watki;
+    vector<KluczGeneratora> klucze(porcja);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for (long poczatek = 0; poczatek < wszystkie; poczatek += porcja)
+    {
+        vector<long> kolejnosc;
+        for (long g = poczatek; g < wszystkie && g < poczatek + porcja; g++)
+        {
+            kolejnosc.push_back(g - poczatek);
+        }
+        wykonaj_rownolegle(kolejnosc, watki, [&](long k, long) {
+            long g = poczatek + k;
+            long bin_size = ustawienia.rozmiary[g / na_rozmiar];
+            long numer = g % na_rozmiar;
+            ZZ ziarno;
+            conv(ziarno, (unsigned long)ziarno_klucza(ustawienia.ziarno, bin_size, numer));
+            SetSeed(ziarno);
+            generuj_klucz(bin_size, ustawienia.ulamek_d, numer >= ustawienia.podatne, klucze[k]);
+        });
+
+        for (size_t k = 0; k < kolejnosc.size(); k++)
+        {
+            const KluczGeneratora& klucz = klucze[k];
+            bool zapisany;
+            if (ustawienia.korpus)
+            {
+                zapisany = korpus.dodaj(klucz.klucz);
+            }
+            else
+            {
+                zapisany = (bool)(tsv << klucz.klucz.bin_size << "\t" << klucz.p << "\t" << klucz.q << "\t"
+                                      << klucz.klucz.N << "\t" << klucz.phiN << "\t" << klucz.klucz.e << "\t"
+                                      << klucz.klucz.d << "\n");
+                if (!zapisany)
+                {
+                    std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+                }
+            }
+            if (!zapisany)
+            {
+                return 1;
+            }
+        }
+    }
+    if (!ustawienia.korpus && !tsv.flush())
+    {
+        std::cerr << "Nie mozna zapisac pliku " << sciezka << std::endl;
+        return 1;
+    }
+    if (ustawienia.korpus && !korpus.zamknij())
+    {
+        return 1;
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    long long czas_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    std::cout << "keys = " << wszystkie << " written to " << sciezka << " threads = " << watki
+              << " Time = " << czas_ns / 1000.0 << "[µs]"
+              << " throughput = " << (czas_ns > 0 ? wszystkie * 1e9 / czas_ns : 0.0) << "[keys/s]" << std::endl;
+    return 0;
+}
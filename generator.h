@@ -0,0 +1,50 @@
+#ifndef WIENER_GENERATOR_H
+#define WIENER_GENERATOR_H
+
+#include <string>
+#include <vector>
+#include "batch.h"
+
+// Generator korpusow testowych. Klucz podatny ma d z [2, floor(N^(1/4) / 3)]
+// jak w generate_test_values.py albo, z ulamek_d > 0, d o ulamek_d * bin_size
+// bitach (np. tuz nad granica Wienera dla etapu rozszerzonego). Klucz
+// kontrolny ma e = 65537 i pelnej dlugosci d, wiec atak nie powinien go
+// rozlozyc. Kazdy klucz losowany jest z wlasnego ziarna (ziarno, bin_size,
+// numer), wiec plik nie zalezy od liczby watkow.
+
+// Klucz z prawdziwym rozkladem do zapisu w formacie test_values.txt
+struct KluczGeneratora
+{
+    KluczWsadu klucz;
+    ZZ p, q, phiN;
+};
+
+struct UstawieniaGeneratora
+{
+    std::vector<long> rozmiary;  // bity modulow
+    long podatne;                // kluczy podatnych na rozmiar
+    long kontrolne;              // kluczy kontrolnych na rozmiar
+    double ulamek_d;             // bity d jako ulamek bin_size, 0 = granica Wienera
+    long watki;                  // 0 = wszystkie rdzenie
+    unsigned long ziarno;
+    bool korpus;                 // korpus binarny (corpus.h) zamiast test_values.txt
+
+    UstawieniaGeneratora() : podatne(100), kontrolne(0), ulamek_d(0), watki(0), ziarno(0), korpus(false)
+    {
+        for (long bity = 64; bity <= 8192; bity *= 2)
+        {
+            rozmiary.push_back(bity);
+        }
+    }
+};
+
+// Losuje jeden klucz z biezacego strumienia losowego NTL (SetSeed)
+void generuj_klucz(long bin_size, double ulamek_d, bool kontrolny, KluczGeneratora& klucz);
+
+// Zapisuje klucze wszystkich rozmiarow do pliku: kolejno rozmiary, w kazdym
+// najpierw podatne, potem kontrolne. Klucze losowane sa w wielu watkach
+// porcjami, a kazda porcja zapisywana w kolejnosci, wiec pamiec nie zalezy
+// od liczby kluczy.
+int generuj_korpus(const std::string& sciezka, const UstawieniaGeneratora& ustawienia);
+
+#endif
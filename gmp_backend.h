@@ -0,0 +1,164 @@
+#ifndef WIENER_GMP_BACKEND_H
+#define WIENER_GMP_BACKEND_H
+
+#include <gmp.h>
+#include <vector>
+#include <iostream>
+#include <NTL/ZZ.h>
+
+// Liczba calkowita GMP z interfejsem procedur NTL (DivRem, MulAddTo, divide,
+// SqrRoot, ...), dzieki czemu szablony ataku dzialaja na niej bez zmian.
+// Wszystkie operacje wykonywane sa w miejscu funkcjami mpz_*, bez obiektow
+// tymczasowych.
+class LiczbaGMP
+{
+public:
+    mpz_t m;
+
+    LiczbaGMP() { mpz_init(m); }
+    LiczbaGMP(const LiczbaGMP& a) { mpz_init_set(m, a.m); }
+    ~LiczbaGMP() { mpz_clear(m); }
+
+    LiczbaGMP& operator=(const LiczbaGMP& a) { mpz_set(m, a.m); return *this; }
+    LiczbaGMP& operator=(long a) { mpz_set_si(m, a); return *this; }
+};
+
+inline void swap(LiczbaGMP& a, LiczbaGMP& b) { mpz_swap(a.m, b.m); }
+
+inline long IsZero(const LiczbaGMP& a) { return mpz_sgn(a.m) == 0; }
+inline long IsOdd(const LiczbaGMP& a) { return mpz_odd_p(a.m); }
+inline long sign(const LiczbaGMP& a) { return mpz_sgn(a.m); }
+inline long NumBits(const LiczbaGMP& a) { return mpz_sgn(a.m) == 0 ? 0 : (long)mpz_sizeinbase(a.m, 2); }
+inline bool operator==(const LiczbaGMP& a, const LiczbaGMP& b) { return mpz_cmp(a.m, b.m) == 0; }
+inline bool operator!=(const LiczbaGMP& a, const LiczbaGMP& b) { return mpz_cmp(a.m, b.m) != 0; }
+inline bool operator<(const LiczbaGMP& a, const LiczbaGMP& b) { return mpz_cmp(a.m, b.m) < 0; }
+
+inline void add(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& b) { mpz_add(x.m, a.m, b.m); }
+inline void add(LiczbaGMP& x, const LiczbaGMP& a, long b)
+{
+    if (b >= 0) mpz_add_ui(x.m, a.m, b);
+    else mpz_sub_ui(x.m, a.m, -(unsigned long)b);
+}
+inline void sub(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& b) { mpz_sub(x.m, a.m, b.m); }
+inline void sub(LiczbaGMP& x, const LiczbaGMP& a, long b) { add(x, a, -b); }
+inline void negate(LiczbaGMP& x, const LiczbaGMP& a) { mpz_neg(x.m, a.m); }
+inline void mul(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& b) { mpz_mul(x.m, a.m, b.m); }
+inline void mul(LiczbaGMP& x, const LiczbaGMP& a, long b) { mpz_mul_si(x.m, a.m, b); }
+inline void sqr(LiczbaGMP& x, const LiczbaGMP& a) { mpz_mul(x.m, a.m, a.m); }
+inline void MulAddTo(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& b) { mpz_addmul(x.m, a.m, b.m); }
+inline void MulAddTo(LiczbaGMP& x, const LiczbaGMP& a, long b)
+{
+    if (b >= 0) mpz_addmul_ui(x.m, a.m, b);
+    else mpz_submul_ui(x.m, a.m, -(unsigned long)b);
+}
+inline void MulSubFrom(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& b) { mpz_submul(x.m, a.m, b.m); }
+inline void LeftShift(LiczbaGMP& x, const LiczbaGMP& a, long n) { mpz_mul_2exp(x.m, a.m, n); }
+inline void RightShift(LiczbaGMP& x, const LiczbaGMP& a, long n) { mpz_fdiv_q_2exp(x.m, a.m, n); }
+
+// Dzielenie z reszta dla liczb nieujemnych
+inline void DivRem(LiczbaGMP& q, LiczbaGMP& r, const LiczbaGMP& a, const LiczbaGMP& b) { mpz_tdiv_qr(q.m, r.m, a.m, b.m); }
+
+inline long divide(const LiczbaGMP& a, const LiczbaGMP& b) { return mpz_divisible_p(a.m, b.m); }
+inline long divide(LiczbaGMP& q, const LiczbaGMP& a, const LiczbaGMP& b)
+{
+    if (!mpz_divisible_p(a.m, b.m))
+    {
+        return 0;
+    }
+    mpz_divexact(q.m, a.m, b.m);
+    return 1;
+}
+
+inline void div(LiczbaGMP& q, const LiczbaGMP& a, long b) { mpz_fdiv_q_ui(q.m, a.m, b); }
+inline long rem(const LiczbaGMP& a, long b) { return (long)mpz_fdiv_ui(a.m, b); }
+inline long trunc_long(const LiczbaGMP& a, long k)
+{
+    unsigned long slowo = mpz_getlimbn(a.m, 0);
+    return k < (long)(8 * sizeof(long)) ? (long)(slowo & ((1UL << k) - 1)) : (long)slowo;
+}
+
+inline void SqrRoot(LiczbaGMP& x, const LiczbaGMP& a) { mpz_sqrt(x.m, a.m); }
+
+// Arytmetyka modulo n dla 0 <= a, b < n
+inline void MulMod(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& b, const LiczbaGMP& n)
+{
+    mpz_mul(x.m, a.m, b.m);
+    mpz_mod(x.m, x.m, n.m);
+}
+inline void PowerMod(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& e, const LiczbaGMP& n) { mpz_powm(x.m, a.m, e.m, n.m); }
+inline void InvMod(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& n) { mpz_invert(x.m, a.m, n.m); }
+// Jak NTL: 0 i x = a^(-1) mod n albo 1 i x = gcd(a, n), gdy odwrotnosci nie ma
+inline long InvModStatus(LiczbaGMP& x, const LiczbaGMP& a, const LiczbaGMP& n)
+{
+    if (mpz_invert(x.m, a.m, n.m))
+    {
+        return 0;
+    }
+    mpz_gcd(x.m, a.m, n.m);
+    return 1;
+}
+
+// Jesli a jest kwadratem liczby calkowitej, ustawia x = sqrt(a) i zwraca 1.
+// Pierwiastek liczony jest raz (mpz_sqrtrem); sito kwadratow sprawdza
+// wolajacy.
+inline long pierwiastek_dokladny(LiczbaGMP& x, const LiczbaGMP& a, LiczbaGMP& reszta)
+{
+    mpz_sqrtrem(x.m, reszta.m, a.m);
+    return mpz_sgn(reszta.m) == 0;
+}
+
+inline std::ostream& operator<<(std::ostream& s, const LiczbaGMP& a)
+{
+    std::vector<char> cyfry(mpz_sizeinbase(a.m, 10) + 2);
+    return s << mpz_get_str(cyfry.data(), 10, a.m);
+}
+
+// Rezerwuje miejsce na liczby do bity bitow; kolejne wartosci tej dlugosci nie
+// powiekszaja juz bufora
+inline void zarezerwuj(NTL::ZZ& x, long bity) { x.SetSize((bity + NTL_ZZ_NBITS - 1) / NTL_ZZ_NBITS); }
+inline void zarezerwuj(LiczbaGMP& x, long bity)
+{
+    if ((long)x.m->_mp_alloc * GMP_NUMB_BITS < bity)
+    {
+        mpz_realloc2(x.m, bity);
+    }
+}
+
+// Konwersje z i do NTL::ZZ przez zapis little-endian; wersje z buforem
+// ponownie uzywaja pamieci bufora
+inline void conv(LiczbaGMP& x, const NTL::ZZ& a, std::vector<unsigned char>& bajty)
+{
+    bajty.resize(NTL::NumBytes(a) + 1);
+    NTL::BytesFromZZ(bajty.data(), a, bajty.size());
+    mpz_import(x.m, bajty.size(), -1, 1, 0, 0, bajty.data());
+    if (NTL::sign(a) < 0)
+    {
+        mpz_neg(x.m, x.m);
+    }
+}
+
+inline void conv(NTL::ZZ& x, const LiczbaGMP& a, std::vector<unsigned char>& bajty)
+{
+    bajty.resize((mpz_sizeinbase(a.m, 2) + 7) / 8 + 1);
+    size_t dlugosc = 0;
+    mpz_export(bajty.data(), &dlugosc, -1, 1, 0, 0, a.m);
+    NTL::ZZFromBytes(x, bajty.data(), dlugosc);
+    if (mpz_sgn(a.m) < 0)
+    {
+        NTL::negate(x, x);
+    }
+}
+
+inline void conv(LiczbaGMP& x, const NTL::ZZ& a)
+{
+    std::vector<unsigned char> bajty;
+    conv(x, a, bajty);
+}
+
+inline void conv(NTL::ZZ& x, const LiczbaGMP& a)
+{
+    std::vector<unsigned char> bajty;
+    conv(x, a, bajty);
+}
+
+#endif
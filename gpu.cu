@@ -0,0 +1,362 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cuda_runtime.h>
+#include "gpu.h"
+#include "gpu_kernel.h"
+
+// Kluczy w porcji jednego strumienia; okna etapu rozszerzonego zajmuja
+// okolo 18 KB na klucz porcji
+static const long PORCJA_GPU = 4096;
+static const int WATKI_BLOKU = 128;
+static const int WARP = 32;
+// Najwiecej blokow jadra etapu rozszerzonego; bloki przechodza po zadaniach co tyle
+static const long long MAKS_BLOKOW = 1 << 20;
+
+__constant__ SitoGpu sito_gpu;
+
+
+// Jeden klucz na watek
+__global__ void jadro_podstawowe(const KluczGpu* klucze, WynikKluczaGpu* wyniki, OknoGpu* okna, int liczba,
+                                 ParametryGpu parametry)
+{
+    int i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i >= liczba)
+    {
+        return;
+    }
+    AtakGpu a;
+    atak_podstawowy_gpu(klucze[i], wyniki[i], okna ? &okna[i] : 0, a, parametry, sito_gpu);
+}
+
+
+// Liczniki watku dodawane do wyniku klucza; redukty etapu rozszerzonego
+// liczone sa tylko jako kandydaci, jak w atak_verheula_van_tilborga()
+__device__ void dodaj_liczniki(LicznikiGpu& wynik, LicznikiGpu& l)
+{
+    atomicAdd(&wynik.k_zero, l.k_zero);
+    atomicAdd(&wynik.nieparzyste_d, l.nieparzyste_d);
+    atomicAdd(&wynik.parzyste_phi, l.parzyste_phi);
+    atomicAdd(&wynik.dlugosc_phi, l.dlugosc_phi);
+    atomicAdd(&wynik.dzielenie, l.dzielenie);
+    atomicAdd(&wynik.przedzial_phi, l.przedzial_phi);
+    atomicAdd(&wynik.delta, l.delta);
+    atomicAdd(&wynik.pierwiastek, l.pierwiastek);
+    atomicAdd(&wynik.dzielenia, l.dzielenia);
+    atomicAdd(&wynik.pierwiastki, l.pierwiastki);
+    atomicAdd(&wynik.kandydaci, l.kandydaci);
+    wyzeruj(l);
+}
+
+
+// Jeden warp na zadanie (klucz, para, r); zadania klucza k porcji maja numery
+// od poczatki[k], w kolejnosci atak_verheula_van_tilborga()
+__global__ void jadro_rozszerzenia(const KluczGpu* klucze, WynikKluczaGpu* wyniki, const OknoGpu* okna,
+                                   const long long* poczatki, int liczba, long long zadania, ParametryGpu parametry)
+{
+    LicznikiGpu liczniki;
+    wyzeruj(liczniki);
+    RozszerzenieGpu x;
+    for (long long zadanie = blockIdx.x; zadanie < zadania; zadanie += gridDim.x)
+    {
+        // Ostatni klucz z poczatki[k] <= zadanie; klucze bez zadan maja ten sam poczatek co nastepny
+        int lewy = 0, prawy = liczba - 1;
+        while (lewy < prawy)
+        {
+            int srodek = (lewy + prawy + 1) / 2;
+            if (poczatki[srodek] <= zadanie)
+            {
+                lewy = srodek;
+            }
+            else
+            {
+                prawy = srodek - 1;
+            }
+        }
+        WynikKluczaGpu& wynik = wyniki[lewy];
+        volatile int* koniec = &wynik.wynik;
+        if (*koniec != GPU_NIE_ZNALEZIONO)
+        {
+            continue;
+        }
+        long long numer = zadanie - poczatki[lewy];
+        int para = (int)(numer % wynik.liczba_par);
+        SlowoGpu r = (SlowoGpu)(numer / wynik.liczba_par + 1);
+        int w = kandydaci_vvt_gpu(klucze[lewy], okna[lewy], para, r, threadIdx.x + 1, blockDim.x, koniec, x,
+                                  parametry, sito_gpu, liczniki);
+        if (w != 0 && atomicCAS(&wynik.wynik, GPU_NIE_ZNALEZIONO, w > 0 ? GPU_ZNALEZIONO : GPU_REZYGNACJA)
+                          == GPU_NIE_ZNALEZIONO && w > 0)
+        {
+            kopiuj(wynik.d, x.d);
+            kopiuj(wynik.q, x.q);
+        }
+        dodaj_liczniki(wynik.liczniki, liczniki);
+    }
+}
+
+
+static bool sprawdz(cudaError_t kod, std::string& blad)
+{
+    if (kod != cudaSuccess)
+    {
+        blad = cudaGetErrorString(kod);
+        return false;
+    }
+    return true;
+}
+
+
+static void na_gpu(LiczbaGpu& x, const ZZ& a, std::vector<unsigned char>& bajty)
+{
+    long n = NumBytes(a);
+    bajty.assign(4 * ((n + 3) / 4), 0);
+    BytesFromZZ(bajty.data(), a, n);
+    x.n = (int)(bajty.size() / 4);
+    for (int i = 0; i < x.n; i++)
+    {
+        x.w[i] = (SlowoGpu)bajty[4 * i] | (SlowoGpu)bajty[4 * i + 1] << 8 | (SlowoGpu)bajty[4 * i + 2] << 16
+                 | (SlowoGpu)bajty[4 * i + 3] << 24;
+    }
+    normalizuj(x);
+}
+
+
+static void z_gpu(ZZ& x, const LiczbaGpu& a, std::vector<unsigned char>& bajty)
+{
+    bajty.resize(4 * a.n);
+    for (int i = 0; i < a.n; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            bajty[4 * i + j] = (unsigned char)(a.w[i] >> (8 * j));
+        }
+    }
+    ZZFromBytes(x, bajty.data(), bajty.size());
+}
+
+
+bool pasuje_do_gpu(const ZZ& e, const ZZ& N, const UstawieniaAtaku& ustawienia)
+{
+    const RozszerzenieAtaku& rozszerzenie = ustawienia.rozszerzenie;
+    return NumBits(N) <= BITY_GPU && NumBits(e) <= BITY_GPU && sign(e) > 0 && sign(N) > 0
+           && ustawienia.obciecie == 0 && !ustawienia.pomiary && !ustawienia.budzet.ustawiony()
+           && (rozszerzenie.bity <= 0
+               || (rozszerzenie.metoda == ROZSZERZENIE_VVT && rozszerzenie.bity <= 31 && rozszerzenie.czesci == 1
+                   && !rozszerzenie.postep && !rozszerzenie.przerwij));
+}
+
+
+// Porcja kluczy w jednym strumieniu: bufory hosta (przypiete) i urzadzenia
+struct PorcjaGpu
+{
+    cudaStream_t strumien;
+    KluczGpu* klucze_hosta;
+    WynikKluczaGpu* wyniki_hosta;
+    long long* poczatki_hosta;
+    KluczGpu* klucze;
+    WynikKluczaGpu* wyniki;
+    OknoGpu* okna;
+    long long* poczatki;
+    long pierwszy, liczba;   // klucze porcji w zadaniach
+
+    PorcjaGpu()
+        : strumien(0), klucze_hosta(0), wyniki_hosta(0), poczatki_hosta(0), klucze(0), wyniki(0), okna(0),
+          poczatki(0), pierwszy(0), liczba(0)
+    {
+    }
+
+    ~PorcjaGpu()
+    {
+        if (strumien)
+        {
+            cudaStreamSynchronize(strumien);
+            cudaStreamDestroy(strumien);
+        }
+        cudaFreeHost(klucze_hosta);
+        cudaFreeHost(wyniki_hosta);
+        cudaFreeHost(poczatki_hosta);
+        cudaFree(klucze);
+        cudaFree(wyniki);
+        cudaFree(okna);
+        cudaFree(poczatki);
+    }
+
+    bool przydziel(bool z_oknami, std::string& blad)
+    {
+        return sprawdz(cudaStreamCreate(&strumien), blad)
+               && sprawdz(cudaMallocHost((void**)&klucze_hosta, PORCJA_GPU * sizeof(KluczGpu)), blad)
+               && sprawdz(cudaMallocHost((void**)&wyniki_hosta, PORCJA_GPU * sizeof(WynikKluczaGpu)), blad)
+               && sprawdz(cudaMallocHost((void**)&poczatki_hosta, PORCJA_GPU * sizeof(long long)), blad)
+               && sprawdz(cudaMalloc((void**)&klucze, PORCJA_GPU * sizeof(KluczGpu)), blad)
+               && sprawdz(cudaMalloc((void**)&wyniki, PORCJA_GPU * sizeof(WynikKluczaGpu)), blad)
+               && sprawdz(cudaMalloc((void**)&poczatki, PORCJA_GPU * sizeof(long long)), blad)
+               && (!z_oknami || sprawdz(cudaMalloc((void**)&okna, PORCJA_GPU * sizeof(OknoGpu)), blad));
+    }
+};
+
+
+// Kopiuje klucze porcji na urzadzenie i uruchamia atak podstawowy; wyniki
+// wracaja do bufora hosta asynchronicznie
+static bool wyslij(PorcjaGpu& porcja, const std::vector<ZadanieGpu>& zadania, long pierwszy,
+                   const ParametryGpu& parametry, std::vector<unsigned char>& bajty, std::string& blad)
+{
+    porcja.pierwszy = pierwszy;
+    porcja.liczba = std::min(PORCJA_GPU, (long)zadania.size() - pierwszy);
+    ZZ D;
+    for (long i = 0; i < porcja.liczba; i++)
+    {
+        const ZadanieGpu& zadanie = zadania[pierwszy + i];
+        KluczGpu& klucz = porcja.klucze_hosta[i];
+        na_gpu(klucz.e, zadanie.e, bajty);
+        na_gpu(klucz.N, zadanie.N, bajty);
+        // floor(N^(1/4) / 3) jak w przeszukaj_redukty()
+        SqrRoot(D, zadanie.N);
+        SqrRoot(D, D);
+        div(D, D, 3);
+        na_gpu(klucz.D, D, bajty);
+        LeftShift(D, D, parametry.bity_rozszerzenia);
+        na_gpu(klucz.D_max, D, bajty);
+    }
+    long bloki = (porcja.liczba + WATKI_BLOKU - 1) / WATKI_BLOKU;
+    if (!sprawdz(cudaMemcpyAsync(porcja.klucze, porcja.klucze_hosta, porcja.liczba * sizeof(KluczGpu),
+                                 cudaMemcpyHostToDevice, porcja.strumien), blad))
+    {
+        return false;
+    }
+    jadro_podstawowe<<<bloki, WATKI_BLOKU, 0, porcja.strumien>>>(porcja.klucze, porcja.wyniki, porcja.okna,
+                                                                 (int)porcja.liczba, parametry);
+    return sprawdz(cudaGetLastError(), blad)
+           && sprawdz(cudaMemcpyAsync(porcja.wyniki_hosta, porcja.wyniki, porcja.liczba * sizeof(WynikKluczaGpu),
+                                      cudaMemcpyDeviceToHost, porcja.strumien), blad);
+}
+
+
+// Czeka na atak podstawowy porcji, uruchamia etap rozszerzony dla kluczy bez
+// wyniku i przepisuje wyniki do zadan
+static bool dokoncz(PorcjaGpu& porcja, std::vector<ZadanieGpu>& zadania, const ParametryGpu& parametry,
+                    std::vector<unsigned char>& bajty, std::string& blad)
+{
+    if (!sprawdz(cudaStreamSynchronize(porcja.strumien), blad))
+    {
+        return false;
+    }
+    if (parametry.bity_rozszerzenia > 0)
+    {
+        long long R = 1LL << parametry.bity_rozszerzenia;
+        long long wszystkie = 0;
+        for (long i = 0; i < porcja.liczba; i++)
+        {
+            const WynikKluczaGpu& wynik = porcja.wyniki_hosta[i];
+            porcja.poczatki_hosta[i] = wszystkie;
+            if (wynik.wynik == GPU_NIE_ZNALEZIONO)
+            {
+                wszystkie += wynik.liczba_par * (R - 1);
+            }
+        }
+        if (wszystkie > 0)
+        {
+            int bloki = (int)std::min(wszystkie, MAKS_BLOKOW);
+            if (!sprawdz(cudaMemcpyAsync(porcja.poczatki, porcja.poczatki_hosta, porcja.liczba * sizeof(long long),
+                                         cudaMemcpyHostToDevice, porcja.strumien), blad))
+            {
+                return false;
+            }
+            jadro_rozszerzenia<<<bloki, WARP, 0, porcja.strumien>>>(porcja.klucze, porcja.wyniki, porcja.okna,
+                                                                    porcja.poczatki, (int)porcja.liczba, wszystkie,
+                                                                    parametry);
+            if (!sprawdz(cudaGetLastError(), blad)
+                || !sprawdz(cudaMemcpyAsync(porcja.wyniki_hosta, porcja.wyniki,
+                                            porcja.liczba * sizeof(WynikKluczaGpu), cudaMemcpyDeviceToHost,
+                                            porcja.strumien), blad)
+                || !sprawdz(cudaStreamSynchronize(porcja.strumien), blad))
+            {
+                return false;
+            }
+        }
+    }
+
+    for (long i = 0; i < porcja.liczba; i++)
+    {
+        const WynikKluczaGpu& wynik = porcja.wyniki_hosta[i];
+        const LicznikiGpu& l = wynik.liczniki;
+        ZadanieGpu& zadanie = zadania[porcja.pierwszy + i];
+        zadanie.rezygnacja = wynik.wynik == GPU_REZYGNACJA;
+        zadanie.znaleziono = wynik.wynik == GPU_ZNALEZIONO;
+        if (zadanie.znaleziono)
+        {
+            z_gpu(zadanie.d, wynik.d, bajty);
+            z_gpu(zadanie.q, wynik.q, bajty);
+        }
+        StatystykiAtaku& s = zadanie.statystyki;
+        s = StatystykiAtaku();
+        s.redukty = (long)l.redukty;
+        s.odrzucone_k_zero = (long)l.k_zero;
+        s.odrzucone_nieparzyste_d = (long)l.nieparzyste_d;
+        s.odrzucone_parzyste_phi = (long)l.parzyste_phi;
+        s.odrzucone_dlugosc_phi = (long)l.dlugosc_phi;
+        s.odrzucone_dzielenie = (long)l.dzielenie;
+        s.odrzucone_przedzial_phi = (long)l.przedzial_phi;
+        s.odrzucone_delta = (long)l.delta;
+        s.odrzucone_pierwiastek = (long)l.pierwiastek;
+        s.przerwane_granica = (long)wynik.przerwane_granica;
+        s.kandydaci_rozszerzenia = (long)l.kandydaci;
+        policz(s.pomiary.wyrazy, (long)wynik.wyrazy);
+        policz(s.pomiary.dzielenia, (long)l.dzielenia);
+        policz(s.pomiary.pierwiastki, (long)l.pierwiastki);
+    }
+    return true;
+}
+
+
+bool atak_gpu(std::vector<ZadanieGpu>& zadania, const UstawieniaAtaku& ustawienia, std::string& blad)
+{
+    int urzadzenia = 0;
+    if (!sprawdz(cudaGetDeviceCount(&urzadzenia), blad))
+    {
+        return false;
+    }
+    if (urzadzenia == 0)
+    {
+        blad = "brak urzadzenia CUDA";
+        return false;
+    }
+    SitoGpu sito;
+    wypelnij_sito(sito);
+    if (!sprawdz(cudaMemcpyToSymbol(sito_gpu, &sito, sizeof(sito)), blad))
+    {
+        return false;
+    }
+
+    ParametryGpu parametry;
+    parametry.nieparzyste_d = ustawienia.filtry.nieparzyste_d;
+    parametry.parzyste_phi = ustawienia.filtry.parzyste_phi;
+    parametry.przedzial_phi = ustawienia.filtry.przedzial_phi;
+    parametry.wiener = ustawienia.granica.wiener;
+    parametry.max_bity_d = (int)ustawienia.granica.max_bity_d;
+    parametry.max_indeks = (int)std::min(ustawienia.granica.max_indeks, (long)(1 << 30));
+    parametry.bity_rozszerzenia = ustawienia.rozszerzenie.bity > 0 ? (int)ustawienia.rozszerzenie.bity : 0;
+
+    // Dwie porcje na zmiane: gdy host czeka na jedna, druga liczy sie na urzadzeniu
+    PorcjaGpu porcje[2];
+    for (int b = 0; b < 2; b++)
+    {
+        if (!porcje[b].przydziel(parametry.bity_rozszerzenia > 0, blad))
+        {
+            return false;
+        }
+    }
+    std::vector<unsigned char> bajty;
+    long liczba_porcji = ((long)zadania.size() + PORCJA_GPU - 1) / PORCJA_GPU;
+    for (long p = 0; p <= liczba_porcji; p++)
+    {
+        if (p < liczba_porcji && !wyslij(porcje[p % 2], zadania, p * PORCJA_GPU, parametry, bajty, blad))
+        {
+            return false;
+        }
+        if (p > 0 && !dokoncz(porcje[(p - 1) % 2], zadania, parametry, bajty, blad))
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef WIENER_GPU_H
+#define WIENER_GPU_H
+
+#include <string>
+#include "attack.h"
+
+// Silnik GPU przebiegu wsadowego (gpu.cu, budowany z -DWIENER_CUDA, zob.
+// build.sh). Atak podstawowy to jeden klucz na watek GPU, z arytmetyka
+// stalej szerokosci z gpu_kernel.h; etap rozszerzony Verheula-van Tilborga
+// to jedno zadanie (i, r) na warp, ktorego watki dziela sie wartosciami s.
+// Klucze wysylane sa porcjami na dwa strumienie CUDA, wiec przesyl jednej
+// porcji zachodzi na obliczenia drugiej. Redukty, filtry i liczniki sa jak w
+// sprawdz_redukt(), wiec wynik i statystyki klucza nie zaleza od tego, czy
+// byl atakowany na GPU; tylko w etapie rozszerzonym, jak przy wielu watkach
+// procesora, liczniki moga objac kandydatow sprawdzanych po znalezieniu d.
+
+// Klucz przebiegu na GPU i jego wynik
+struct ZadanieGpu
+{
+    ZZ e, N;
+    bool rezygnacja;            // klucz trzeba zaatakowac atak() na procesorze
+    bool znaleziono;
+    ZZ q, d;
+    StatystykiAtaku statystyki;
+};
+
+// Czy klucz miesci sie w BITY_GPU bitach, a ustawienia nie wymagaja niczego,
+// czego GPU nie robi (obciete rozwiniecie, czasy faz, budzet ataku, metoda
+// Dujelli, podzial lub wznawianie etapu rozszerzonego, wiecej niz 31 bitow
+// rozszerzenia)
+bool pasuje_do_gpu(const ZZ& e, const ZZ& N, const UstawieniaAtaku& ustawienia);
+
+// Atakuje klucze na GPU; statystyki kazdego klucza od zera. Zwraca false
+// i opis w blad, gdy nie ma urzadzenia CUDA lub wywolanie CUDA sie nie
+// powiodlo; wyniki kluczy sa wtedy nieokreslone.
+bool atak_gpu(std::vector<ZadanieGpu>& zadania, const UstawieniaAtaku& ustawienia, std::string& blad);
+
+#endif
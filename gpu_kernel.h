@@ -0,0 +1,810 @@
+#ifndef WIENER_GPU_KERNEL_H
+#define WIENER_GPU_KERNEL_H
+
+// Czesc silnika GPU (gpu.h) wspolna dla urzadzenia i hosta: arytmetyka na
+// 32-bitowych slowach w tablicach stalej dlugosci (bez alokacji, jak
+// fixed_backend.h, ale na slowach natywnych dla GPU), sprawdzanie reduktu jak
+// sprawdz_redukt(), atak podstawowy na jeden klucz i kandydaci etapu
+// rozszerzonego Verheula-van Tilborga z jednego zadania (i, r). gpu.cu
+// kompiluje ja przez nvcc jako funkcje __host__ __device__; bez CUDA to
+// zwykle funkcje inline, ktore daja sie sprawdzic na procesorze.
+
+#ifdef __CUDACC__
+#define FUNKCJA_GPU __host__ __device__ inline
+#else
+#define FUNKCJA_GPU inline
+#endif
+
+// Najdluzszy modul i wykladnik e atakowany na GPU; dluzsze klucze ida do atak()
+const int BITY_GPU = 1024;
+// e*d i s^2 maja do 2 * BITY_GPU bitow, plus slowa zapasu
+const int SLOWA_GPU = 2 * BITY_GPU / 32 + 2;
+// Najwiecej par reduktow etapu rozszerzonego na klucz; klucz z wieksza
+// liczba par atakowany jest na procesorze
+const int MAKS_PAR_GPU = 32;
+
+typedef unsigned int SlowoGpu;
+typedef unsigned long long PodwojneGpu;
+
+// Liczba nieujemna: n slow od najmlodszego, bez zer wiodacych
+struct LiczbaGpu
+{
+    SlowoGpu w[SLOWA_GPU];
+    int n;
+};
+
+enum WynikGpu
+{
+    GPU_NIE_ZNALEZIONO,
+    GPU_ZNALEZIONO,
+    GPU_REZYGNACJA      // posredni wynik poza SLOWA_GPU (tylko bez filtru przedzial_phi)
+                        // albo za duzo par: klucz trzeba zaatakowac zwykla sciezka
+};
+
+// Liczniki sprawdz_redukt() w kolejnosci pol StatystykiAtaku; dzielenia
+// i pierwiastki liczone zawsze, host dodaje je przez policz()
+struct LicznikiGpu
+{
+    unsigned long long redukty, k_zero, nieparzyste_d, parzyste_phi, dlugosc_phi, dzielenie, przedzial_phi,
+        delta, pierwiastek, dzielenia, pierwiastki, kandydaci;
+};
+
+// Ustawienia ataku w postaci przekazywanej do jadra
+struct ParametryGpu
+{
+    bool nieparzyste_d, parzyste_phi, przedzial_phi;   // FiltryReduktow
+    bool wiener;                                       // GranicaSzukania
+    int max_bity_d, max_indeks;
+    int bity_rozszerzenia;                             // 0 = bez etapu rozszerzonego
+};
+
+// Klucz na wejsciu jadra: D = floor(N^(1/4) / 3), D_max = D * 2^bity_rozszerzenia
+struct KluczGpu
+{
+    LiczbaGpu e, N, D, D_max;
+};
+
+// Redukty P_i/Q_i od pierwszej pary etapu rozszerzonego do ostatniej
+struct OknoGpu
+{
+    LiczbaGpu P[MAKS_PAR_GPU + 1], Q[MAKS_PAR_GPU + 1];
+};
+
+// Wynik klucza; wynik jest tez flaga konca etapu rozszerzonego
+struct WynikKluczaGpu
+{
+    int wynik;
+    int liczba_par;
+    long long wyrazy;
+    unsigned long long przerwane_granica;
+    LicznikiGpu liczniki;
+    LiczbaGpu d, q;
+};
+
+// Sito kwadratow (perfect_square.h), w pamieci stalej urzadzenia
+struct SitoGpu
+{
+    unsigned char k256[256], k63[63], k65[65], k11[11], k17[17], k19[19], k23[23], k29[29], k31[31], k37[37];
+};
+
+
+inline void wypelnij_sito(unsigned char* tablica, int modul)
+{
+    for (int i = 0; i < modul; i++)
+    {
+        tablica[i] = 0;
+    }
+    for (int i = 0; i < modul; i++)
+    {
+        tablica[(i * i) % modul] = 1;
+    }
+}
+
+inline void wypelnij_sito(SitoGpu& sito)
+{
+    wypelnij_sito(sito.k256, 256);
+    wypelnij_sito(sito.k63, 63);
+    wypelnij_sito(sito.k65, 65);
+    wypelnij_sito(sito.k11, 11);
+    wypelnij_sito(sito.k17, 17);
+    wypelnij_sito(sito.k19, 19);
+    wypelnij_sito(sito.k23, 23);
+    wypelnij_sito(sito.k29, 29);
+    wypelnij_sito(sito.k31, 31);
+    wypelnij_sito(sito.k37, 37);
+}
+
+
+FUNKCJA_GPU void wyzeruj(LicznikiGpu& l)
+{
+    l.redukty = l.k_zero = l.nieparzyste_d = l.parzyste_phi = l.dlugosc_phi = l.dzielenie = l.przedzial_phi = 0;
+    l.delta = l.pierwiastek = l.dzielenia = l.pierwiastki = l.kandydaci = 0;
+}
+
+
+// Operacje na LiczbaGpu; wynik moze byc argumentem, o ile nie napisano inaczej
+
+FUNKCJA_GPU int bity_slowa_gpu(SlowoGpu a)
+{
+#ifdef __CUDA_ARCH__
+    return 32 - __clz(a);
+#else
+    return a == 0 ? 0 : 32 - __builtin_clz(a);
+#endif
+}
+
+FUNKCJA_GPU int zera_konca_gpu(PodwojneGpu a)
+{
+#ifdef __CUDA_ARCH__
+    return __ffsll((long long)a) - 1;
+#else
+    return __builtin_ctzll(a);
+#endif
+}
+
+FUNKCJA_GPU void normalizuj(LiczbaGpu& x)
+{
+    while (x.n > 0 && x.w[x.n - 1] == 0)
+    {
+        x.n--;
+    }
+}
+
+FUNKCJA_GPU void ustaw(LiczbaGpu& x, SlowoGpu a)
+{
+    x.w[0] = a;
+    x.n = a != 0;
+}
+
+FUNKCJA_GPU void kopiuj(LiczbaGpu& x, const LiczbaGpu& a)
+{
+    for (int i = 0; i < a.n; i++)
+    {
+        x.w[i] = a.w[i];
+    }
+    x.n = a.n;
+}
+
+FUNKCJA_GPU int bity(const LiczbaGpu& a)
+{
+    return a.n == 0 ? 0 : 32 * (a.n - 1) + bity_slowa_gpu(a.w[a.n - 1]);
+}
+
+// Najnizsze 64 bity
+FUNKCJA_GPU PodwojneGpu slowo_64(const LiczbaGpu& a)
+{
+    return (a.n > 0 ? a.w[0] : 0) | (a.n > 1 ? (PodwojneGpu)a.w[1] << 32 : 0);
+}
+
+FUNKCJA_GPU int porownaj(const LiczbaGpu& a, const LiczbaGpu& b)
+{
+    if (a.n != b.n)
+    {
+        return a.n < b.n ? -1 : 1;
+    }
+    for (int i = a.n - 1; i >= 0; i--)
+    {
+        if (a.w[i] != b.w[i])
+        {
+            return a.w[i] < b.w[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+FUNKCJA_GPU void dodaj(LiczbaGpu& x, const LiczbaGpu& a, const LiczbaGpu& b)
+{
+    const LiczbaGpu& dluzsza = a.n >= b.n ? a : b;
+    const LiczbaGpu& krotsza = a.n >= b.n ? b : a;
+    int n = dluzsza.n, m = krotsza.n;
+    PodwojneGpu przeniesienie = 0;
+    for (int i = 0; i < n; i++)
+    {
+        przeniesienie += (PodwojneGpu)dluzsza.w[i] + (i < m ? krotsza.w[i] : 0);
+        x.w[i] = (SlowoGpu)przeniesienie;
+        przeniesienie >>= 32;
+    }
+    x.n = n;
+    if (przeniesienie)
+    {
+        x.w[x.n++] = (SlowoGpu)przeniesienie;
+    }
+}
+
+FUNKCJA_GPU void dodaj_slowo(LiczbaGpu& x, const LiczbaGpu& a, SlowoGpu b)
+{
+    PodwojneGpu przeniesienie = b;
+    for (int i = 0; i < a.n; i++)
+    {
+        przeniesienie += a.w[i];
+        x.w[i] = (SlowoGpu)przeniesienie;
+        przeniesienie >>= 32;
+    }
+    x.n = a.n;
+    if (przeniesienie)
+    {
+        x.w[x.n++] = (SlowoGpu)przeniesienie;
+    }
+}
+
+// x = a - b dla a >= b
+FUNKCJA_GPU void odejmij(LiczbaGpu& x, const LiczbaGpu& a, const LiczbaGpu& b)
+{
+    long long pozyczka = 0;
+    int m = b.n;
+    for (int i = 0; i < a.n; i++)
+    {
+        long long t = (long long)a.w[i] - (i < m ? b.w[i] : 0) - pozyczka;
+        x.w[i] = (SlowoGpu)t;
+        pozyczka = t < 0;
+    }
+    x.n = a.n;
+    normalizuj(x);
+}
+
+// x = a - b dla a >= b
+FUNKCJA_GPU void odejmij_slowo(LiczbaGpu& x, const LiczbaGpu& a, SlowoGpu b)
+{
+    long long pozyczka = b;
+    for (int i = 0; i < a.n; i++)
+    {
+        long long t = (long long)a.w[i] - pozyczka;
+        x.w[i] = (SlowoGpu)t;
+        pozyczka = t < 0;
+    }
+    x.n = a.n;
+    normalizuj(x);
+}
+
+// x = a * b; x rozne od a i b, a.n + b.n <= SLOWA_GPU
+FUNKCJA_GPU void mnoz(LiczbaGpu& x, const LiczbaGpu& a, const LiczbaGpu& b)
+{
+    if (a.n == 0 || b.n == 0)
+    {
+        x.n = 0;
+        return;
+    }
+    for (int i = 0; i < a.n + b.n; i++)
+    {
+        x.w[i] = 0;
+    }
+    for (int i = 0; i < a.n; i++)
+    {
+        PodwojneGpu przeniesienie = 0;
+        for (int j = 0; j < b.n; j++)
+        {
+            przeniesienie += (PodwojneGpu)a.w[i] * b.w[j] + x.w[i + j];
+            x.w[i + j] = (SlowoGpu)przeniesienie;
+            przeniesienie >>= 32;
+        }
+        x.w[i + b.n] = (SlowoGpu)przeniesienie;
+    }
+    x.n = a.n + b.n;
+    normalizuj(x);
+}
+
+FUNKCJA_GPU void mnoz_slowo(LiczbaGpu& x, const LiczbaGpu& a, SlowoGpu b)
+{
+    if (b == 0)
+    {
+        x.n = 0;
+        return;
+    }
+    PodwojneGpu przeniesienie = 0;
+    for (int i = 0; i < a.n; i++)
+    {
+        przeniesienie += (PodwojneGpu)a.w[i] * b;
+        x.w[i] = (SlowoGpu)przeniesienie;
+        przeniesienie >>= 32;
+    }
+    x.n = a.n;
+    if (przeniesienie)
+    {
+        x.w[x.n++] = (SlowoGpu)przeniesienie;
+    }
+}
+
+// x = a * 2^k dla 0 <= k < 32
+FUNKCJA_GPU void przesun_w_lewo(LiczbaGpu& x, const LiczbaGpu& a, int k)
+{
+    SlowoGpu przeniesienie = 0;
+    int n = a.n;
+    for (int i = 0; i < n; i++)
+    {
+        SlowoGpu t = a.w[i];
+        x.w[i] = (t << k) | przeniesienie;
+        przeniesienie = k ? t >> (32 - k) : 0;
+    }
+    x.n = n;
+    if (przeniesienie)
+    {
+        x.w[x.n++] = przeniesienie;
+    }
+}
+
+// x = floor(a / 2)
+FUNKCJA_GPU void polowa(LiczbaGpu& x, const LiczbaGpu& a)
+{
+    int n = a.n;
+    for (int i = 0; i < n; i++)
+    {
+        x.w[i] = (a.w[i] >> 1) | (i + 1 < n ? a.w[i + 1] << 31 : 0);
+    }
+    x.n = n;
+    normalizuj(x);
+}
+
+FUNKCJA_GPU SlowoGpu reszta_slowa(const LiczbaGpu& a, SlowoGpu m)
+{
+    PodwojneGpu r = 0;
+    for (int i = a.n - 1; i >= 0; i--)
+    {
+        r = ((r << 32) | a.w[i]) % m;
+    }
+    return (SlowoGpu)r;
+}
+
+// q = a / b, r = a % b dla b != 0 (Knuth, alg. D); q i r rozne od a i b
+FUNKCJA_GPU void dziel(LiczbaGpu& q, LiczbaGpu& r, const LiczbaGpu& a, const LiczbaGpu& b)
+{
+    if (porownaj(a, b) < 0)
+    {
+        kopiuj(r, a);
+        q.n = 0;
+        return;
+    }
+    int m = a.n, n = b.n;
+    if (n == 1)
+    {
+        PodwojneGpu reszta = 0;
+        for (int i = m - 1; i >= 0; i--)
+        {
+            PodwojneGpu t = (reszta << 32) | a.w[i];
+            q.w[i] = (SlowoGpu)(t / b.w[0]);
+            reszta = t % b.w[0];
+        }
+        q.n = m;
+        normalizuj(q);
+        ustaw(r, (SlowoGpu)reszta);
+        return;
+    }
+
+    // Normalizacja: najstarszy bit dzielnika ustawiony
+    int s = 32 - bity_slowa_gpu(b.w[n - 1]);
+    SlowoGpu u[SLOWA_GPU + 1], v[SLOWA_GPU];
+    for (int i = n - 1; i > 0; i--)
+    {
+        v[i] = (b.w[i] << s) | (s ? b.w[i - 1] >> (32 - s) : 0);
+    }
+    v[0] = b.w[0] << s;
+    u[m] = s ? a.w[m - 1] >> (32 - s) : 0;
+    for (int i = m - 1; i > 0; i--)
+    {
+        u[i] = (a.w[i] << s) | (s ? a.w[i - 1] >> (32 - s) : 0);
+    }
+    u[0] = a.w[0] << s;
+
+    for (int j = m - n; j >= 0; j--)
+    {
+        PodwojneGpu licznik = ((PodwojneGpu)u[j + n] << 32) | u[j + n - 1];
+        PodwojneGpu iloraz = licznik / v[n - 1];
+        PodwojneGpu reszta = licznik % v[n - 1];
+        while ((iloraz >> 32) || iloraz * v[n - 2] > ((reszta << 32) | u[j + n - 2]))
+        {
+            iloraz--;
+            reszta += v[n - 1];
+            if (reszta >> 32)
+            {
+                break;
+            }
+        }
+        // u[j .. j + n] -= iloraz * v
+        long long pozyczka = 0;
+        PodwojneGpu przeniesienie = 0;
+        for (int i = 0; i < n; i++)
+        {
+            PodwojneGpu iloczyn = iloraz * v[i] + przeniesienie;
+            przeniesienie = iloczyn >> 32;
+            long long t = (long long)u[i + j] - pozyczka - (long long)(iloczyn & 0xffffffffULL);
+            u[i + j] = (SlowoGpu)t;
+            pozyczka = t < 0;
+        }
+        long long t = (long long)u[j + n] - pozyczka - (long long)przeniesienie;
+        u[j + n] = (SlowoGpu)t;
+        if (t < 0)
+        {
+            // Iloraz o jeden za duzy: dodanie v z powrotem
+            iloraz--;
+            przeniesienie = 0;
+            for (int i = 0; i < n; i++)
+            {
+                przeniesienie += (PodwojneGpu)u[i + j] + v[i];
+                u[i + j] = (SlowoGpu)przeniesienie;
+                przeniesienie >>= 32;
+            }
+            u[j + n] += (SlowoGpu)przeniesienie;
+        }
+        q.w[j] = (SlowoGpu)iloraz;
+    }
+    q.n = m - n + 1;
+    normalizuj(q);
+    for (int i = 0; i < n; i++)
+    {
+        r.w[i] = (u[i] >> s) | (s ? u[i + 1] << (32 - s) : 0);
+    }
+    r.n = n;
+    normalizuj(r);
+}
+
+// x = floor(sqrt(a)) metoda Newtona od 2^ceil(bity(a) / 2); x rozne od a,
+// y, q, r robocze
+FUNKCJA_GPU void pierwiastek(LiczbaGpu& x, const LiczbaGpu& a, LiczbaGpu& y, LiczbaGpu& q, LiczbaGpu& r)
+{
+    if (a.n == 0)
+    {
+        x.n = 0;
+        return;
+    }
+    int k = (bity(a) + 1) / 2;
+    x.n = k / 32 + 1;
+    for (int i = 0; i < x.n; i++)
+    {
+        x.w[i] = 0;
+    }
+    x.w[k / 32] = (SlowoGpu)1 << (k % 32);
+    for (;;)
+    {
+        dziel(q, r, a, x);
+        dodaj(y, x, q);
+        polowa(y, y);
+        if (porownaj(y, x) >= 0)
+        {
+            return;
+        }
+        kopiuj(x, y);
+    }
+}
+
+FUNKCJA_GPU bool moze_byc_kwadratem_gpu(const LiczbaGpu& a, const SitoGpu& sito)
+{
+    if (!sito.k256[a.n > 0 ? a.w[0] & 255 : 0])
+    {
+        return false;
+    }
+    SlowoGpu r = reszta_slowa(a, 63 * 65 * 11);
+    if (!sito.k63[r % 63] || !sito.k65[r % 65] || !sito.k11[r % 11])
+    {
+        return false;
+    }
+    r = reszta_slowa(a, 17 * 19 * 23 * 29 * 31 * 37);
+    return sito.k17[r % 17] && sito.k19[r % 19] && sito.k23[r % 23] && sito.k29[r % 29] && sito.k31[r % 31]
+           && sito.k37[r % 37];
+}
+
+
+// Zmienne robocze sprawdzania reduktu
+struct RoboczeGpu
+{
+    LiczbaGpu phiN, s, delta, tmp, pierwiastek, p, y, iloraz, reszta;
+};
+
+// sprawdz_redukt() na LiczbaGpu. Zwraca 1 dla rozkladu N (drugi czynnik w q),
+// 0 dla odrzuconego reduktu, -1 gdy s nie miesci sie w BITY_GPU + 1 bitach.
+FUNKCJA_GPU int sprawdz_redukt_gpu(const LiczbaGpu& e, const LiczbaGpu& N, const LiczbaGpu& k, const LiczbaGpu& d,
+                                   LiczbaGpu& q, RoboczeGpu& z, const ParametryGpu& parametry,
+                                   const SitoGpu& sito, LicznikiGpu& liczniki)
+{
+    liczniki.redukty++;
+    if (k.n == 0)
+    {
+        liczniki.k_zero++;
+        return 0;
+    }
+    if (parametry.nieparzyste_d && !(d.n > 0 && (d.w[0] & 1)))
+    {
+        liczniki.nieparzyste_d++;
+        return 0;
+    }
+    if (parametry.parzyste_phi)
+    {
+        PodwojneGpu ed_1 = slowo_64(e) * slowo_64(d) - 1;
+        PodwojneGpu slowo_k = slowo_64(k);
+        if (ed_1 != 0 && slowo_k != 0 && zera_konca_gpu(ed_1) < zera_konca_gpu(slowo_k) + 2)
+        {
+            liczniki.parzyste_phi++;
+            return 0;
+        }
+    }
+    int bity_N = bity(N);
+    if (parametry.przedzial_phi)
+    {
+        int bity_ed = bity(e) + bity(d);
+        int bity_k = bity(k);
+        if (bity_ed - bity_k + 1 < bity_N - 1 || bity_ed - bity_k - 2 > bity_N)
+        {
+            liczniki.dlugosc_phi++;
+            return 0;
+        }
+    }
+    liczniki.dzielenia++;
+    mnoz(z.tmp, e, d);
+    odejmij_slowo(z.tmp, z.tmp, 1);
+    dziel(z.phiN, z.reszta, z.tmp, k);
+    if (z.reszta.n != 0)
+    {
+        liczniki.dzielenie++;
+        return 0;
+    }
+    // s = N + 1 - phi(N) ze znakiem osobno
+    dodaj_slowo(z.tmp, N, 1);
+    bool s_ujemne = porownaj(z.tmp, z.phiN) < 0;
+    if (s_ujemne)
+    {
+        odejmij(z.s, z.phiN, z.tmp);
+    }
+    else
+    {
+        odejmij(z.s, z.tmp, z.phiN);
+    }
+    if (parametry.przedzial_phi && (s_ujemne || z.s.n == 0 || bity(z.s) > (bity_N + 1) / 2 + 2))
+    {
+        liczniki.przedzial_phi++;
+        return 0;
+    }
+    if (bity(z.s) > BITY_GPU + 1)
+    {
+        return -1;
+    }
+    // Delta rownania: s^2 - 4N
+    mnoz(z.delta, z.s, z.s);
+    przesun_w_lewo(z.tmp, N, 2);
+    if (porownaj(z.delta, z.tmp) < 0)
+    {
+        liczniki.delta++;
+        return 0;
+    }
+    odejmij(z.delta, z.delta, z.tmp);
+    if (!moze_byc_kwadratem_gpu(z.delta, sito))
+    {
+        liczniki.delta++;
+        return 0;
+    }
+    liczniki.pierwiastki++;
+    pierwiastek(z.pierwiastek, z.delta, z.y, z.iloraz, z.reszta);
+    mnoz(z.tmp, z.pierwiastek, z.pierwiastek);
+    if (porownaj(z.tmp, z.delta) != 0)
+    {
+        liczniki.delta++;
+        return 0;
+    }
+    // Pierwiastek p = (s + sqrt(delta)) / 2 musi byc calkowity, dodatni i dzielic N
+    bool p_dodatnie = true;
+    if (!s_ujemne)
+    {
+        dodaj(z.p, z.s, z.pierwiastek);
+    }
+    else if (porownaj(z.pierwiastek, z.s) > 0)
+    {
+        odejmij(z.p, z.pierwiastek, z.s);
+    }
+    else
+    {
+        odejmij(z.p, z.s, z.pierwiastek);
+        p_dodatnie = false;
+    }
+    if (z.p.n > 0 && (z.p.w[0] & 1))
+    {
+        liczniki.pierwiastek++;
+        return 0;
+    }
+    polowa(z.p, z.p);
+    if (!p_dodatnie || z.p.n == 0)
+    {
+        liczniki.pierwiastek++;
+        return 0;
+    }
+    dziel(q, z.reszta, N, z.p);
+    if (z.reszta.n != 0)
+    {
+        liczniki.pierwiastek++;
+        return 0;
+    }
+    return 1;
+}
+
+
+// Zmienne ataku podstawowego na jeden klucz
+struct AtakGpu
+{
+    LiczbaGpu u, v, iloraz, reszta, P[3], Q[3];
+    RoboczeGpu z;
+};
+
+// Zapisuje redukt P/Q w oknie; false, gdy okno jest pelne
+FUNKCJA_GPU bool dolacz_do_okna(OknoGpu& okno, int& dlugosc, const LiczbaGpu& P, const LiczbaGpu& Q)
+{
+    if (dlugosc > MAKS_PAR_GPU)
+    {
+        return false;
+    }
+    kopiuj(okno.P[dlugosc], P);
+    kopiuj(okno.Q[dlugosc], Q);
+    dlugosc++;
+    return true;
+}
+
+// Atak podstawowy na klucz jak atak_pasmowy() na jednym pasmie (rozwiniecie
+// Euklidesa). Z bity_rozszerzenia > 0 rozwiniecie trwa po granicy szukania az
+// do pierwszego Q_i > D_max, a redukty od pierwszej pary etapu rozszerzonego
+// (jak w pary_reduktow()) trafiaja do okna.
+FUNKCJA_GPU void atak_podstawowy_gpu(const KluczGpu& klucz, WynikKluczaGpu& wynik, OknoGpu* okno, AtakGpu& a,
+                                     const ParametryGpu& parametry, const SitoGpu& sito)
+{
+    wynik.wynik = GPU_NIE_ZNALEZIONO;
+    wynik.liczba_par = 0;
+    wynik.przerwane_granica = 0;
+    wyzeruj(wynik.liczniki);
+    kopiuj(a.u, klucz.e);
+    kopiuj(a.v, klucz.N);
+    // Indeksy w P i Q: biezacy, poprzedni i wolny
+    int biezacy = 0, poprzedni = 1, wolny = 2;
+    ustaw(a.P[biezacy], 1);
+    ustaw(a.P[poprzedni], 0);
+    ustaw(a.Q[biezacy], 0);
+    ustaw(a.Q[poprzedni], 1);
+    long long indeks = -1;
+    bool sprawdzaj = true;
+    bool z_oknem = parametry.bity_rozszerzenia > 0 && okno;
+    int dlugosc_okna = -1;   // -1 = okno jeszcze sie nie zaczelo
+    bool okno_pelne = false;
+
+    while (a.v.n != 0 && (sprawdzaj || (z_oknem && !okno_pelne)))
+    {
+        // Kolejny wyraz i redukt
+        dziel(a.iloraz, a.reszta, a.u, a.v);
+        kopiuj(a.u, a.v);
+        kopiuj(a.v, a.reszta);
+        mnoz(a.P[wolny], a.iloraz, a.P[biezacy]);
+        dodaj(a.P[wolny], a.P[wolny], a.P[poprzedni]);
+        mnoz(a.Q[wolny], a.iloraz, a.Q[biezacy]);
+        dodaj(a.Q[wolny], a.Q[wolny], a.Q[poprzedni]);
+        int t = poprzedni;
+        poprzedni = biezacy;
+        biezacy = wolny;
+        wolny = t;
+        indeks++;
+        const LiczbaGpu& P = a.P[biezacy];
+        const LiczbaGpu& Q = a.Q[biezacy];
+
+        if (z_oknem && !okno_pelne)
+        {
+            if (dlugosc_okna < 0 && porownaj(Q, klucz.D) > 0)
+            {
+                dlugosc_okna = 0;
+                if (indeks > 0)
+                {
+                    dolacz_do_okna(*okno, dlugosc_okna, a.P[poprzedni], a.Q[poprzedni]);
+                }
+            }
+            if (dlugosc_okna >= 0)
+            {
+                if (!dolacz_do_okna(*okno, dlugosc_okna, P, Q))
+                {
+                    wynik.wynik = GPU_REZYGNACJA;
+                    break;
+                }
+                okno_pelne = porownaj(Q, klucz.D_max) > 0;
+            }
+        }
+        if (!sprawdzaj)
+        {
+            continue;
+        }
+        if ((parametry.wiener && porownaj(klucz.D, Q) < 0)
+            || (parametry.max_bity_d > 0 && bity(Q) > parametry.max_bity_d)
+            || (parametry.max_indeks >= 0 && indeks > parametry.max_indeks))
+        {
+            wynik.przerwane_granica++;
+            wynik.wyrazy = indeks + 1;
+            sprawdzaj = false;
+            continue;
+        }
+        int w = sprawdz_redukt_gpu(klucz.e, klucz.N, P, Q, wynik.q, a.z, parametry, sito, wynik.liczniki);
+        if (w != 0)
+        {
+            wynik.wynik = w > 0 ? GPU_ZNALEZIONO : GPU_REZYGNACJA;
+            kopiuj(wynik.d, Q);
+            wynik.wyrazy = indeks + 1;
+            return;
+        }
+    }
+    if (sprawdzaj)
+    {
+        wynik.wyrazy = indeks + 1;
+    }
+    wynik.liczba_par = dlugosc_okna > 1 ? dlugosc_okna - 1 : 0;
+}
+
+
+FUNKCJA_GPU SlowoGpu nwd_gpu(SlowoGpu a, SlowoGpu b)
+{
+    while (b != 0)
+    {
+        SlowoGpu t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Zmienne robocze kandydatow etapu rozszerzonego
+struct RozszerzenieGpu
+{
+    LiczbaGpu k, d, t, q;
+    RoboczeGpu z;
+};
+
+// Kandydaci k = r P_{i+1} +- s P_i, d = r Q_{i+1} +- s Q_i zadania (para, r)
+// atak_verheula_van_tilborga() dla s = pierwsze_s, pierwsze_s + krok_s, ...
+// Konczy sie, gdy *koniec != GPU_NIE_ZNALEZIONO. Zwraca wynik
+// sprawdz_redukt_gpu() pierwszego kandydata z wynikiem rozny od 0 (k, d i q
+// ustawione), a 0, gdy zaden nie rozklada N.
+FUNKCJA_GPU int kandydaci_vvt_gpu(const KluczGpu& klucz, const OknoGpu& okno, int para, SlowoGpu r,
+                                   SlowoGpu pierwsze_s, SlowoGpu krok_s, const volatile int* koniec,
+                                   RozszerzenieGpu& x, const ParametryGpu& parametry, const SitoGpu& sito,
+                                   LicznikiGpu& liczniki)
+{
+    SlowoGpu R = (SlowoGpu)1 << parametry.bity_rozszerzenia;
+    const LiczbaGpu& P0 = okno.P[para];
+    const LiczbaGpu& P1 = okno.P[para + 1];
+    const LiczbaGpu& Q0 = okno.Q[para];
+    const LiczbaGpu& Q1 = okno.Q[para + 1];
+    for (int znak = 1; znak >= -1; znak -= 2)
+    {
+        for (SlowoGpu s = pierwsze_s; s < R && *koniec == GPU_NIE_ZNALEZIONO; s += krok_s)
+        {
+            mnoz_slowo(x.k, P1, r);
+            mnoz_slowo(x.d, Q1, r);
+            if (znak > 0)
+            {
+                mnoz_slowo(x.t, P0, s);
+                dodaj(x.k, x.k, x.t);
+                mnoz_slowo(x.t, Q0, s);
+                dodaj(x.d, x.d, x.t);
+            }
+            else
+            {
+                // k i d maleja z s, wiec dalsze s tez odpadaja
+                mnoz_slowo(x.t, P0, s);
+                if (porownaj(x.k, x.t) <= 0)
+                {
+                    break;
+                }
+                odejmij(x.k, x.k, x.t);
+                mnoz_slowo(x.t, Q0, s);
+                if (porownaj(x.d, x.t) <= 0)
+                {
+                    break;
+                }
+                odejmij(x.d, x.d, x.t);
+                if (porownaj(klucz.D, x.d) >= 0)
+                {
+                    break;
+                }
+            }
+            if (nwd_gpu(r, s) != 1 || (znak > 0 && porownaj(klucz.D, x.d) >= 0))
+            {
+                continue;
+            }
+            liczniki.kandydaci++;
+            int wynik = sprawdz_redukt_gpu(klucz.e, klucz.N, x.k, x.d, x.q, x.z, parametry, sito, liczniki);
+            if (wynik != 0)
+            {
+                return wynik;
+            }
+        }
+    }
+    return 0;
+}
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef WIENER_INSTRUMENTATION_H
+#define WIENER_INSTRUMENTATION_H
+
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Liczniki i czasy faz ataku. Budowanie z -DWIENER_POMIARY=0 usuwa je
+// z goracej sciezki calkowicie; przy WIENER_POMIARY=1 liczniki zliczane sa
+// zawsze, a czasy faz tylko dla ataku z UstawieniaAtaku::pomiary (--profile).
+#ifndef WIENER_POMIARY
+#define WIENER_POMIARY 1
+#endif
+
+
+enum FazaAtaku
+{
+    FAZA_ROZWINIECIE,   // wyrazy z silnika rozwiniecia
+    FAZA_REDUKTY,       // rekurencja P_i, Q_i i warunek Jebeleana
+    FAZA_FILTRY,        // tanie filtry reduktu
+    FAZA_DZIELENIE,     // k | e*d - 1 i przedzial s
+    FAZA_PIERWIASTEK,   // delta, sito kwadratow i pierwiastek
+    FAZA_ROZSZERZENIE,  // etap rozszerzony (Verheul-van Tilborg, Dujella)
+    LICZBA_FAZ
+};
+
+inline const char* nazwa_fazy(long faza)
+{
+    static const char* nazwy[LICZBA_FAZ] = { "cf", "recurrence", "filters", "divide", "sqrt", "extension" };
+    return nazwy[faza];
+}
+
+
+// Znacznik czasu: licznik cykli TSC na x86, w przeciwnym razie nanosekundy
+#if defined(__x86_64__) || defined(__i386__)
+static const char* const JEDNOSTKA_CZASU = "tsc";
+
+inline unsigned long long znacznik_czasu()
+{
+    return __rdtsc();
+}
+#else
+static const char* const JEDNOSTKA_CZASU = "ns";
+
+inline unsigned long long znacznik_czasu()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+
+struct PomiaryAtaku
+{
+    long wyrazy;      // dlugosc przejrzanego rozwiniecia e/N
+    long dzielenia;   // testy k | e*d - 1
+    long pierwiastki; // pierwiastki delta po sicie kwadratow
+    unsigned long long czas[LICZBA_FAZ];
+
+    PomiaryAtaku() : wyrazy(0), dzielenia(0), pierwiastki(0)
+    {
+        for (long f = 0; f < LICZBA_FAZ; f++)
+        {
+            czas[f] = 0;
+        }
+    }
+
+    void dodaj(const PomiaryAtaku& p)
+    {
+        wyrazy += p.wyrazy;
+        dzielenia += p.dzielenia;
+        pierwiastki += p.pierwiastki;
+        for (long f = 0; f < LICZBA_FAZ; f++)
+        {
+            czas[f] += p.czas[f];
+        }
+    }
+};
+
+
+#if WIENER_POMIARY
+inline void policz(long& licznik, long ile = 1)
+{
+    licznik += ile;
+}
+#else
+inline void policz(long&, long = 1)
+{
+}
+#endif
+
+
+// Stoper przelaczany miedzy fazami: jeden odczyt znacznika czasu na
+// przelaczenie, czas od poprzedniego przelaczenia trafia do poprzedniej fazy.
+// Bez przypisanych pomiarow nic nie mierzy.
+class StoperFaz
+{
+public:
+    explicit StoperFaz(PomiaryAtaku* pomiary = 0) : pomiary(pomiary), faza(LICZBA_FAZ), poczatek(0) {}
+
+#if WIENER_POMIARY
+    void przelacz(FazaAtaku nowa)
+    {
+        if (pomiary)
+        {
+            unsigned long long teraz = znacznik_czasu();
+            if (faza != LICZBA_FAZ)
+            {
+                pomiary->czas[faza] += teraz - poczatek;
+            }
+            poczatek = teraz;
+            faza = nowa;
+        }
+    }
+#else
+    void przelacz(FazaAtaku)
+    {
+    }
+#endif
+
+    void zatrzymaj()
+    {
+        przelacz(LICZBA_FAZ);
+    }
+
+private:
+    PomiaryAtaku* pomiary;
+    FazaAtaku faza;
+    unsigned long long poczatek;
+};
+
+#endif
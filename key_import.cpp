@@ -0,0 +1,487 @@
+#include <iostream>
+#include <cstring>
+#include "key_import.h"
+
+
+// Wartosci znakow base64 (-1 poza alfabetem)
+struct AlfabetBase64
+{
+    signed char wartosc[256];
+
+    AlfabetBase64()
+    {
+        const char* znaki = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        memset(wartosc, -1, sizeof(wartosc));
+        for (int i = 0; i < 64; i++)
+        {
+            wartosc[(unsigned char)znaki[i]] = i;
+        }
+    }
+};
+
+static const AlfabetBase64 BASE64;
+
+
+// Stan dekodowania base64 miedzy kolejnymi liniami bloku PEM
+struct DekoderBase64
+{
+    unsigned long akumulator;
+    int bity;
+    bool dopelnienie, poprawny;
+
+    DekoderBase64() : akumulator(0), bity(0), dopelnienie(false), poprawny(true) {}
+};
+
+
+// Dopisuje zdekodowane bajty do wyjscia; biale znaki sa pomijane
+static void dekoduj_base64(const char* p, const char* koniec, DekoderBase64& stan,
+                           std::vector<unsigned char>& wyjscie)
+{
+    for (; p < koniec && stan.poprawny; p++)
+    {
+        int v = BASE64.wartosc[(unsigned char)*p];
+        if (v < 0)
+        {
+            stan.dopelnienie = stan.dopelnienie || *p == '=';
+            stan.poprawny = *p == '=' || *p == ' ' || *p == '\t' || *p == '\r';
+            continue;
+        }
+        // po '=' nie moze byc juz danych
+        stan.poprawny = !stan.dopelnienie;
+        stan.akumulator = (stan.akumulator << 6 | v) & 0xffffff;
+        stan.bity += 6;
+        if (stan.bity >= 8)
+        {
+            stan.bity -= 8;
+            wyjscie.push_back((unsigned char)(stan.akumulator >> stan.bity));
+        }
+    }
+}
+
+
+// Nieujemna liczba big-endian (INTEGER z DER, mpint z SSH)
+static bool liczba_big_endian(const unsigned char* p, size_t dlugosc, ZZ& x, std::vector<unsigned char>& bufor)
+{
+    if (dlugosc == 0 || (p[0] & 0x80))
+    {
+        return false;
+    }
+    while (dlugosc > 0 && p[0] == 0)
+    {
+        p++;
+        dlugosc--;
+    }
+    bufor.resize(dlugosc);
+    for (size_t i = 0; i < dlugosc; i++)
+    {
+        bufor[i] = p[dlugosc - 1 - i];
+    }
+    ZZFromBytes(x, bufor.data(), dlugosc);
+    return true;
+}
+
+
+static bool poprawny_klucz(const ZZ& e, const ZZ& N)
+{
+    return !IsZero(e) && N > 1;
+}
+
+
+// Element TLV z DER (tylko znaczniki jednobajtowe i dlugosci okreslone)
+static bool element(const unsigned char*& p, const unsigned char* koniec, int& znacznik, const unsigned char*& tresc,
+                    size_t& dlugosc)
+{
+    if (koniec - p < 2 || (p[0] & 0x1f) == 0x1f)
+    {
+        return false;
+    }
+    znacznik = *p++;
+    size_t d = *p++;
+    if (d & 0x80)
+    {
+        size_t bajty = d & 0x7f;
+        if (bajty == 0 || bajty > sizeof(size_t) || (size_t)(koniec - p) < bajty)
+        {
+            return false;
+        }
+        for (d = 0; bajty > 0; bajty--)
+        {
+            d = d << 8 | *p++;
+        }
+    }
+    if (d > (size_t)(koniec - p))
+    {
+        return false;
+    }
+    tresc = p;
+    dlugosc = d;
+    p += d;
+    return true;
+}
+
+
+static bool element(const unsigned char*& p, const unsigned char* koniec, int znacznik, const unsigned char*& tresc,
+                    const unsigned char*& koniec_tresci)
+{
+    int z;
+    size_t dlugosc;
+    if (!element(p, koniec, z, tresc, dlugosc) || z != znacznik)
+    {
+        return false;
+    }
+    koniec_tresci = tresc + dlugosc;
+    return true;
+}
+
+
+static const int DER_INTEGER = 0x02, DER_BIT_STRING = 0x03, DER_OID = 0x06, DER_SEQUENCE = 0x30;
+static const int DER_WERSJA_CERTYFIKATU = 0xa0;
+
+// 1.2.840.113549.1.1.1 (rsaEncryption) i 1.2.840.113549.1.1.10 (RSASSA-PSS)
+static const unsigned char OID_RSA[] = { 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x01 };
+static const unsigned char OID_RSA_PSS[] = { 0x2a, 0x86, 0x48, 0x86, 0xf7, 0x0d, 0x01, 0x01, 0x0a };
+
+
+// RSAPublicKey ::= SEQUENCE { modulus INTEGER, publicExponent INTEGER }
+static bool z_pkcs1(const unsigned char* p, const unsigned char* koniec, ZZ& e, ZZ& N,
+                    std::vector<unsigned char>& bufor)
+{
+    const unsigned char *tresc, *koniec_tresci;
+    return element(p, koniec, DER_INTEGER, tresc, koniec_tresci)
+           && liczba_big_endian(tresc, koniec_tresci - tresc, N, bufor)
+           && element(p, koniec, DER_INTEGER, tresc, koniec_tresci)
+           && liczba_big_endian(tresc, koniec_tresci - tresc, e, bufor)
+           && p == koniec;
+}
+
+
+// SubjectPublicKeyInfo ::= SEQUENCE { algorithm AlgorithmIdentifier,
+//                                     subjectPublicKey BIT STRING }
+static bool z_spki(const unsigned char* p, const unsigned char* koniec, ZZ& e, ZZ& N,
+                   std::vector<unsigned char>& bufor)
+{
+    const unsigned char *algorytm, *koniec_algorytmu, *oid, *koniec_oid, *bity, *koniec_bitow, *klucz, *koniec_klucza;
+    if (!element(p, koniec, DER_SEQUENCE, algorytm, koniec_algorytmu)
+        || !element(algorytm, koniec_algorytmu, DER_OID, oid, koniec_oid))
+    {
+        return false;
+    }
+    size_t dlugosc_oid = koniec_oid - oid;
+    if (!(dlugosc_oid == sizeof(OID_RSA) && memcmp(oid, OID_RSA, sizeof(OID_RSA)) == 0)
+        && !(dlugosc_oid == sizeof(OID_RSA_PSS) && memcmp(oid, OID_RSA_PSS, sizeof(OID_RSA_PSS)) == 0))
+    {
+        return false;
+    }
+    // pierwszy bajt BIT STRING to liczba nieuzywanych bitow, dla klucza 0
+    if (!element(p, koniec, DER_BIT_STRING, bity, koniec_bitow) || bity == koniec_bitow || *bity != 0)
+    {
+        return false;
+    }
+    bity++;
+    return element(bity, koniec_bitow, DER_SEQUENCE, klucz, koniec_klucza) && bity == koniec_bitow
+           && z_pkcs1(klucz, koniec_klucza, e, N, bufor);
+}
+
+
+// TBSCertificate ::= SEQUENCE { [0] version OPTIONAL, serialNumber, signature,
+//                               issuer, validity, subject, subjectPublicKeyInfo, ... }
+static bool z_certyfikatu(const unsigned char* p, const unsigned char* koniec, ZZ& e, ZZ& N,
+                          std::vector<unsigned char>& bufor)
+{
+    const unsigned char *tresc, *koniec_tresci;
+    int znacznik;
+    size_t dlugosc;
+    if (!element(p, koniec, DER_SEQUENCE, tresc, koniec_tresci))
+    {
+        return false;
+    }
+    p = tresc;
+    koniec = koniec_tresci;
+    if (p < koniec && *p == DER_WERSJA_CERTYFIKATU && !element(p, koniec, znacznik, tresc, dlugosc))
+    {
+        return false;
+    }
+    if (!element(p, koniec, DER_INTEGER, tresc, koniec_tresci))
+    {
+        return false;
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        if (!element(p, koniec, DER_SEQUENCE, tresc, koniec_tresci))
+        {
+            return false;
+        }
+    }
+    return element(p, koniec, DER_SEQUENCE, tresc, koniec_tresci) && z_spki(tresc, koniec_tresci, e, N, bufor);
+}
+
+
+bool klucz_z_der(const unsigned char* der, size_t dlugosc, ZZ& e, ZZ& N, std::vector<unsigned char>& bufor)
+{
+    const unsigned char *p = der, *koniec = der + dlugosc, *tresc, *koniec_tresci;
+    if (!element(p, koniec, DER_SEQUENCE, tresc, koniec_tresci) || p != koniec || tresc == koniec_tresci)
+    {
+        return false;
+    }
+    bool znaleziono;
+    if (*tresc == DER_INTEGER)
+    {
+        znaleziono = z_pkcs1(tresc, koniec_tresci, e, N, bufor);
+    }
+    else
+    {
+        // SPKI zaczyna sie od AlgorithmIdentifier, po ktorym jest BIT STRING;
+        // w certyfikacie pierwszym elementem jest tbsCertificate
+        const unsigned char *q = tresc, *pomijany, *koniec_pomijanego;
+        bool spki = element(q, koniec_tresci, DER_SEQUENCE, pomijany, koniec_pomijanego)
+                    && q < koniec_tresci && *q == DER_BIT_STRING;
+        znaleziono = spki ? z_spki(tresc, koniec_tresci, e, N, bufor) : z_certyfikatu(tresc, koniec_tresci, e, N, bufor);
+    }
+    return znaleziono && poprawny_klucz(e, N);
+}
+
+
+// string z formatu SSH: uint32 dlugosc (big-endian) i bajty
+static bool napis_ssh(const unsigned char*& p, const unsigned char* koniec, const unsigned char*& tresc,
+                      size_t& dlugosc)
+{
+    if (koniec - p < 4)
+    {
+        return false;
+    }
+    dlugosc = (size_t)p[0] << 24 | (size_t)p[1] << 16 | (size_t)p[2] << 8 | p[3];
+    p += 4;
+    if (dlugosc > (size_t)(koniec - p))
+    {
+        return false;
+    }
+    tresc = p;
+    p += dlugosc;
+    return true;
+}
+
+
+static bool rowny(const unsigned char* tresc, size_t dlugosc, const char* napis)
+{
+    return dlugosc == strlen(napis) && memcmp(tresc, napis, dlugosc) == 0;
+}
+
+
+static const char* SSH_RSA = "ssh-rsa";
+static const char* SSH_RSA_CERT = "ssh-rsa-cert-v01@openssh.com";
+
+
+bool klucz_z_ssh(const unsigned char* dane, size_t dlugosc, ZZ& e, ZZ& N, std::vector<unsigned char>& bufor)
+{
+    const unsigned char *p = dane, *koniec = dane + dlugosc, *tresc;
+    size_t d;
+    if (!napis_ssh(p, koniec, tresc, d))
+    {
+        return false;
+    }
+    // certyfikat: typ, nonce, e, N, ... (PROTOCOL.certkeys)
+    if (rowny(tresc, d, SSH_RSA_CERT))
+    {
+        if (!napis_ssh(p, koniec, tresc, d))
+        {
+            return false;
+        }
+    }
+    else if (!rowny(tresc, d, SSH_RSA))
+    {
+        return false;
+    }
+    return napis_ssh(p, koniec, tresc, d) && liczba_big_endian(tresc, d, e, bufor)
+           && napis_ssh(p, koniec, tresc, d) && liczba_big_endian(tresc, d, N, bufor)
+           && poprawny_klucz(e, N);
+}
+
+
+bool CzytnikKluczy::otworz(const std::string& sciezka)
+{
+    plik.open(sciezka.c_str(), std::ios::binary);
+    if (!plik)
+    {
+        std::cerr << "Nie mozna odczytac pliku " << sciezka << std::endl;
+        return false;
+    }
+    der = plik.peek() == DER_SEQUENCE;
+    return true;
+}
+
+
+// Kolejna struktura DER z pliku binarnego
+bool CzytnikKluczy::nastepny_der(ZZ& e, ZZ& N)
+{
+    // za dlugi element oznacza uszkodzony plik, po ktorym nie da sie wrocic
+    // do poczatku kolejnej struktury
+    const size_t MAKS_DER = 1 << 24;
+    while (plik.peek() != EOF)
+    {
+        nr_linii++;
+        unsigned char naglowek[2 + sizeof(size_t)];
+        size_t dlugosc = 0, bajty = 0;
+        bool poprawny = (bool)plik.read((char*)naglowek, 2);
+        if (poprawny && (naglowek[1] & 0x80))
+        {
+            bajty = naglowek[1] & 0x7f;
+            poprawny = bajty > 0 && bajty <= sizeof(size_t) && plik.read((char*)naglowek + 2, bajty);
+            for (size_t i = 0; poprawny && i < bajty; i++)
+            {
+                dlugosc = dlugosc << 8 | naglowek[2 + i];
+            }
+        }
+        else
+        {
+            dlugosc = naglowek[1];
+        }
+        if (!poprawny || dlugosc > MAKS_DER)
+        {
+            std::cerr << "Uszkodzona struktura DER " << nr_linii << std::endl;
+            return false;
+        }
+        dane.assign(naglowek, naglowek + 2 + bajty);
+        dane.resize(2 + bajty + dlugosc);
+        if (!plik.read((char*)dane.data() + 2 + bajty, dlugosc))
+        {
+            std::cerr << "Uszkodzona struktura DER " << nr_linii << std::endl;
+            return false;
+        }
+        linia_klucza = nr_linii;
+        if (klucz_z_der(dane.data(), dane.size(), e, N, bufor))
+        {
+            return true;
+        }
+        std::cerr << "Pomijam niepoprawny klucz w strukturze DER " << nr_linii << std::endl;
+    }
+    return false;
+}
+
+
+static bool zaczyna_sie(const std::string& tekst, const char* poczatek)
+{
+    return tekst.compare(0, strlen(poczatek), poczatek) == 0;
+}
+
+
+// Etykiety blokow PEM z kluczem RSA
+static bool etykieta_rsa(const std::string& linia)
+{
+    return linia == "-----BEGIN RSA PUBLIC KEY-----" || linia == "-----BEGIN PUBLIC KEY-----"
+           || linia == "-----BEGIN CERTIFICATE-----" || linia == "-----BEGIN X509 CERTIFICATE-----"
+           || linia == "-----BEGIN TRUSTED CERTIFICATE-----";
+}
+
+
+bool CzytnikKluczy::nastepny(ZZ& e, ZZ& N)
+{
+    if (der)
+    {
+        return nastepny_der(e, N);
+    }
+    while (std::getline(plik, tekst))
+    {
+        nr_linii++;
+        if (!tekst.empty() && tekst[tekst.size() - 1] == '\r')
+        {
+            tekst.resize(tekst.size() - 1);
+        }
+
+        if (zaczyna_sie(tekst, "-----BEGIN "))
+        {
+            long poczatek = nr_linii;
+            bool rsa = etykieta_rsa(tekst);
+            bool zakonczony = false;
+            DekoderBase64 dekoder;
+            dane.clear();
+            while (!zakonczony && std::getline(plik, tekst))
+            {
+                nr_linii++;
+                zakonczony = zaczyna_sie(tekst, "-----END ");
+                // naglowki w stylu RFC 1421 (Proc-Type: ...) nie sa czescia danych
+                if (rsa && !zakonczony && tekst.find(':') == std::string::npos)
+                {
+                    dekoduj_base64(tekst.data(), tekst.data() + tekst.size(), dekoder, dane);
+                }
+            }
+            if (!rsa)
+            {
+                continue;
+            }
+            linia_klucza = poczatek;
+            if (zakonczony && dekoder.poprawny && klucz_z_der(dane.data(), dane.size(), e, N, bufor))
+            {
+                return true;
+            }
+            std::cerr << "Pomijam niepoprawny klucz w linii " << poczatek << std::endl;
+            continue;
+        }
+
+        // [opcje] ssh-rsa <base64> [komentarz]; slowa bez kopiowania linii
+        const char* p = tekst.data();
+        const char* koniec = p + tekst.size();
+        const char* typ = 0;
+        while (p < koniec && *p != '#')
+        {
+            while (p < koniec && (*p == ' ' || *p == '\t'))
+            {
+                p++;
+            }
+            const char* slowo = p;
+            while (p < koniec && *p != ' ' && *p != '\t')
+            {
+                p++;
+            }
+            if (typ)
+            {
+                DekoderBase64 dekoder;
+                dane.clear();
+                dekoduj_base64(slowo, p, dekoder, dane);
+                linia_klucza = nr_linii;
+                if (dekoder.poprawny && klucz_z_ssh(dane.data(), dane.size(), e, N, bufor))
+                {
+                    return true;
+                }
+                std::cerr << "Pomijam niepoprawny klucz w linii " << nr_linii << std::endl;
+                break;
+            }
+            size_t dlugosc = p - slowo;
+            if ((dlugosc == strlen(SSH_RSA) && memcmp(slowo, SSH_RSA, dlugosc) == 0)
+                || (dlugosc == strlen(SSH_RSA_CERT) && memcmp(slowo, SSH_RSA_CERT, dlugosc) == 0))
+            {
+                typ = slowo;
+            }
+        }
+    }
+    return false;
+}
+
+
+bool jest_plikiem_kluczy(const std::string& sciezka)
+{
+    std::ifstream plik(sciezka.c_str(), std::ios::binary);
+    char poczatek[4096];
+    plik.read(poczatek, sizeof(poczatek));
+    std::string tekst(poczatek, plik.gcount());
+    return (!tekst.empty() && (unsigned char)tekst[0] == DER_SEQUENCE)
+           || tekst.find("-----BEGIN ") != std::string::npos
+           || tekst.find(std::string(SSH_RSA) + " ") != std::string::npos
+           || tekst.find(std::string(SSH_RSA_CERT) + " ") != std::string::npos;
+}
+
+
+bool wczytaj_klucze_publiczne(const std::string& sciezka, vector<KluczWsadu>& klucze)
+{
+    CzytnikKluczy czytnik;
+    if (!czytnik.otworz(sciezka))
+    {
+        return false;
+    }
+    KluczWsadu klucz;
+    while (czytnik.nastepny(klucz.e, klucz.N))
+    {
+        klucz.bin_size = NumBits(klucz.N);
+        klucze.push_back(klucz);
+    }
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef WIENER_KEY_IMPORT_H
+#define WIENER_KEY_IMPORT_H
+
+#include <string>
+#include <fstream>
+#include "batch.h"
+
+// Klucze publiczne RSA w formatach, w jakich zwykle sa zbierane:
+//
+//   PEM  -----BEGIN RSA PUBLIC KEY----- (PKCS#1 RSAPublicKey)
+//        -----BEGIN PUBLIC KEY-----     (SubjectPublicKeyInfo, rsaEncryption
+//                                        lub RSASSA-PSS)
+//        -----BEGIN CERTIFICATE-----    (X.509, klucz z tbsCertificate)
+//   SSH  linie ssh-rsa (takze z opcjami authorized_keys przed typem klucza)
+//        oraz certyfikaty ssh-rsa-cert-v01@openssh.com
+//   DER  sklejone binarne struktury DER powyzszych typow
+//
+// Base64 dekodowany jest do bufora wielokrotnego uzytku, a DER i format SSH
+// czytane w miejscu: bajty modulu i wykladnika (big-endian) trafiaja do
+// ZZFromBytes bez posrednich napisow. Plik czytany jest po kolei, wiec pamiec
+// nie zalezy od liczby kluczy w pliku.
+
+// Klucz z DER: RSAPublicKey, SubjectPublicKeyInfo albo Certificate
+bool klucz_z_der(const unsigned char* der, size_t dlugosc, ZZ& e, ZZ& N, std::vector<unsigned char>& bufor);
+
+// Klucz z formatu SSH (RFC 4253, 6.6): ssh-rsa albo certyfikat ssh-rsa
+bool klucz_z_ssh(const unsigned char* dane, size_t dlugosc, ZZ& e, ZZ& N, std::vector<unsigned char>& bufor);
+
+// Kolejne klucze RSA z pliku PEM/SSH lub DER. Bloki PEM innych typow i linie
+// bez klucza sa pomijane; uszkodzone klucze sa pomijane z komunikatem.
+class CzytnikKluczy
+{
+public:
+    CzytnikKluczy() : nr_linii(0), linia_klucza(0), der(false) {}
+
+    bool otworz(const std::string& sciezka);
+
+    // false na koncu pliku
+    bool nastepny(ZZ& e, ZZ& N);
+
+    // Linia pliku (albo numer struktury DER), w ktorej zaczyna sie ostatni klucz
+    long linia() const
+    {
+        return linia_klucza;
+    }
+
+private:
+    bool nastepny_der(ZZ& e, ZZ& N);
+
+    std::ifstream plik;
+    std::string tekst;
+    std::vector<unsigned char> dane, bufor;
+    long nr_linii, linia_klucza;
+    bool der;
+};
+
+// Czy plik zaczyna sie jak PEM, linia OpenSSH albo struktura DER
+bool jest_plikiem_kluczy(const std::string& sciezka);
+
+// Dopisuje wszystkie klucze z pliku (bin_size = NumBits(N))
+bool wczytaj_klucze_publiczne(const std::string& sciezka, vector<KluczWsadu>& klucze);
+
+#endif
@@ -0,0 +1,233 @@
+#include <cmath>
+#include "lanes.h"
+
+typedef unsigned long long Slowo;
+typedef unsigned __int128 Podwojne;
+typedef __int128 PodwojneZeZnakiem;
+
+
+static long bity_slowa(Slowo a)
+{
+    return a == 0 ? 0 : 64 - __builtin_clzll(a);
+}
+
+static long bity_podwojne(Podwojne a)
+{
+    Slowo gora = (Slowo)(a >> 64);
+    return gora != 0 ? 64 + bity_slowa(gora) : bity_slowa((Slowo)a);
+}
+
+// floor(sqrt(a)) z przyblizenia w long double poprawianego o jednosci
+static Podwojne pierwiastek_podwojny(Podwojne a)
+{
+    Podwojne x = (Podwojne)std::sqrt((long double)a);
+    while (x * x > a)
+    {
+        x--;
+    }
+    while ((x + 1) * (x + 1) <= a)
+    {
+        x++;
+    }
+    return x;
+}
+
+// Sito kwadratow (perfect_square.h) dla liczby w dwoch slowach
+static bool moze_byc_kwadratem_podwojne(Podwojne a)
+{
+    const SitoKwadratow& sito = SitoKwadratow::instancja();
+    return sito.mod256((long)(a & 255))
+        && sito.mod1((long)(a % SitoKwadratow::MODUL_1))
+        && sito.mod2((long)(a % SitoKwadratow::MODUL_2));
+}
+
+
+bool pasuje_do_pasm(const ZZ& e, const ZZ& N, const UstawieniaAtaku& ustawienia)
+{
+    return NumBits(N) <= 64 && NumBits(e) <= 64 && !IsZero(e) && sign(e) > 0 && sign(N) > 0
+           && ustawienia.obciecie == 0 && ustawienia.rozszerzenie.bity <= 0 && !ustawienia.pomiary
+           && !ustawienia.budzet.ustawiony();
+}
+
+
+// sprawdz_redukt() na slowach. Zwraca 1 dla rozkladu N (q = drugi czynnik),
+// 0 dla odrzuconego reduktu, -1 gdy wartosc posrednia nie miesci sie w 128 bitach.
+static int sprawdz_redukt_pasma(Slowo e, Slowo N, Slowo k, Slowo d, Slowo& q,
+                                const FiltryReduktow& filtry, StatystykiAtaku& statystyki)
+{
+    statystyki.redukty++;
+    if (k == 0)
+    {
+        statystyki.odrzucone_k_zero++;
+        return 0;
+    }
+    if (filtry.nieparzyste_d && !(d & 1))
+    {
+        statystyki.odrzucone_nieparzyste_d++;
+        return 0;
+    }
+    if (filtry.parzyste_phi)
+    {
+        Slowo ed_1 = e * d - 1;
+        if (ed_1 != 0 && __builtin_ctzll(ed_1) < __builtin_ctzll(k) + 2)
+        {
+            statystyki.odrzucone_parzyste_phi++;
+            return 0;
+        }
+    }
+    long bity_N = bity_slowa(N);
+    if (filtry.przedzial_phi)
+    {
+        long bity_ed = bity_slowa(e) + bity_slowa(d);
+        long bity_k = bity_slowa(k);
+        if (bity_ed - bity_k + 1 < bity_N - 1 || bity_ed - bity_k - 2 > bity_N)
+        {
+            statystyki.odrzucone_dlugosc_phi++;
+            return 0;
+        }
+    }
+    policz(statystyki.pomiary.dzielenia);
+    Podwojne ed_1 = (Podwojne)e * d - 1;
+    if (ed_1 % k != 0)
+    {
+        statystyki.odrzucone_dzielenie++;
+        return 0;
+    }
+    Podwojne phiN = ed_1 / k;
+    if (phiN >> 126)
+    {
+        return -1;
+    }
+    PodwojneZeZnakiem s = (PodwojneZeZnakiem)N - (PodwojneZeZnakiem)phiN + 1;
+    Podwojne modul_s = s < 0 ? -(Podwojne)s : (Podwojne)s;
+    if (filtry.przedzial_phi && (s <= 0 || bity_podwojne(modul_s) > (bity_N + 1) / 2 + 2))
+    {
+        statystyki.odrzucone_przedzial_phi++;
+        return 0;
+    }
+    if (modul_s >> 62)
+    {
+        return -1;
+    }
+    PodwojneZeZnakiem delta = s * s - 4 * (PodwojneZeZnakiem)N;
+    if (delta < 0 || !moze_byc_kwadratem_podwojne((Podwojne)delta))
+    {
+        statystyki.odrzucone_delta++;
+        return 0;
+    }
+    policz(statystyki.pomiary.pierwiastki);
+    Podwojne pierwiastek = pierwiastek_podwojny((Podwojne)delta);
+    if (pierwiastek * pierwiastek != (Podwojne)delta)
+    {
+        statystyki.odrzucone_delta++;
+        return 0;
+    }
+    PodwojneZeZnakiem p = s + (PodwojneZeZnakiem)pierwiastek;
+    if (p & 1)
+    {
+        statystyki.odrzucone_pierwiastek++;
+        return 0;
+    }
+    p >>= 1;
+    if (p <= 0 || (Podwojne)p > N || N % (Slowo)p != 0)
+    {
+        statystyki.odrzucone_pierwiastek++;
+        return 0;
+    }
+    q = N / (Slowo)p;
+    return 1;
+}
+
+
+void atak_pasmowy(KluczPasma* klucze, long liczba, const UstawieniaAtaku& ustawienia)
+{
+    // Stan pasm: reszty u, v rozwiniecia e/N i dwa ostatnie redukty P/Q
+    Slowo u[MAKS_PASM], v[MAKS_PASM], P[MAKS_PASM], P_1[MAKS_PASM], Q[MAKS_PASM], Q_1[MAKS_PASM];
+    Slowo granica_wienera[MAKS_PASM];
+    long indeks[MAKS_PASM];
+    bool aktywne[MAKS_PASM];
+    const GranicaSzukania& granica = ustawienia.granica;
+
+    long liczba_aktywnych = liczba;
+    for (long i = 0; i < liczba; i++)
+    {
+        KluczPasma& klucz = klucze[i];
+        klucz.statystyki = StatystykiAtaku();
+        klucz.wynik = PASMO_NIE_ZNALEZIONO;
+        u[i] = klucz.e;
+        v[i] = klucz.N;
+        P[i] = 1;
+        P_1[i] = 0;
+        Q[i] = 0;
+        Q_1[i] = 1;
+        indeks[i] = -1;
+        aktywne[i] = true;
+        if (granica.wiener)
+        {
+            // floor(N^(1/4) / 3) jak w przeszukaj_redukty()
+            granica_wienera[i] = (Slowo)pierwiastek_podwojny(pierwiastek_podwojny(klucz.N)) / 3;
+        }
+    }
+
+    while (liczba_aktywnych > 0)
+    {
+        // Kolejny wyraz i redukt we wszystkich aktywnych pasmach
+        for (long i = 0; i < liczba; i++)
+        {
+            if (!aktywne[i])
+            {
+                continue;
+            }
+            if (v[i] == 0)
+            {
+                aktywne[i] = false;
+                liczba_aktywnych--;
+                continue;
+            }
+            Slowo a = u[i] / v[i];
+            Slowo r = u[i] - a * v[i];
+            u[i] = v[i];
+            v[i] = r;
+            Slowo t = a * P[i] + P_1[i];
+            P_1[i] = P[i];
+            P[i] = t;
+            t = a * Q[i] + Q_1[i];
+            Q_1[i] = Q[i];
+            Q[i] = t;
+            indeks[i]++;
+        }
+
+        // Granice i sprawdzenie reduktu
+        for (long i = 0; i < liczba; i++)
+        {
+            if (!aktywne[i])
+            {
+                continue;
+            }
+            KluczPasma& klucz = klucze[i];
+            if ((granica.wiener && granica_wienera[i] < Q[i])
+                || (granica.max_bity_d > 0 && bity_slowa(Q[i]) > granica.max_bity_d)
+                || (granica.max_indeks >= 0 && indeks[i] > granica.max_indeks))
+            {
+                klucz.statystyki.przerwane_granica++;
+                aktywne[i] = false;
+                liczba_aktywnych--;
+                continue;
+            }
+            int wynik = sprawdz_redukt_pasma(klucz.e, klucz.N, P[i], Q[i], klucz.q, ustawienia.filtry,
+                                             klucz.statystyki);
+            if (wynik != 0)
+            {
+                klucz.wynik = wynik > 0 ? PASMO_ZNALEZIONO : PASMO_REZYGNACJA;
+                klucz.d = Q[i];
+                aktywne[i] = false;
+                liczba_aktywnych--;
+            }
+        }
+    }
+
+    for (long i = 0; i < liczba; i++)
+    {
+        policz(klucze[i].statystyki.pomiary.wyrazy, indeks[i] + 1);
+    }
+}
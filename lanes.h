@@ -0,0 +1,46 @@
+#ifndef WIENER_LANES_H
+#define WIENER_LANES_H
+
+#include "attack.h"
+
+// Atak Wienera na kilka kluczy jednoslowowych naraz (N < 2^64). Kazdy klucz
+// ma swoje pasmo: reszty Euklidesa, redukty i stan w tablicach po pasmach,
+// iloczyny e*d i s^2 w __int128. Kolejne kroki rozwiniecia wykonywane sa dla
+// wszystkich aktywnych pasm po kolei, wiec dzielenia i rekurencje roznych
+// kluczy sa od siebie niezalezne i nakladaja sie w potoku procesora; pasmo
+// konczy sie (wypada z maski aktywnych) po znalezieniu d, granicy lub koncu
+// rozwiniecia. Dla tak krotkich kluczy caly atak to kilkaset operacji na
+// slowach, a pojedyncze wywolanie atak() jest w wiekszosci narzutem.
+//
+// AVX2/AVX-512 nie maja dzielenia calkowitego, a kazdy wyraz rozwiniecia
+// to jedno dzielenie, dlatego pasma sa skalarne, przeplatane.
+//
+// Redukty, filtry i liczniki sa takie jak w sprawdz_redukt(), wiec wynik
+// i statystyki klucza nie zaleza od tego, czy byl atakowany w pasmie.
+
+const long MAKS_PASM = 16;
+
+enum WynikPasma
+{
+    PASMO_NIE_ZNALEZIONO,
+    PASMO_ZNALEZIONO,
+    PASMO_REZYGNACJA     // posredni wynik poza 128 bitami (tylko bez filtru przedzial_phi):
+                         // klucz trzeba zaatakowac zwykla sciezka
+};
+
+struct KluczPasma
+{
+    unsigned long long e, N;
+    unsigned long long d, q;    // wynik dla PASMO_ZNALEZIONO
+    WynikPasma wynik;
+    StatystykiAtaku statystyki;
+};
+
+// Czy klucz miesci sie w pasmie, a ustawienia nie wymagaja niczego, czego pasma
+// nie robia (obciete rozwiniecie, etap rozszerzony, czasy faz, budzet ataku)
+bool pasuje_do_pasm(const ZZ& e, const ZZ& N, const UstawieniaAtaku& ustawienia);
+
+// Atakuje liczba <= MAKS_PASM kluczy; statystyki kazdego klucza od zera
+void atak_pasmowy(KluczPasma* klucze, long liczba, const UstawieniaAtaku& ustawienia);
+
+#endif
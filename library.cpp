@@ -0,0 +1,63 @@
+#include <algorithm>
+#include "library.h"
+
+
+// Kontekst stalej szerokosci dostaje klucze dluzsze niz polowa jego
+// szerokosci (atak_staly()), wiec rezerwowane sa tylko te, ktorych uzyje
+// klucz o module do bity bitow
+template <class Liczba>
+static void przygotuj_staly(KontekstAtaku<Liczba>& kontekst, long szerokosc, long bity)
+{
+    if (szerokosc / 2 < bity)
+    {
+        kontekst.przygotuj(std::min(szerokosc, bity));
+    }
+}
+
+
+void przygotuj(KontekstWatku& kontekst, WynikAtaku& wynik, long bity)
+{
+    kontekst.ntl.przygotuj(bity);
+    kontekst.gmp.przygotuj(bity);
+    KontekstyStale& stale = kontekst.stale;
+    przygotuj_staly(stale.bity_64, 64, bity);
+    przygotuj_staly(stale.bity_128, 128, bity);
+    przygotuj_staly(stale.bity_256, 256, bity);
+    przygotuj_staly(stale.bity_512, 512, bity);
+    przygotuj_staly(stale.bity_1024, 1024, bity);
+    przygotuj_staly(stale.bity_2048, 2048, bity);
+    kontekst.bajty.reserve((bity + 7) / 8);
+    ZZ* liczby[] = { &wynik.p, &wynik.q, &wynik.d };
+    for (size_t i = 0; i < sizeof(liczby) / sizeof(liczby[0]); i++)
+    {
+        zarezerwuj(*liczby[i], bity);
+    }
+}
+
+
+StatusAtaku zaatakuj(const ZZ& e, const ZZ& N, KontekstWatku& kontekst, WynikAtaku& wynik,
+                     const UstawieniaAtaku& ustawienia)
+{
+    wynik.statystyki = StatystykiAtaku();
+    wynik.przerwanie = PrzerwanieBudzetu();
+    wynik.indeks = -1;
+    if (e < 1 || N < 2)
+    {
+        wynik.status = STATUS_BLEDNY_KLUCZ;
+        return wynik.status;
+    }
+    if (!atak(e, N, wynik.q, wynik.d, kontekst, ustawienia, wynik.statystyki))
+    {
+        wynik.status = STATUS_NIE_ZNALEZIONO;
+        if (wynik.statystyki.przerwane_budzet > 0)
+        {
+            wynik.status = STATUS_PRZEKROCZONY_BUDZET;
+            wynik.przerwanie = kontekst.termin.przerwanie;
+        }
+        return wynik.status;
+    }
+    div(wynik.p, N, wynik.q);
+    wynik.indeks = kontekst.indeks;
+    wynik.status = STATUS_ZNALEZIONO;
+    return wynik.status;
+}
@@ -0,0 +1,43 @@
+#ifndef WIENER_LIBRARY_H
+#define WIENER_LIBRARY_H
+
+#include "attack.h"
+
+// Interfejs biblioteki libwiener (libwiener.a i libwiener.so z build.sh) do
+// wolania ataku wprost z innych programow. Wywolujacy trzyma KontekstWatku
+// i WynikAtaku przez wiele wywolan: ich liczby rosna do najdluzszego
+// atakowanego klucza, wiec kolejne ataki na klucze nie dluzsze nie alokuja
+// pamieci (poza etapem rozszerzonym i potokiem reduktow, ktore maja wlasne
+// tablice i watki). Funkcje biblioteki nie pisza na stdout ani stderr.
+// Kontekst i wynik moga byc uzywane tylko przez jeden watek naraz;
+// rownolegle ataki wymagaja osobnej pary na watek.
+
+enum StatusAtaku
+{
+    STATUS_ZNALEZIONO,     // p, q i d ustawione
+    STATUS_NIE_ZNALEZIONO, // zaden redukt ani kandydat etapu rozszerzonego nie rozklada N
+    STATUS_PRZEKROCZONY_BUDZET, // budzet z ustawien wyczerpany przed koncem ataku (wynik.przerwanie)
+    STATUS_BLEDNY_KLUCZ    // e < 1 lub N < 2, klucz nie byl atakowany
+};
+
+struct WynikAtaku
+{
+    StatusAtaku status;
+    ZZ p, q, d;                 // N = p * q, d wykladnik prywatny; bez zmian, gdy nie znaleziono
+    long indeks;                // indeks reduktu k/d w rozwinieciu e/N, -1 = etap rozszerzony lub brak
+    StatystykiAtaku statystyki; // liczniki etapow tylko tego ataku
+    PrzerwanieBudzetu przerwanie; // miejsce wyczerpania budzetu dla STATUS_PRZEKROCZONY_BUDZET
+
+    WynikAtaku() : status(STATUS_NIE_ZNALEZIONO), indeks(-1) {}
+};
+
+// Rezerwuje pamiec kontekstu i wyniku na klucze o module do bity bitow, zeby
+// juz pierwszy atak nie alokowal
+void przygotuj(KontekstWatku& kontekst, WynikAtaku& wynik, long bity);
+
+// Atak Wienera (i etap rozszerzony z ustawien) na klucz (e, N) na kontekscie
+// wywolujacego; zwraca wynik.status
+StatusAtaku zaatakuj(const ZZ& e, const ZZ& N, KontekstWatku& kontekst, WynikAtaku& wynik,
+                     const UstawieniaAtaku& ustawienia = UstawieniaAtaku());
+
+#endif
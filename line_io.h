@@ -0,0 +1,87 @@
+#ifndef WIENER_LINE_IO_H
+#define WIENER_LINE_IO_H
+
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+// Protokoly tekstowe uslugi (service.h) i trybu rozproszonego (distributed.h):
+// linie rozdzielone znakiem nowej linii na deskryptorze pliku lub gniazda
+
+
+// Kolejne linie z deskryptora przez wlasny bufor. Linia dluzsza niz limit jest
+// pomijana do konca i zglaszana przez za_dluga.
+class CzytnikLinii
+{
+public:
+    CzytnikLinii(int plik, size_t limit) : plik(plik), limit(limit), poczatek(0), koniec(0) {}
+
+    bool nastepna(std::string& linia, bool& za_dluga)
+    {
+        linia.clear();
+        za_dluga = false;
+        bool cokolwiek = false;
+        for (;;)
+        {
+            const char* znak = (const char*)memchr(bufor + poczatek, '\n', koniec - poczatek);
+            size_t dlugosc = znak ? znak - (bufor + poczatek) : koniec - poczatek;
+            if (!za_dluga && linia.size() + dlugosc > limit)
+            {
+                za_dluga = true;
+                linia.clear();
+            }
+            if (!za_dluga)
+            {
+                linia.append(bufor + poczatek, dlugosc);
+            }
+            cokolwiek = cokolwiek || dlugosc > 0;
+            poczatek += dlugosc;
+            if (znak)
+            {
+                poczatek++;
+                return true;
+            }
+            ssize_t n = read(plik, bufor, sizeof(bufor));
+            if (n < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (n <= 0)
+            {
+                return cokolwiek;
+            }
+            poczatek = 0;
+            koniec = n;
+        }
+    }
+
+private:
+    int plik;
+    size_t limit;
+    size_t poczatek, koniec;
+    char bufor[1 << 16];
+};
+
+
+// Zapisuje caly tekst, ponawiajac przerwane i czesciowe zapisy
+inline bool zapisz_wszystko(int plik, const std::string& tekst)
+{
+    size_t zapisane = 0;
+    while (zapisane < tekst.size())
+    {
+        ssize_t n = write(plik, tekst.data() + zapisane, tekst.size() - zapisane);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return false;
+        }
+        zapisane += n;
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef WIENER_PERFECT_SQUARE_H
+#define WIENER_PERFECT_SQUARE_H
+
+// Sito kwadratow: odrzuca liczby, ktore nie sa resztami kwadratowymi modulo
+// malych modulow, zanim zostanie liczony pelny pierwiastek calkowity (w stylu
+// mpz_perfect_square_p). Najpierw sprawdzany jest najnizszy bajt (mod 256),
+// nastepnie reszta z dzielenia przez 45045 = 63 * 65 * 11 i przez
+// 17 * 19 * 23 * 29 * 31 * 37; kazda reszta to jedno przejscie po slowach
+// liczby. Przez sito przechodzi mniej niz 0.1% liczb niebedacych kwadratami.
+class SitoKwadratow
+{
+public:
+    static const long MODUL_1 = 63L * 65 * 11;
+    static const long MODUL_2 = 17L * 19 * 23 * 29 * 31 * 37;
+
+    static const SitoKwadratow& instancja()
+    {
+        static const SitoKwadratow sito;
+        return sito;
+    }
+
+    bool mod256(long r) const { return kwadraty_256[r]; }
+
+    bool mod1(long r) const
+    {
+        return kwadraty_63[r % 63] && kwadraty_65[r % 65] && kwadraty_11[r % 11];
+    }
+
+    bool mod2(long r) const
+    {
+        return kwadraty_17[r % 17] && kwadraty_19[r % 19] && kwadraty_23[r % 23]
+            && kwadraty_29[r % 29] && kwadraty_31[r % 31] && kwadraty_37[r % 37];
+    }
+
+private:
+    bool kwadraty_256[256], kwadraty_63[63], kwadraty_65[65], kwadraty_11[11];
+    bool kwadraty_17[17], kwadraty_19[19], kwadraty_23[23], kwadraty_29[29];
+    bool kwadraty_31[31], kwadraty_37[37];
+
+    static void wypelnij(bool* tablica, long modul)
+    {
+        for (long i = 0; i < modul; i++)
+        {
+            tablica[i] = false;
+        }
+        for (long i = 0; i < modul; i++)
+        {
+            tablica[(i * i) % modul] = true;
+        }
+    }
+
+    SitoKwadratow()
+    {
+        wypelnij(kwadraty_256, 256);
+        wypelnij(kwadraty_63, 63);
+        wypelnij(kwadraty_65, 65);
+        wypelnij(kwadraty_11, 11);
+        wypelnij(kwadraty_17, 17);
+        wypelnij(kwadraty_19, 19);
+        wypelnij(kwadraty_23, 23);
+        wypelnij(kwadraty_29, 29);
+        wypelnij(kwadraty_31, 31);
+        wypelnij(kwadraty_37, 37);
+    }
+};
+
+
+// Zwraca false, gdy nieujemne a na pewno nie jest kwadratem liczby calkowitej
+template <class Liczba>
+bool moze_byc_kwadratem(const Liczba& a)
+{
+    const SitoKwadratow& sito = SitoKwadratow::instancja();
+    return sito.mod256(trunc_long(a, 8))
+        && sito.mod1(rem(a, SitoKwadratow::MODUL_1))
+        && sito.mod2(rem(a, SitoKwadratow::MODUL_2));
+}
+
+#endif
@@ -0,0 +1,366 @@
+#include <iostream>
+#include <sstream>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "service.h"
+#include "thread_pool.h"
+#include "line_io.h"
+#include "cache.h"
+
+
+enum StanOdpowiedzi
+{
+    ODPOWIEDZ_ZNALEZIONO,
+    ODPOWIEDZ_NIE_ZNALEZIONO,
+    ODPOWIEDZ_PRZEKROCZONY_BUDZET,
+    ODPOWIEDZ_BLAD
+};
+
+struct Odpowiedz
+{
+    std::string id;
+    StanOdpowiedzi stan;
+    ZZ d;
+    long long czas_ns;
+    PrzerwanieBudzetu przerwanie;
+    std::string blad;
+};
+
+
+// Polaczenie z jednym nadawca zapytan. oczekujace liczy zapytania w toku i
+// watek czytajacy; kto zmniejszy licznik do zera, zamyka kolejke odpowiedzi,
+// dzieki czemu watek piszacy konczy sie po ostatniej odpowiedzi. miejsca to
+// wolne miejsca kolejki odpowiedzi nie zajete przez zapytania w toku: watek
+// czytajacy zajmuje miejsce przed kazdym zapytaniem, a watek piszacy zwalnia
+// je po pobraniu odpowiedzi, wiec watek ataku nigdy nie czeka na nadawce,
+// ktory nie odbiera odpowiedzi.
+struct Polaczenie
+{
+    int wejscie, wyjscie;
+    bool gniazdo;
+    KolejkaOgraniczona<Odpowiedz> odpowiedzi;
+    std::atomic<long> oczekujace;
+
+    Polaczenie(int wejscie, int wyjscie, bool gniazdo, long pojemnosc)
+        : wejscie(wejscie), wyjscie(wyjscie), gniazdo(gniazdo), odpowiedzi(pojemnosc), oczekujace(1),
+          miejsca(pojemnosc > 0 ? pojemnosc : 1)
+    {
+    }
+
+    ~Polaczenie()
+    {
+        if (gniazdo)
+        {
+            close(wejscie);
+        }
+    }
+
+    void zajmij_miejsce()
+    {
+        std::unique_lock<std::mutex> blokada(blokada_miejsc);
+        while (miejsca == 0)
+        {
+            wolne_miejsce.wait(blokada);
+        }
+        miejsca--;
+    }
+
+    void zwolnij_miejsce()
+    {
+        std::lock_guard<std::mutex> blokada(blokada_miejsc);
+        miejsca++;
+        wolne_miejsce.notify_one();
+    }
+
+private:
+    long miejsca;
+    std::mutex blokada_miejsc;
+    std::condition_variable wolne_miejsce;
+};
+
+struct Zapytanie
+{
+    std::shared_ptr<Polaczenie> polaczenie;
+    std::string id;
+    KluczWsadu klucz;
+};
+
+
+static void zakoncz_zapytanie(Polaczenie& polaczenie)
+{
+    if (polaczenie.oczekujace.fetch_sub(1) == 1)
+    {
+        polaczenie.odpowiedzi.zamknij();
+    }
+}
+
+
+static bool liczba_dziesietna(const std::string& tekst, long max_bity, ZZ& x)
+{
+    // k cyfr to co najmniej 3.32 (k - 1) bitow
+    if (tekst.empty() || (long)tekst.size() > max_bity / 3 + 1)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < tekst.size(); i++)
+    {
+        if (tekst[i] < '0' || tekst[i] > '9')
+        {
+            return false;
+        }
+    }
+    conv(x, tekst.c_str());
+    return NumBits(x) <= max_bity;
+}
+
+
+// [id] e N; blad to powod odrzucenia wysylany w odpowiedzi
+static bool wczytaj_zapytanie(const std::string& linia, long numer, long max_bity, Zapytanie& zapytanie,
+                              std::string& blad)
+{
+    std::istringstream pola(linia);
+    std::vector<std::string> slowa;
+    std::string slowo;
+    while (pola >> slowo && slowa.size() <= 3)
+    {
+        slowa.push_back(slowo);
+    }
+    std::ostringstream kolejny;
+    kolejny << numer;
+    zapytanie.id = slowa.size() == 3 ? slowa[0] : kolejny.str();
+    if (slowa.size() != 2 && slowa.size() != 3)
+    {
+        blad = "expected [id] e N";
+        return false;
+    }
+    const std::string& e = slowa[slowa.size() - 2];
+    const std::string& N = slowa[slowa.size() - 1];
+    KluczWsadu& klucz = zapytanie.klucz;
+    if (!liczba_dziesietna(e, max_bity, klucz.e) || !liczba_dziesietna(N, max_bity, klucz.N))
+    {
+        blad = "e and N must be decimal numbers of at most --max-bits bits";
+        return false;
+    }
+    if (IsZero(klucz.e) || klucz.N <= 1)
+    {
+        blad = "e must be positive and N greater than 1";
+        return false;
+    }
+    klucz.bin_size = NumBits(klucz.N);
+    return true;
+}
+
+
+// Etap czytania: dzieli wejscie na linie, zamienia liczby i przekazuje
+// zapytania watkom ataku; bledne zapytania dostaja odpowiedz od razu
+static void czytaj_polaczenie(std::shared_ptr<Polaczenie> polaczenie, KolejkaOgraniczona<Zapytanie>* zapytania,
+                              const UstawieniaUslugi* ustawienia)
+{
+    CzytnikLinii czytnik(polaczenie->wejscie, 2 * (ustawienia->max_bity / 3 + 1) + 256);
+    std::string linia;
+    bool za_dluga;
+    long numer = 0;
+    while (czytnik.nastepna(linia, za_dluga))
+    {
+        if (!za_dluga && linia.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+        numer++;
+        polaczenie->zajmij_miejsce();
+        Zapytanie zapytanie;
+        Odpowiedz odpowiedz;
+        odpowiedz.stan = ODPOWIEDZ_BLAD;
+        if (za_dluga)
+        {
+            std::ostringstream kolejny;
+            kolejny << numer;
+            odpowiedz.id = kolejny.str();
+            odpowiedz.blad = "line too long";
+            polaczenie->odpowiedzi.wstaw(odpowiedz);
+            continue;
+        }
+        if (!wczytaj_zapytanie(linia, numer, ustawienia->max_bity, zapytanie, odpowiedz.blad))
+        {
+            odpowiedz.id = zapytanie.id;
+            polaczenie->odpowiedzi.wstaw(odpowiedz);
+            continue;
+        }
+        zapytanie.polaczenie = polaczenie;
+        polaczenie->oczekujace++;
+        if (!zapytania->wstaw(zapytanie))
+        {
+            zakoncz_zapytanie(*polaczenie);
+            break;
+        }
+    }
+    zakoncz_zapytanie(*polaczenie);
+}
+
+
+// Etap ataku: staly watek z wlasnym kontekstem dla kolejnych zapytan.
+// Z pamiecia wynikow klucz jest najpierw szukany w pamieci, a nowy wynik
+// od razu dopisywany do pliku.
+static void atakuj_zapytania(KolejkaOgraniczona<Zapytanie>* zapytania, const UstawieniaAtaku* ustawienia,
+                             PamiecWynikow* pamiec)
+{
+    KontekstWsadu kontekst;
+    Zapytanie zapytanie;
+    while (zapytania->pobierz(zapytanie))
+    {
+        const KluczWsadu& klucz = zapytanie.klucz;
+        WynikKlucza wynik;
+        if (pamiec && pamiec->znajdz(klucz.e, klucz.N, *ustawienia, wynik.znaleziono, wynik.d))
+        {
+            wynik.poprawny = wynik.znaleziono;
+            wynik.czas_ns = 0;
+        }
+        else
+        {
+            atakuj_klucz(klucz, *ustawienia, wynik, kontekst);
+            if (pamiec && !przekroczony_budzet(wynik) && (!wynik.znaleziono || wynik.poprawny))
+            {
+                pamiec->dodaj(klucz.e, klucz.N, *ustawienia, wynik.znaleziono, wynik.d);
+                pamiec->zapisz();
+            }
+        }
+        Odpowiedz odpowiedz;
+        odpowiedz.id = zapytanie.id;
+        odpowiedz.stan = wynik.znaleziono && wynik.poprawny ? ODPOWIEDZ_ZNALEZIONO
+                         : przekroczony_budzet(wynik)       ? ODPOWIEDZ_PRZEKROCZONY_BUDZET
+                                                            : ODPOWIEDZ_NIE_ZNALEZIONO;
+        odpowiedz.d = wynik.d;
+        odpowiedz.czas_ns = wynik.czas_ns;
+        odpowiedz.przerwanie = wynik.przerwanie;
+        zapytanie.polaczenie->odpowiedzi.wstaw(odpowiedz);
+        zakoncz_zapytanie(*zapytanie.polaczenie);
+        zapytanie.polaczenie.reset();
+    }
+}
+
+
+static void dopisz_odpowiedz(std::ostringstream& tekst, const Odpowiedz& odpowiedz)
+{
+    tekst << odpowiedz.id;
+    switch (odpowiedz.stan)
+    {
+    case ODPOWIEDZ_ZNALEZIONO:
+        tekst << " found " << odpowiedz.d << " " << odpowiedz.czas_ns / 1000.0;
+        break;
+    case ODPOWIEDZ_NIE_ZNALEZIONO:
+        tekst << " not_found " << odpowiedz.czas_ns / 1000.0;
+        break;
+    case ODPOWIEDZ_PRZEKROCZONY_BUDZET:
+        tekst << " timeout " << (odpowiedz.przerwanie.rozszerzenie ? "extension " : "convergent ")
+              << odpowiedz.przerwanie.indeks << " " << odpowiedz.przerwanie.bity_d << " "
+              << odpowiedz.czas_ns / 1000.0;
+        break;
+    default:
+        tekst << " error " << odpowiedz.blad;
+    }
+    tekst << "\n";
+}
+
+
+// Etap pisania: zbiera gotowe odpowiedzi w jeden zapis. Po rozlaczeniu
+// nadawcy odpowiedzi sa dalej odbierane, zeby nie zatrzymac watkow ataku.
+static void pisz_polaczenie(std::shared_ptr<Polaczenie> polaczenie)
+{
+    Odpowiedz odpowiedz;
+    bool polaczony = true;
+    while (polaczenie->odpowiedzi.pobierz(odpowiedz))
+    {
+        std::ostringstream tekst;
+        do
+        {
+            dopisz_odpowiedz(tekst, odpowiedz);
+            polaczenie->zwolnij_miejsce();
+        } while (tekst.tellp() < (1 << 16) && polaczenie->odpowiedzi.pobierz_bez_czekania(odpowiedz));
+        polaczony = polaczony && zapisz_wszystko(polaczenie->wyjscie, tekst.str());
+    }
+}
+
+
+static int obsluz_gniazdo(const UstawieniaUslugi& ustawienia, KolejkaOgraniczona<Zapytanie>& zapytania)
+{
+    sockaddr_un adres;
+    memset(&adres, 0, sizeof(adres));
+    adres.sun_family = AF_UNIX;
+    if (ustawienia.gniazdo.size() >= sizeof(adres.sun_path))
+    {
+        std::cerr << "Za dluga sciezka gniazda " << ustawienia.gniazdo << std::endl;
+        return 1;
+    }
+    strcpy(adres.sun_path, ustawienia.gniazdo.c_str());
+    int gniazdo = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(ustawienia.gniazdo.c_str());
+    if (gniazdo < 0 || bind(gniazdo, (const sockaddr*)&adres, sizeof(adres)) != 0 || listen(gniazdo, SOMAXCONN) != 0)
+    {
+        std::cerr << "Nie mozna otworzyc gniazda " << ustawienia.gniazdo << ": " << strerror(errno) << std::endl;
+        return 1;
+    }
+    for (;;)
+    {
+        int klient = accept(gniazdo, 0, 0);
+        if (klient < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            std::cerr << "Blad accept: " << strerror(errno) << std::endl;
+            return 1;
+        }
+        std::shared_ptr<Polaczenie> polaczenie(new Polaczenie(klient, klient, true, ustawienia.kolejka));
+        std::thread(pisz_polaczenie, polaczenie).detach();
+        std::thread(czytaj_polaczenie, polaczenie, &zapytania, &ustawienia).detach();
+    }
+}
+
+
+int uruchom_usluge(const UstawieniaUslugi& ustawienia)
+{
+    // Zapis do rozlaczonego gniazda ma zwrocic blad, a nie zakonczyc proces
+    signal(SIGPIPE, SIG_IGN);
+    PamiecWynikow pamiec;
+    if (!ustawienia.wsad.pamiec.empty() && !pamiec.otworz(ustawienia.wsad.pamiec))
+    {
+        return 1;
+    }
+    KolejkaOgraniczona<Zapytanie> zapytania(ustawienia.kolejka);
+    vector<std::thread> watki;
+    for (long t = 0; t < liczba_watkow_roboczych(ustawienia.wsad.watki); t++)
+    {
+        watki.push_back(std::thread(atakuj_zapytania, &zapytania, &ustawienia.wsad.atak,
+                                    ustawienia.wsad.pamiec.empty() ? (PamiecWynikow*)0 : &pamiec));
+    }
+
+    int wynik = 0;
+    if (!ustawienia.gniazdo.empty())
+    {
+        wynik = obsluz_gniazdo(ustawienia, zapytania);
+    }
+    else
+    {
+        std::shared_ptr<Polaczenie> polaczenie(new Polaczenie(0, 1, false, ustawienia.kolejka));
+        std::thread pisarz(pisz_polaczenie, polaczenie);
+        czytaj_polaczenie(polaczenie, &zapytania, &ustawienia);
+        polaczenie.reset();
+        pisarz.join();
+    }
+
+    zapytania.zamknij();
+    for (size_t t = 0; t < watki.size(); t++)
+    {
+        watki[t].join();
+    }
+    return wynik;
+}
@@ -0,0 +1,44 @@
+#ifndef WIENER_SERVICE_H
+#define WIENER_SERVICE_H
+
+#include <string>
+#include "batch.h"
+
+// Tryb uslugi: proces dziala stale i odpowiada na zapytania rozdzielone
+// znakiem nowej linii, z stdin albo z gniazda uniksowego.
+//
+//   zapytanie:  [id] e N          (pola rozdzielone spacja lub tabulatorem)
+//   odpowiedz:  id found d time_us
+//               id not_found time_us
+//               id timeout convergent|extension indeks bity_d time_us
+//               id error powod
+//
+// Bez id kolejne zapytania polaczenia numerowane sa od 1. Odpowiedzi wypisywane
+// sa w kolejnosci zakonczenia ataku, nie zapytan. Z --cache klucz znaleziony
+// w pamieci wynikow (cache.h) dostaje odpowiedz bez ataku, z time_us = 0.
+// Z --time-budget-us lub --step-budget atak, ktory wyczerpal budzet, konczy
+// sie odpowiedzia timeout z indeksem ostatniego reduktu (lub pary reduktow
+// etapu rozszerzonego) i dlugoscia bitowa ostatniego d; taki wynik nie trafia
+// do pamieci wynikow.
+//
+// Kazde polaczenie ma watek czytajacy (podzial linii i konwersja liczb) i watek
+// piszacy; miedzy nimi stale watki ataku ze swoim kontekstem (KontekstWsadu).
+// Etapy lacza kolejki o ograniczonej pojemnosci: przy przeciazeniu czytanie
+// wstrzymuje sie i nadawca czeka na zapisie, zamiast rosnac pamiec uslugi.
+// Polaczenie ma w toku najwyzej tyle zapytan, ile miesci jego kolejka
+// odpowiedzi, wiec nadawca, ktory nie odbiera odpowiedzi, wstrzymuje tylko
+// wlasne czytanie, a nie watki ataku wspolne dla wszystkich polaczen.
+struct UstawieniaUslugi
+{
+    UstawieniaWsadu wsad;  // watki ataku (--threads) i ustawienia ataku
+    std::string gniazdo;   // sciezka gniazda uniksowego, pusta = stdin/stdout
+    long kolejka;          // pojemnosc kazdej kolejki miedzy etapami
+    long max_bity;         // dluzsze e lub N odrzucane jako error
+
+    UstawieniaUslugi() : kolejka(1024), max_bity(65536) {}
+};
+
+// Obsluguje stdin do jego konca albo gniazdo do zakonczenia procesu
+int uruchom_usluge(const UstawieniaUslugi& ustawienia);
+
+#endif
@@ -0,0 +1,200 @@
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <chrono>
+#include "shared_modulus.h"
+#include "thread_pool.h"
+
+
+bool wczytaj_wspolny_modul(const std::string& sciezka, ZZ& N, vector<WykladnikModulu>& wykladniki)
+{
+    std::ifstream plik(sciezka.c_str());
+    if (!plik)
+    {
+        std::cerr << "Nie mozna odczytac pliku " << sciezka << std::endl;
+        return false;
+    }
+    std::string linia;
+    long nr_linii = 0;
+    bool z_modulem = false;
+    while (std::getline(plik, linia))
+    {
+        nr_linii++;
+        if (linia.empty())
+        {
+            continue;
+        }
+        if (!z_modulem)
+        {
+            std::istringstream(linia) >> N;
+            if (N < 2)
+            {
+                std::cerr << "Niepoprawny modul w linii " << nr_linii << std::endl;
+                return false;
+            }
+            z_modulem = true;
+            continue;
+        }
+        WykladnikModulu wykladnik;
+        size_t tabulator = linia.find('\t');
+        std::istringstream(linia.substr(0, tabulator)) >> wykladnik.e;
+        if (tabulator != std::string::npos)
+        {
+            std::istringstream(linia.substr(tabulator + 1)) >> wykladnik.d;
+        }
+        if (sign(wykladnik.e) <= 0)
+        {
+            std::cerr << "Pomijam niepoprawny wykladnik w linii " << nr_linii << std::endl;
+            continue;
+        }
+        wykladniki.push_back(wykladnik);
+    }
+    if (!z_modulem)
+    {
+        std::cerr << "Brak modulu w pliku " << sciezka << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+// phi(N) = N - p - q + 1 dla czynnika q
+static void phi_z_czynnika(const ZZ& N, const ZZ& q, ZZ& p, ZZ& phiN)
+{
+    div(p, N, q);
+    sub(phiN, N, p);
+    sub(phiN, phiN, q);
+    add(phiN, phiN, 1);
+}
+
+
+bool atakuj_wykladniki(const ZZ& N, const vector<WykladnikModulu>& wykladniki, const UstawieniaWsadu& ustawienia,
+                       vector<WynikKlucza>& wyniki, ZZ& q)
+{
+    wyniki.assign(wykladniki.size(), WynikKlucza());
+    // Czynnik z kazdego wyniku; wybierany jest pierwszy poprawny w kolejnosci
+    // z pliku, wiec q nie zalezy od liczby watkow
+    vector<ZZ> czynniki(wykladniki.size());
+    long watki = liczba_watkow_roboczych(ustawienia.watki);
+    vector<KontekstWsadu> konteksty(watki);
+    vector<long> kolejnosc(wykladniki.size());
+    for (long i = 0; i < (long)kolejnosc.size(); i++)
+    {
+        kolejnosc[i] = i;
+    }
+
+    wykonaj_rownolegle(kolejnosc, watki, [&](long i, long t) {
+        const WykladnikModulu& wykladnik = wykladniki[i];
+        WynikKlucza& wynik = wyniki[i];
+        KontekstWsadu& kontekst = konteksty[t];
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        wynik.znaleziono = atak(wykladnik.e, N, czynniki[i], wynik.d, kontekst.atak, ustawienia.atak,
+                                wynik.statystyki);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        wynik.czas_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+        if (przekroczony_budzet(wynik))
+        {
+            wynik.przerwanie = kontekst.atak.termin.przerwanie;
+        }
+        if (wynik.znaleziono)
+        {
+            phi_z_czynnika(N, czynniki[i], kontekst.p, kontekst.phiN);
+            MulMod(kontekst.p, wykladnik.e % kontekst.phiN, wynik.d, kontekst.phiN);
+            wynik.poprawny = IsOne(kontekst.p) && (IsZero(wykladnik.d) || wykladnik.d == wynik.d);
+        }
+    });
+
+    for (long i = 0; i < (long)wyniki.size(); i++)
+    {
+        if (wyniki[i].znaleziono && wyniki[i].poprawny)
+        {
+            q = czynniki[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+
+int uruchom_wspolny_modul(const std::string& sciezka, const UstawieniaWsadu& ustawienia)
+{
+    ZZ N;
+    vector<WykladnikModulu> wykladniki;
+    if (!wczytaj_wspolny_modul(sciezka, N, wykladniki))
+    {
+        return 1;
+    }
+
+    vector<WynikKlucza> wyniki;
+    ZZ q, p, phiN, d;
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    bool rozlozony = atakuj_wykladniki(N, wykladniki, ustawienia, wyniki, q);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    long long czas_calkowity_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count();
+    if (rozlozony)
+    {
+        phi_z_czynnika(N, q, p, phiN);
+    }
+
+    std::cout << "modulus_bits = " << NumBits(N) << " exponents = " << wykladniki.size() << std::endl;
+    long znalezione = 0, bledne = 0, wyznaczone = 0;
+    long long czas_ns = 0;
+    StatystykiAtaku statystyki;
+    for (long i = 0; i < (long)wyniki.size(); i++)
+    {
+        const WynikKlucza& wynik = wyniki[i];
+        std::cout << "[" << i + 1 << "] ";
+        if (wynik.znaleziono)
+        {
+            std::cout << "d = " << wynik.d << " ";
+        }
+        std::cout << "Time = " << wynik.czas_ns / 1000.0 << "[µs] ";
+        if (wynik.znaleziono)
+        {
+            std::cout << (wynik.poprawny ? "OK" : "Niepoprawny wynik");
+        }
+        else
+        {
+            if (przekroczony_budzet(wynik))
+            {
+                wypisz_przerwanie(std::cout, wynik.przerwanie);
+            }
+            else
+            {
+                std::cout << "Nic nie znalazlem :(";
+            }
+            // Z rozkladem N kazdy wykladnik odwracalny modulo phi(N) ma d = e^(-1)
+            if (rozlozony && IsOne(GCD(wykladniki[i].e, phiN)))
+            {
+                InvMod(d, wykladniki[i].e % phiN, phiN);
+                std::cout << " d_from_factors = " << d;
+                wyznaczone++;
+            }
+        }
+        std::cout << std::endl;
+        if (ustawienia.atak.pomiary)
+        {
+            wypisz_statystyki(wynik.statystyki);
+            wypisz_pomiary(wynik.statystyki.pomiary, true);
+        }
+        znalezione += wynik.znaleziono;
+        bledne += wynik.znaleziono && !wynik.poprawny;
+        czas_ns += wynik.czas_ns;
+        statystyki.dodaj(wynik.statystyki);
+    }
+
+    std::cout << "exponents = " << wykladniki.size() << " found = " << znalezione << " wrong = " << bledne
+              << " factored = " << (rozlozony ? "yes" : "no") << " derived = " << wyznaczone
+              << " Time = " << czas_ns / 1000.0 << "[µs]" << std::endl;
+    wypisz_statystyki(statystyki);
+    wypisz_pomiary(statystyki.pomiary, ustawienia.atak.pomiary);
+    if (rozlozony)
+    {
+        std::cout << "p = " << p << " q = " << q << std::endl;
+    }
+    std::cout << "threads = " << liczba_watkow_roboczych(ustawienia.watki) << " exponents = " << wykladniki.size()
+              << " Wall time = " << czas_calkowity_ns / 1000.0 << "[µs]"
+              << " throughput = " << (czas_calkowity_ns > 0 ? wykladniki.size() * 1e9 / czas_calkowity_ns : 0.0)
+              << "[keys/s]" << std::endl;
+    return bledne == 0 ? 0 : 1;
+}
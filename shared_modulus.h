@@ -0,0 +1,36 @@
+#ifndef WIENER_SHARED_MODULUS_H
+#define WIENER_SHARED_MODULUS_H
+
+#include <string>
+#include "batch.h"
+
+// Tryb wspolnego modulu: jeden N z wieloma wykladnikami publicznymi (np.
+// blednie zrotowane klucze). N wczytywany jest raz, a granica Wienera liczona
+// raz na watek (ZmienneRobocze::N_granicy), nie dla kazdego e. Rozwiniecia
+// e/N roznych wykladnikow przeszukiwane sa rownolegle. Gdy ktorys wykladnik
+// rozlozy N, d pozostalych wyznaczane jest wprost z phi(N).
+
+// Wykladnik wspolnego modulu z pliku
+struct WykladnikModulu
+{
+    ZZ e;
+    ZZ d;   // oczekiwany wykladnik prywatny, 0 gdy plik go nie zawiera
+};
+
+// Wczytuje plik wspolnego modulu: pierwsza niepusta linia to N, kazda
+// nastepna to e, opcjonalnie z oczekiwanym d po tabulatorze
+bool wczytaj_wspolny_modul(const std::string& sciezka, ZZ& N, vector<WykladnikModulu>& wykladniki);
+
+// Atakuje wszystkie wykladniki modulu N w ustawienia.watki watkach;
+// wyniki[i] dla wykladniki[i], poprawnosc jak w atakuj_klucz(). Zwraca true
+// i ustawia q na czynnik N, gdy ktorys poprawny wynik rozlozyl N.
+bool atakuj_wykladniki(const ZZ& N, const vector<WykladnikModulu>& wykladniki, const UstawieniaWsadu& ustawienia,
+                       vector<WynikKlucza>& wyniki, ZZ& q);
+
+// Atakuje wykladniki z pliku, wypisuje wynik kazdego z nich (w kolejnosci z
+// pliku), d wyznaczone z rozkladu N dla pozostalych oraz podsumowanie.
+// Uzywa opcji ataku i watkow przebiegu wsadowego; pasma, GPU, pamiec
+// wynikow, punkty kontrolne i batch-GCD nie dotycza tego trybu.
+int uruchom_wspolny_modul(const std::string& sciezka, const UstawieniaWsadu& ustawienia);
+
+#endif
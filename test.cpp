@@ -1,50 +1,65 @@
-#include <fstream>
-#include <vector>
-#include <sstream>
 #include <iostream>
-
-void split(const std::string &s, char delim, std::vector<std::string> &elems) {
-    std::stringstream ss;
-    ss.str(s);
-    std::string item;
-    while (std::getline(ss, item, delim)) {
-        elems.push_back(item);
-    }
-}
+#include <string>
+#include <cstdio>
+#include <cstdlib>
 
 
-int main(int argc, char *argv[])
+// Wyniki kluczy (linie "[i] ...") z wyjscia polecenia, bez czasow ataku
+static bool wyniki_kluczy(const std::string& polecenie, std::string& wyniki)
 {
-    std::ifstream test_values ("test_values.txt");
-    std::string line;
-
-    while (std::getline(test_values, line))
+    FILE* wyjscie = popen(polecenie.c_str(), "r");
+    if (!wyjscie)
     {
-        std::vector<std::string> line_values;
-        std::string e;
-        std::string d;
-        std::string N;
-        split(line, '\t', line_values);
-        if (line_values[0] == "bin_size") // pomiń nagłówek pliku test_values.txt
+        return false;
+    }
+    std::string linia;
+    char bufor[4096];
+    while (fgets(bufor, sizeof(bufor), wyjscie))
+    {
+        linia += bufor;
+        if (linia.empty() || linia[linia.size() - 1] != '\n')
         {
             continue;
         }
-        
-        e = line_values[5];
-        N = line_values[3];
+        if (linia[0] == '[')
+        {
+            size_t czas = linia.find("Time = ");
+            size_t koniec = linia.find("] ", czas);
+            if (czas != std::string::npos && koniec != std::string::npos)
+            {
+                linia.erase(czas, koniec + 2 - czas);
+            }
+            wyniki += linia;
+        }
+        linia.clear();
+    }
+    return pclose(wyjscie) != -1;
+}
 
-        // for (auto v: line_values)
-        // {
-        //     std::cout << v << " ";
-        // }
-        // std::cout << std::endl; 
 
-        std::stringstream stream;
-        std::cout << "bin_len = " << line_values[0] << "[b]" << std::endl;
-        stream << "~/Documents/Programowanie/inzynierka/wiener/wiener" << " " << e << " " << N;
+int main(int argc, char *argv[])
+{
+    // program wiener szukany jest w katalogu, z ktorego uruchomiono test
+    std::string katalog = argv[0];
+    size_t koniec = katalog.find_last_of('/');
+    katalog = koniec == std::string::npos ? "." : katalog.substr(0, koniec);
 
-        system(stream.str().c_str());
+    // wszystkie klucze z test_values.txt atakowane sa w jednym procesie
+    std::string polecenie = katalog + "/wiener --batch test_values.txt";
+    int status = system(polecenie.c_str());
+    if (status != 0)
+    {
+        return 1;
+    }
 
+    // arytmetyka stalej szerokosci z granica Wienera (pierwiastek N^(1/4))
+    // musi dac te same wyniki co NTL
+    std::string ntl, stala;
+    if (!wyniki_kluczy(polecenie + " --bound wiener --backend ntl", ntl)
+        || !wyniki_kluczy(polecenie + " --bound wiener --backend fixed", stala) || ntl.empty() || ntl != stala)
+    {
+        std::cerr << "Rozne wyniki arytmetyki fixed i ntl z --bound wiener" << std::endl;
+        return 1;
     }
     return 0;
-}
\ No newline at end of file
+}
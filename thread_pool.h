@@ -0,0 +1,232 @@
+#ifndef WIENER_THREAD_POOL_H
+#define WIENER_THREAD_POOL_H
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+// Liczba watkow roboczych; 0 oznacza wszystkie dostepne rdzenie
+inline long liczba_watkow_roboczych(long zadana)
+{
+    if (zadana > 0)
+    {
+        return zadana;
+    }
+    long dostepne = std::thread::hardware_concurrency();
+    return dostepne > 0 ? dostepne : 1;
+}
+
+// Wywoluje zadanie(indeks, nr_watku) dla kazdego indeksu z listy kolejnosc.
+// Watki pobieraja kolejne pozycje listy ze wspolnego licznika, wiec przy
+// kolejnosci od najkosztowniejszych zadan (longest job first) zaden rdzen nie
+// czeka bezczynnie na koniec podzialu statycznego. nr_watku pozwala zadaniu
+// korzystac z wlasnego stanu roboczego watku. Po ustawieniu *koniec watki nie
+// pobieraja juz kolejnych pozycji.
+template <class Zadanie>
+void wykonaj_rownolegle(const std::vector<long>& kolejnosc, long liczba_watkow, Zadanie zadanie,
+                        const std::atomic<bool>* koniec = 0)
+{
+    std::atomic<long> nastepny(0);
+    long n = kolejnosc.size();
+    if (liczba_watkow > n)
+    {
+        liczba_watkow = n > 0 ? n : 1;
+    }
+
+    struct Pracownik
+    {
+        static void praca(const std::vector<long>* kolejnosc, std::atomic<long>* nastepny,
+                          Zadanie* zadanie, const std::atomic<bool>* koniec, long nr_watku)
+        {
+            long n = kolejnosc->size();
+            for (long i = nastepny->fetch_add(1); i < n && !(koniec && koniec->load(std::memory_order_relaxed));
+                 i = nastepny->fetch_add(1))
+            {
+                (*zadanie)((*kolejnosc)[i], nr_watku);
+            }
+        }
+    };
+
+    std::vector<std::thread> watki;
+    for (long t = 1; t < liczba_watkow; t++)
+    {
+        watki.push_back(std::thread(Pracownik::praca, &kolejnosc, &nastepny, &zadanie, koniec, t));
+    }
+    Pracownik::praca(&kolejnosc, &nastepny, &zadanie, koniec, 0);
+    for (size_t t = 0; t < watki.size(); t++)
+    {
+        watki[t].join();
+    }
+}
+
+
+// Kolejka o ograniczonej pojemnosci miedzy etapami potoku. wstaw czeka, az
+// zwolni sie miejsce, wiec wolniejszy etap zatrzymuje szybszy (backpressure)
+// zamiast zwiekszac zuzycie pamieci; pobierz czeka na element albo na
+// zamkniecie kolejki i zwraca false dopiero, gdy zamknieta kolejka jest pusta.
+template <class T>
+class KolejkaOgraniczona
+{
+public:
+    explicit KolejkaOgraniczona(size_t pojemnosc) : pojemnosc(pojemnosc > 0 ? pojemnosc : 1), zamknieta(false) {}
+
+    bool wstaw(T element)
+    {
+        std::unique_lock<std::mutex> blokada(mutex);
+        while (elementy.size() >= pojemnosc && !zamknieta)
+        {
+            niepelna.wait(blokada);
+        }
+        if (zamknieta)
+        {
+            return false;
+        }
+        elementy.push_back(std::move(element));
+        niepusta.notify_one();
+        return true;
+    }
+
+    bool pobierz(T& element)
+    {
+        std::unique_lock<std::mutex> blokada(mutex);
+        while (elementy.empty() && !zamknieta)
+        {
+            niepusta.wait(blokada);
+        }
+        return zdejmij(element);
+    }
+
+    // Jak pobierz, ale bez czekania na pusta kolejke
+    bool pobierz_bez_czekania(T& element)
+    {
+        std::unique_lock<std::mutex> blokada(mutex);
+        return zdejmij(element);
+    }
+
+    void zamknij()
+    {
+        std::unique_lock<std::mutex> blokada(mutex);
+        zamknieta = true;
+        niepusta.notify_all();
+        niepelna.notify_all();
+    }
+
+private:
+    bool zdejmij(T& element)
+    {
+        if (elementy.empty())
+        {
+            return false;
+        }
+        element = std::move(elementy.front());
+        elementy.pop_front();
+        niepelna.notify_one();
+        return true;
+    }
+
+    size_t pojemnosc;
+    bool zamknieta;
+    std::deque<T> elementy;
+    std::mutex mutex;
+    std::condition_variable niepusta, niepelna;
+};
+
+
+// Pierscien bez blokad miedzy jednym producentem a wieloma konsumentami
+// (kolejka Vyukova). Elementy zyja w komorkach przez caly czas dzialania
+// pierscienia, wiec T z pamiecia zarezerwowana raz nie alokuje przy kolejnych
+// zadaniach. Producent wypelnia wolna() i oddaje ja przez opublikuj();
+// konsument dostaje komorke z zajmij() i oddaje ja przez zwolnij(). Gdy nie ma
+// komorki, wolna() i zajmij() od razu zwracaja 0, a czekanie (i jego koniec)
+// zostaje wolajacemu.
+template <class T>
+class PierscienZadan
+{
+public:
+    explicit PierscienZadan(size_t pojemnosc) : komorki(potega_dwojki(pojemnosc)), maska(komorki.size() - 1),
+                                                 pozycja_producenta(0), pozycja_konsumentow(0)
+    {
+        for (size_t i = 0; i < komorki.size(); i++)
+        {
+            komorki[i].numer.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Tylko producent
+    T* wolna()
+    {
+        Komorka& komorka = komorki[pozycja_producenta & maska];
+        return komorka.numer.load(std::memory_order_acquire) == pozycja_producenta ? &komorka.element : 0;
+    }
+
+    void opublikuj()
+    {
+        komorki[pozycja_producenta & maska].numer.store(pozycja_producenta + 1, std::memory_order_release);
+        pozycja_producenta++;
+    }
+
+    // Konsumenci; pozycja zajetej komorki trafia do zwolnij()
+    T* zajmij(size_t& pozycja)
+    {
+        pozycja = pozycja_konsumentow.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Komorka& komorka = komorki[pozycja & maska];
+            // Roznica ze znakiem: ujemna, gdy producent nie wypelnil jeszcze komorki
+            long roznica = (long)(komorka.numer.load(std::memory_order_acquire) - (pozycja + 1));
+            if (roznica == 0)
+            {
+                if (pozycja_konsumentow.compare_exchange_weak(pozycja, pozycja + 1, std::memory_order_relaxed))
+                {
+                    return &komorka.element;
+                }
+            }
+            else if (roznica < 0)
+            {
+                return 0;
+            }
+            else
+            {
+                pozycja = pozycja_konsumentow.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void zwolnij(size_t pozycja)
+    {
+        komorki[pozycja & maska].numer.store(pozycja + komorki.size(), std::memory_order_release);
+    }
+
+    T& operator[](size_t i) { return komorki[i].element; }
+    size_t pojemnosc() const { return komorki.size(); }
+
+private:
+    struct Komorka
+    {
+        std::atomic<size_t> numer;  // pozycja + 1: pelna, pozycja: wolna dla producenta
+        T element;
+    };
+
+    static size_t potega_dwojki(size_t n)
+    {
+        size_t p = 2;
+        while (p < n)
+        {
+            p *= 2;
+        }
+        return p;
+    }
+
+    std::vector<Komorka> komorki;
+    size_t maska;
+    size_t pozycja_producenta;
+    std::atomic<size_t> pozycja_konsumentow;
+
+    PierscienZadan(const PierscienZadan&);
+    PierscienZadan& operator=(const PierscienZadan&);
+};
+
+#endif
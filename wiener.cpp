@@ -1,172 +1,204 @@
 #include <iostream>
 #include <stdio.h>
 #include <cassert>
-#include <NTL/ZZ.h>
-#include <vector>
+#include <string>
+#include <sstream>
+#include <cstdlib>
 #include <chrono>
-
-NTL_CLIENT
+#include "attack.h"
+#include "library.h"
+#include "batch.h"
+#include "corpus.h"
+#include "service.h"
+#include "distributed.h"
+#include "generator.h"
+#include "shared_modulus.h"
 
 #define assertm(exp, msg) assert(((void)msg, exp))
-#define DEBUG 0
-
-
-vector<ZZ> oblicz_wartosc_ulamka_lancuchowego(ZZ e, ZZ N)
-{   
-    vector<ZZ> wartosc_ulamka_lancuchowego;
-    ZZ licznik, mianownik, iloraz, tmp;
 
-    licznik = e;
-    mianownik = N;
 
-    while (!IsZero(mianownik))
+int main(int argc, char *argv[])
+{
+    if (argc == 4 && std::string(argv[1]) == "--convert-corpus")
     {
-        iloraz = licznik / mianownik;
-        wartosc_ulamka_lancuchowego.push_back(iloraz);
-        tmp = licznik;
-        licznik = mianownik;
-        mianownik = tmp - (mianownik * iloraz); 
+        return konwertuj_korpus(argv[2], argv[3]);
     }
-    if(DEBUG)
+    if (argc >= 3 && std::string(argv[1]) == "--generate")
     {
-        for (int i = 0; i < wartosc_ulamka_lancuchowego.size(); i++)
+        UstawieniaGeneratora ustawienia;
+        for (int i = 3; i < argc; i++)
+        {
+            std::string opcja = argv[i];
+            if (opcja == "--sizes" && i + 1 < argc)
+            {
+                // Lista rozmiarow rozdzielona przecinkami
+                std::stringstream lista(argv[++i]);
+                std::string rozmiar;
+                ustawienia.rozmiary.clear();
+                while (std::getline(lista, rozmiar, ','))
+                {
+                    ustawienia.rozmiary.push_back(atol(rozmiar.c_str()));
+                    if (ustawienia.rozmiary.back() < 16)
+                    {
+                        std::cerr << "Rozmiar modulu musi miec co najmniej 16 bitow" << std::endl;
+                        return 1;
+                    }
+                }
+            }
+            else if (opcja == "--count" && i + 1 < argc)
+            {
+                ustawienia.podatne = atol(argv[++i]);
+            }
+            else if (opcja == "--control" && i + 1 < argc)
+            {
+                ustawienia.kontrolne = atol(argv[++i]);
+            }
+            else if (opcja == "--d-fraction" && i + 1 < argc)
+            {
+                ustawienia.ulamek_d = atof(argv[++i]);
+            }
+            else if (opcja == "--seed" && i + 1 < argc)
+            {
+                ustawienia.ziarno = strtoul(argv[++i], 0, 10);
+            }
+            else if (opcja == "--threads" && i + 1 < argc)
+            {
+                ustawienia.watki = atol(argv[++i]);
+            }
+            else if (opcja == "--format" && i + 1 < argc && (std::string(argv[i + 1]) == "tsv"
+                                                            || std::string(argv[i + 1]) == "corpus"))
+            {
+                ustawienia.korpus = std::string(argv[++i]) == "corpus";
+            }
+            else
+            {
+                std::cerr << "Nieznana opcja lub wartosc " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        if (ustawienia.podatne < 0 || ustawienia.kontrolne < 0 || ustawienia.ulamek_d < 0 || ustawienia.ulamek_d >= 1)
         {
-            cout << wartosc_ulamka_lancuchowego[i] << endl;
+            std::cerr << "Niepoprawna liczba kluczy lub ulamek d" << std::endl;
+            return 1;
         }
+        return generuj_korpus(argv[2], ustawienia);
     }
-    return wartosc_ulamka_lancuchowego;
-}
-
-
-vector<ZZ> atak(ZZ e, ZZ N)
-{
-    vector<ZZ> P;
-    vector<ZZ> Q;
-    vector<ZZ> wartosc_ulamka = oblicz_wartosc_ulamka_lancuchowego(e, N);
-    vector<ZZ> wynik;
-    ZZ k, d, phiN, a, b, c, delta, p1, p2, q;
-
-
-    for (int i = 0; i < wartosc_ulamka.size(); i++)
+    if (argc >= 2 && std::string(argv[1]) == "--serve")
     {
-        // Wyznacz P i Q dla tej iteracji
-        if (i == 0)
+        UstawieniaUslugi ustawienia;
+        for (int i = 2; i < argc; i++)
         {
-            P.push_back(wartosc_ulamka[i]);
-            Q.push_back(conv<ZZ>("1"));
+            std::string opcja = argv[i];
+            if (opcja == "--socket" && i + 1 < argc)
+            {
+                ustawienia.gniazdo = argv[++i];
+            }
+            else if (opcja == "--queue" && i + 1 < argc)
+            {
+                ustawienia.kolejka = atol(argv[++i]);
+            }
+            else if (opcja == "--max-bits" && i + 1 < argc)
+            {
+                ustawienia.max_bity = atol(argv[++i]);
+            }
+            else if (!wczytaj_opcje_wsadu(argc, argv, i, ustawienia.wsad))
+            {
+                std::cerr << "Nieznana opcja lub wartosc " << argv[i] << std::endl;
+                return 1;
+            }
         }
-        else if (i == 1)
+        return uruchom_usluge(ustawienia);
+    }
+    if (argc >= 3 && (std::string(argv[1]) == "--coordinate" || std::string(argv[1]) == "--work"))
+    {
+        // Koordynator przesyla wezlom swoje opcje ataku; --threads pozostaje lokalne
+        UstawieniaRozproszone ustawienia;
+        bool koordynator = std::string(argv[1]) == "--coordinate";
+        if (!koordynator)
         {
-            P.push_back((wartosc_ulamka[i] * wartosc_ulamka[i - 1]) + 1);
-            Q.push_back(wartosc_ulamka[i]);
+            ustawienia.adres = argv[2];
         }
-        else
+        for (int i = 3; i < argc; i++)
         {
-            P.push_back((wartosc_ulamka[i] * P[i - 1]) + P[i - 2]);
-            Q.push_back((wartosc_ulamka[i] * Q[i - 1]) + Q[i - 2]);
+            std::string opcja = argv[i];
+            int poczatek = i;
+            if (koordynator && opcja == "--listen" && i + 1 < argc)
+            {
+                ustawienia.adres = argv[++i];
+            }
+            else if (koordynator && opcja == "--split" && i + 1 < argc)
+            {
+                ustawienia.podzial = atol(argv[++i]);
+            }
+            else if (!wczytaj_opcje_wsadu(argc, argv, i, ustawienia.wsad))
+            {
+                std::cerr << "Nieznana opcja lub wartosc " << argv[i] << std::endl;
+                return 1;
+            }
+            else if (!koordynator || opcja != "--threads")
+            {
+                ustawienia.opcje.insert(ustawienia.opcje.end(), argv + poczatek, argv + i + 1);
+            }
         }
-        // Sprawdzanie czy przy tej iteracji wyznaczone P i Q są szukanymi k i d 
-        k = P[i];
-        d = Q[i];
-        if (!IsZero(k))
+        if (!koordynator)
         {
-            phiN = (e * d) - 1;
-            if (divide(phiN, k))
-            {
-                phiN /= k;
-                // Wyznaczenie delty równania
-                a = 1;
-                b = -((N - phiN) + 1);
-                c = N;
-                delta = power(b, 2) - 4 * (a * c); 
-                // Wyznaczanie pierwiastków równania na podstawie delty
-                if (sign(delta) > 0)
-                {
-                    p1 = -b + SqrRoot(delta);
-                    p2 = -b - SqrRoot(delta);
-                    if (divide(p1, 2*a)) // Czy pierwszy pierwiastek jest całkowity
-                    {
-                        p1 /= 2*a;
-                        if (sign(p1) > 0 && divide(N, p1))
-                        {
-                            q = N / p1;
-                            //cout << d << endl;
-                            wynik.push_back(q);
-                            wynik.push_back(d);
-                            return wynik;
-                        }
-                    }
-                    else if (divide(p2, 2*a)) // Czy drugi pierwiastek jest całkowity
-                    {
-                        p2 /= 2*a;
-                        if (sign(p2) > 0 && divide(N, p2))
-                        {
-                            q = N / p2;
-                            wynik.push_back(q);
-                            wynik.push_back(d);
-                            return wynik;
-                        }
-                    }
-                }
-                else if (sign(delta) == 0)
-                {
-                    if (divide(-b, 2*a)) // Czy pierwiastek jest całkowity
-                    {
-                        p1 /= 2*a;
-                        if (sign(p1) > 0 && divide(N, p1))
-                        {
-                            q = N / p1;
-                            wynik.push_back(q);
-                            wynik.push_back(d);
-                            return wynik;
-                        }
-                    }
-                }
-            }
+            return pracuj(ustawienia);
         }
-    
+        if (ustawienia.adres.empty())
+        {
+            std::cerr << "Koordynator wymaga --listen PORT" << std::endl;
+            return 1;
+        }
+        return koordynuj(argv[2], ustawienia);
     }
-
-    printf("Nic nie znalazlem :(\n");
-    if (DEBUG)
+    if (argc >= 3 && (std::string(argv[1]) == "--batch" || std::string(argv[1]) == "--compare-backends"
+                      || std::string(argv[1]) == "--cf-crossover" || std::string(argv[1]) == "--scan"
+                      || std::string(argv[1]) == "--shared-modulus"))
     {
-        cout << "Q = [ ";
-        for (int i = 0; i < Q.size(); i++)
+        UstawieniaWsadu ustawienia;
+        for (int i = 3; i < argc; i++)
+        {
+            if (!wczytaj_opcje_wsadu(argc, argv, i, ustawienia))
+            {
+                std::cerr << "Nieznana opcja lub wartosc " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        if (std::string(argv[1]) == "--compare-backends")
         {
-            cout << Q[i] <<" ";
+            return porownaj_arytmetyki(argv[2], ustawienia);
         }
-        cout << "]" << endl << "P = [ ";
-        for (int i = 0; i < P.size(); i++)
+        if (std::string(argv[1]) == "--cf-crossover")
         {
-            cout << P[i] << " ";
+            return porownaj_rozwiniecia(atol(argv[2]), ustawienia);
         }
-        cout << "]" << endl << "a = [ ";
-        for (int i = 0; i < wartosc_ulamka.size(); i++)
+        if (std::string(argv[1]) == "--scan")
         {
-            cout << wartosc_ulamka[i] << " ";
+            return skanuj_klucze(argv[2], ustawienia);
         }
-        cout << "]" << endl;
+        if (std::string(argv[1]) == "--shared-modulus")
+        {
+            return uruchom_wspolny_modul(argv[2], ustawienia);
+        }
+        return uruchom_wsad(argv[2], ustawienia);
     }
-    wynik.push_back(conv<ZZ>("0"));
-    return wynik;
-}
-
-int main(int argc, char *argv[])
-{
     assertm(argc == 3, "Niepoprawna liczba argumentow");
     ZZ e = conv<ZZ>(argv[1]); // wykladnik publiczny 
     ZZ N = conv<ZZ>(argv[2]); // modulnik publiczny
-    vector<ZZ> wynik;
-    ZZ d, q, p, phiN;
+    KontekstWatku kontekst;
+    WynikAtaku wynik;
+    ZZ phiN;
     std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-    wynik = atak(e, N);
+    zaatakuj(e, N, kontekst, wynik);
     std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-    q = wynik[0];
-    d = wynik[1];
-    p = N / q;
-    phiN = (p - 1) * (q - 1);
+    if (wynik.status != STATUS_ZNALEZIONO)
+    {
+        printf("Nic nie znalazlem :(\n");
+        return 1;
+    }
+    phiN = (wynik.p - 1) * (wynik.q - 1);
 
-    assertm(MulMod(e, d, phiN) == conv<ZZ>("1"), "Niepoprawny wynik");
+    assertm(MulMod(e, wynik.d, phiN) == conv<ZZ>("1"), "Niepoprawny wynik");
     std::cout << "Time = " << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() << "[µs]" << std::endl;
     return 0;    
 }
\ No newline at end of file